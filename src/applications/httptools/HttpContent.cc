@@ -0,0 +1,95 @@
+// ***************************************************************************
+//
+// HttpTools Project
+//
+// This file is a part of the HttpTools project. The project was created at
+// Reykjavik University, the Laboratory for Dependable Secure Systems (LDSS).
+// Its purpose is to create a set of OMNeT++ components to simulate browsing
+// behaviour in a high-fidelity manner along with a highly configurable
+// Web server component.
+//
+// Maintainer: Kristjan V. Jonsson (LDSS) kristjanvj@gmail.com
+// Project home page: code.google.com/p/omnet-httptools
+//
+// ***************************************************************************
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License version 3
+// as published by the Free Software Foundation.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+//
+// ***************************************************************************
+
+#include "HttpContent.h"
+
+
+HttpContentStore::ContentMap *HttpContentStore::contents = NULL;
+
+HttpContentRef::HttpContentRef(const std::string& body)
+{
+    attach(new HttpContent(body));
+}
+
+HttpContentRef& HttpContentRef::operator=(const HttpContentRef& other)
+{
+    if (content != other.content)
+    {
+        release();
+        attach(other.content);
+    }
+    return *this;
+}
+
+void HttpContentRef::release()
+{
+    if (content && --content->refCount == 0)
+    {
+        if (content->interned)
+            HttpContentStore::remove(content);
+        delete content;
+    }
+    content = NULL;
+}
+
+const std::string& HttpContentRef::str() const
+{
+    static const std::string emptyBody;
+    return content ? content->body : emptyBody;
+}
+
+HttpContentRef HttpContentStore::intern(const std::string& body)
+{
+    if (!contents)
+        contents = new ContentMap();
+
+    HttpContentRef ref;
+    ContentMap::iterator it = contents->find(&body);
+    if (it != contents->end())
+        ref.attach(it->second);
+    else
+    {
+        HttpContent *content = new HttpContent(body);
+        content->interned = true;
+        (*contents)[&content->body] = content;
+        ref.attach(content);
+    }
+    return ref;
+}
+
+void HttpContentStore::remove(HttpContent *content)
+{
+    contents->erase(&content->body);
+    if (contents->empty())
+    {
+        delete contents;
+        contents = NULL;
+    }
+}
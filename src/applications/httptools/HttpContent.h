@@ -0,0 +1,141 @@
+// ***************************************************************************
+//
+// HttpTools Project
+//
+// This file is a part of the HttpTools project. The project was created at
+// Reykjavik University, the Laboratory for Dependable Secure Systems (LDSS).
+// Its purpose is to create a set of OMNeT++ components to simulate browsing
+// behaviour in a high-fidelity manner along with a highly configurable
+// Web server component.
+//
+// Maintainer: Kristjan V. Jonsson (LDSS) kristjanvj@gmail.com
+// Project home page: code.google.com/p/omnet-httptools
+//
+// ***************************************************************************
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License version 3
+// as published by the Free Software Foundation.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+//
+// ***************************************************************************
+
+#ifndef __INET_HTTPCONTENT_H
+#define __INET_HTTPCONTENT_H
+
+#include <map>
+#include <string>
+
+#include "INETDefs.h"
+
+
+/**
+ * An immutable, reference counted HTTP message body.
+ *
+ * Instances are only accessed through HttpContentRef handles; the body is
+ * deleted when the last handle referring to it goes away.
+ *
+ * @see HttpContentRef, HttpContentStore
+ */
+class INET_API HttpContent
+{
+    friend class HttpContentRef;
+    friend class HttpContentStore;
+
+    private:
+        std::string body;
+        int refCount;
+        bool interned;
+
+        HttpContent(const std::string& body) : body(body), refCount(0), interned(false) {}
+        HttpContent(const HttpContent&);  // not implemented
+        HttpContent& operator=(const HttpContent&);  // not implemented
+};
+
+/**
+ * Handle to a shared HttpContent. Copying a handle only increments the
+ * reference count of the body, so replies and their copies made by the
+ * transport layer all share one body string. The default handle refers
+ * to the empty body.
+ */
+class INET_API HttpContentRef
+{
+    friend class HttpContentStore;
+
+    private:
+        HttpContent *content;
+
+        void attach(HttpContent *c) { content = c; if (content) content->refCount++; }
+        void release();
+
+    public:
+        HttpContentRef() : content(NULL) {}
+
+        /** Creates a handle to a new, unshared copy of the body. */
+        explicit HttpContentRef(const std::string& body);
+
+        HttpContentRef(const HttpContentRef& other) { attach(other.content); }
+        ~HttpContentRef() { release(); }
+
+        HttpContentRef& operator=(const HttpContentRef& other);
+
+        /** Returns the body as a C string. */
+        const char *c_str() const { return content ? content->body.c_str() : ""; }
+
+        /** Returns the body. */
+        const std::string& str() const;
+
+        /** Returns the length of the body in characters. */
+        size_t length() const { return content ? content->body.length() : 0; }
+
+        /** Returns true if the body is empty. */
+        bool empty() const { return length() == 0; }
+
+        /** Returns true if both handles refer to the same body object. */
+        bool isSameAs(const HttpContentRef& other) const { return content == other.content; }
+};
+
+/**
+ * Process-wide store of interned HTTP bodies. Site definition pages and
+ * generated page bodies are interned, so each distinct body is kept in
+ * memory once, regardless of the number of servers serving it and the
+ * number of replies in flight. Bodies are removed from the store when
+ * their last handle is released.
+ */
+class INET_API HttpContentStore
+{
+    friend class HttpContentRef;
+
+    private:
+        struct BodyLess
+        {
+            bool operator()(const std::string *a, const std::string *b) const { return *a < *b; }
+        };
+        typedef std::map<const std::string *, HttpContent *, BodyLess> ContentMap;
+
+        // allocated on demand and deleted when empty, so that handles may
+        // safely be released during static destruction
+        static ContentMap *contents;
+
+        static void remove(HttpContent *content);
+
+    public:
+        /**
+         * Returns a handle to the stored body equal to the argument,
+         * adding the body to the store first if it is not present yet.
+         */
+        static HttpContentRef intern(const std::string& body);
+
+        /** Returns the number of distinct bodies in the store. */
+        static int getNumContents() { return contents ? contents->size() : 0; }
+};
+
+#endif
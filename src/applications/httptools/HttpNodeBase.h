@@ -42,6 +42,7 @@
 
 #include "HttpController.h"
 #include "HttpMessages_m.h"
+#include "HttpReplyMessage.h"
 #include "HttpRandom.h"
 #include "HttpUtils.h"
 #include "HttpLogdefs.h"
@@ -0,0 +1,57 @@
+// ***************************************************************************
+//
+// HttpTools Project
+//
+// This file is a part of the HttpTools project. The project was created at
+// Reykjavik University, the Laboratory for Dependable Secure Systems (LDSS).
+// Its purpose is to create a set of OMNeT++ components to simulate browsing
+// behaviour in a high-fidelity manner along with a highly configurable
+// Web server component.
+//
+// Maintainer: Kristjan V. Jonsson (LDSS) kristjanvj@gmail.com
+// Project home page: code.google.com/p/omnet-httptools
+//
+// ***************************************************************************
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License version 3
+// as published by the Free Software Foundation.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+//
+// ***************************************************************************
+
+#include "HttpReplyMessage.h"
+
+
+Register_Class(HttpReplyMessage);
+
+HttpReplyMessage& HttpReplyMessage::operator=(const HttpReplyMessage& other)
+{
+    if (this == &other)
+        return *this;
+    HttpReplyMessage_Base::operator=(other);
+    payloadContent = other.payloadContent;
+    return *this;
+}
+
+void HttpReplyMessage::parsimPack(cCommBuffer *b)
+{
+    HttpReplyMessage_Base::parsimPack(b);
+    b->pack(payloadContent.c_str());
+}
+
+void HttpReplyMessage::parsimUnpack(cCommBuffer *b)
+{
+    HttpReplyMessage_Base::parsimUnpack(b);
+    opp_string payload;
+    b->unpack(payload);
+    payloadContent = HttpContentRef(payload.c_str());
+}
@@ -0,0 +1,69 @@
+// ***************************************************************************
+//
+// HttpTools Project
+//
+// This file is a part of the HttpTools project. The project was created at
+// Reykjavik University, the Laboratory for Dependable Secure Systems (LDSS).
+// Its purpose is to create a set of OMNeT++ components to simulate browsing
+// behaviour in a high-fidelity manner along with a highly configurable
+// Web server component.
+//
+// Maintainer: Kristjan V. Jonsson (LDSS) kristjanvj@gmail.com
+// Project home page: code.google.com/p/omnet-httptools
+//
+// ***************************************************************************
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License version 3
+// as published by the Free Software Foundation.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+//
+// ***************************************************************************
+
+#ifndef __INET_HTTPREPLYMESSAGE_H
+#define __INET_HTTPREPLYMESSAGE_H
+
+#include "INETDefs.h"
+
+#include "HttpContent.h"
+#include "HttpMessages_m.h"
+
+
+/**
+ * HTTP reply message. The payload is kept as a shared HttpContent, so
+ * duplicating a reply (e.g. by TCP) does not copy the body.
+ */
+class INET_API HttpReplyMessage : public HttpReplyMessage_Base
+{
+    protected:
+        HttpContentRef payloadContent;
+
+    public:
+        HttpReplyMessage(const char *name=NULL, int kind=0) : HttpReplyMessage_Base(name, kind) {}
+        HttpReplyMessage(const HttpReplyMessage& other) : HttpReplyMessage_Base(other), payloadContent(other.payloadContent) {}
+        HttpReplyMessage& operator=(const HttpReplyMessage& other);
+        virtual HttpReplyMessage *dup() const {return new HttpReplyMessage(*this);}
+
+        virtual void parsimPack(cCommBuffer *b);
+        virtual void parsimUnpack(cCommBuffer *b);
+
+        /** Returns the body; redefined to use the shared content */
+        virtual const char *payload() const {return payloadContent.c_str();}
+        /** Sets the body to an unshared copy of the argument */
+        virtual void setPayload(const char *payload) {payloadContent = HttpContentRef(payload ? payload : "");}
+
+        /** Returns the shared body */
+        virtual const HttpContentRef& getPayloadContent() const {return payloadContent;}
+        /** Sets the body without copying it */
+        virtual void setPayloadContent(const HttpContentRef& content) {payloadContent = content;}
+};
+
+#endif
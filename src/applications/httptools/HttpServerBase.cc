@@ -129,6 +129,10 @@ void HttpServerBase::initialize()
     activationTime = par("activationTime");
     EV_INFO << "Activation time is " << activationTime << endl;
 
+    sizeOnly = par("sizeOnly");
+    if (sizeOnly)
+        EV_INFO << "Size-only mode: replies carry no body" << endl;
+
     std::string siteDefinition = (const char*)par("siteDefinition");
     scriptedMode = !siteDefinition.empty();
     if (scriptedMode)
@@ -314,12 +318,14 @@ HttpReplyMessage* HttpServerBase::generateDocument(HttpRequestMessage *request,
 
     if (scriptedMode)
     {
-        replymsg->setPayload(htmlPages[resource].body.c_str());
-        size = htmlPages[resource].size;
+        const HtmlPageData& page = htmlPages[resource];
+        if (!sizeOnly)
+            replymsg->setPayloadContent(page.body);
+        size = page.size;
     }
-    else
+    else if (!sizeOnly)
     {
-        replymsg->setPayload(generateBody().c_str());
+        replymsg->setPayloadContent(generateBody());
     }
 
     if (size==0)
@@ -380,27 +386,34 @@ HttpReplyMessage* HttpServerBase::generateErrorReply(HttpRequestMessage *request
     return replymsg;
 }
 
-std::string HttpServerBase::generateBody()
+HttpContentRef HttpServerBase::generateBody()
 {
     int numResources = (int)rdNumResources->draw();
     int numImages = (int)(numResources*rdTextImageResourceRatio->draw());
     int numText = numResources - numImages;
 
-    std::string result;
-
-    char tempBuf[128];
-    for (int i=0; i<numImages; i++)
+    // The body only depends on the resource counts, so it is built once per
+    // combination and shared by all replies (and all servers) using it
+    HttpContentRef& body = generatedBodies[std::make_pair(numImages, numText)];
+    if (body.empty() && numResources > 0)
     {
-        sprintf(tempBuf, "%s%.4d.%s\n", "IMG", i, "jpg");
-        result.append(tempBuf);
-    }
-    for (int i=0; i<numText; i++)
-    {
-        sprintf(tempBuf, "%s%.4d.%s\n", "TEXT", i, "txt");
-        result.append(tempBuf);
-    }
+        std::string result;
 
-    return result;
+        char tempBuf[128];
+        for (int i=0; i<numImages; i++)
+        {
+            sprintf(tempBuf, "%s%.4d.%s\n", "IMG", i, "jpg");
+            result.append(tempBuf);
+        }
+        for (int i=0; i<numText; i++)
+        {
+            sprintf(tempBuf, "%s%.4d.%s\n", "TEXT", i, "txt");
+            result.append(tempBuf);
+        }
+
+        body = HttpContentStore::intern(result);
+    }
+    return body;
 }
 
 void HttpServerBase::registerWithController()
@@ -483,7 +496,7 @@ void HttpServerBase::readSiteDefinition(std::string file)
                 }
                 EV_DEBUG << "Adding html page definition " << key << ". The page size is " << size << endl;
                 htmlPages[key].size = size;
-                htmlPages[key].body = body;
+                htmlPages[key].body = HttpContentStore::intern(body);
             }
             else if (resourceSection)
             {
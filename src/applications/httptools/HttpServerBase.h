@@ -73,7 +73,7 @@ class INET_API HttpServerBase : public HttpNodeBase
         struct HtmlPageData
         {
             long size;
-            std::string body;
+            HttpContentRef body;    // interned in HttpContentStore
         };
 
         /** The server name, e.g. www.example.com. */
@@ -87,6 +87,11 @@ class INET_API HttpServerBase : public HttpNodeBase
         std::map<std::string,HtmlPageData> htmlPages;
         /** A map of resource, keyed by a resource URL. Used in scripted mode. */
         std::map<std::string,unsigned int> resources;
+        /** Generated page bodies, keyed by the number of image and text resources. Used in random mode. */
+        std::map<std::pair<int,int>,HttpContentRef> generatedBodies;
+
+        /** set to true if replies carry only their size but no body */
+        bool sizeOnly;
 
         // Basic statistics
         long htmlDocsServed;
@@ -138,7 +143,7 @@ class INET_API HttpServerBase : public HttpNodeBase
         /** Generate a error reply in case of invalid resource requests. */
         HttpReplyMessage* generateErrorReply(HttpRequestMessage *request, int code);
         /** Create a random body according to the site content random distributions. */
-        virtual std::string generateBody();
+        virtual HttpContentRef generateBody();
 
         /** Handle a received data message, e.g. check if the content requested exists. */
         cPacket* handleReceivedMessage(cMessage *msg);
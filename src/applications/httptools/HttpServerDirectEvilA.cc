@@ -43,7 +43,7 @@ void HttpServerDirectEvilA::initialize()
     EV_INFO << "Minimum " << badLow << " and maximum " << badHigh << " bad requests for each hit." << endl;
 }
 
-std::string HttpServerDirectEvilA::generateBody()
+HttpContentRef HttpServerDirectEvilA::generateBody()
 {
     int numImages = badLow+(int)uniform(0, badHigh-badLow);
     double rndDelay;
@@ -57,7 +57,7 @@ std::string HttpServerDirectEvilA::generateBody()
         result.append(tempBuf);
     }
 
-    return result;
+    return HttpContentRef(result);
 }
 
 
@@ -44,7 +44,7 @@ void HttpServerDirectEvilB::initialize()
     EV_INFO << "Minimum " << badLow << " and maximum " << badHigh << " bad requests for each hit." << endl;
 }
 
-std::string HttpServerDirectEvilB::generateBody()
+HttpContentRef HttpServerDirectEvilB::generateBody()
 {
     int numResources = badLow+(int)uniform(0, badHigh-badLow);
     double rndDelay;
@@ -60,7 +60,7 @@ std::string HttpServerDirectEvilB::generateBody()
         result.append(tempBuf);
     }
 
-    return result;
+    return HttpContentRef(result);
 }
 
 
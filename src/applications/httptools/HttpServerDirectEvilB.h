@@ -55,7 +55,7 @@ class INET_API HttpServerDirectEvilB : public HttpServerDirect
         int badHigh;
     protected:
         virtual void initialize();
-        virtual std::string generateBody();
+        virtual HttpContentRef generateBody();
 };
 
 #endif /* HttpServerDirectEvilB */
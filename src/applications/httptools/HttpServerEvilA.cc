@@ -43,7 +43,7 @@ void HttpServerEvilA::initialize()
     EV_INFO << "Minimum " << badLow << " and maximum " << badHigh << " bad requests for each hit." << endl;
 }
 
-std::string HttpServerEvilA::generateBody()
+HttpContentRef HttpServerEvilA::generateBody()
 {
     int numImages = badLow+(int)uniform(0, badHigh-badLow);
     double rndDelay;
@@ -57,7 +57,7 @@ std::string HttpServerEvilA::generateBody()
         result.append(tempBuf);
     }
 
-    return result;
+    return HttpContentRef(result);
 }
 
 
@@ -57,7 +57,7 @@ class INET_API HttpServerEvilA : public HttpServer
         int badHigh;
     protected:
         virtual void initialize();
-        virtual std::string generateBody();
+        virtual HttpContentRef generateBody();
 };
 
 #endif /* HttpServerEvilA */
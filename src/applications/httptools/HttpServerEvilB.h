@@ -57,7 +57,7 @@ class INET_API HttpServerEvilB : public HttpServer
         int badHigh;
     protected:
         virtual void initialize();
-        virtual std::string generateBody();
+        virtual HttpContentRef generateBody();
 };
 
 #endif /* HttpServerEvilB */
@@ -38,6 +38,14 @@ class INET_API IPassiveQueue
      */
     virtual void requestPacket() = 0;
 
+    /**
+     * Removes the packet that requestPacket() would send, and returns it
+     * to the caller instead of sending it; returns NULL if the queue is empty.
+     * It lets a module run a chain of queues and schedulers in process
+     * (see DiffservQueuePipeline). Pending requests are not affected.
+     */
+    virtual cMessage *removePacket() = 0;
+
     /**
      * Returns number of pending requests.
      */
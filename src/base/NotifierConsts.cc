@@ -46,6 +46,7 @@ const char *notificationCategoryName(int category)
         case NF_INTERFACE_CONFIG_CHANGED: return "IF-CFG";
         case NF_INTERFACE_IPv4CONFIG_CHANGED: return "IPv4-CFG";
         case NF_INTERFACE_IPv6CONFIG_CHANGED: return "IPv6-CFG";
+        case NF_ARP_CACHE_CHANGED: return "ARP-CACHE-CHG";
 
         case NF_IPv4_ROUTE_ADDED: return "IPv4-ROUTE-ADD";
         case NF_IPv4_ROUTE_DELETED: return "IPv4-ROUTE-DEL";
@@ -70,6 +70,7 @@ enum
     NF_INTERFACE_IPv4CONFIG_CHANGED,
     NF_INTERFACE_IPv6CONFIG_CHANGED,
     NF_TED_CHANGED,
+    NF_ARP_CACHE_CHANGED,  // a resolved ARP cache entry changed or was removed (currently ARP)
 
     // layer 3 - IPv4
     NF_IPv4_ROUTE_ADDED,
@@ -0,0 +1,114 @@
+//
+// Copyright (C) 2013 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <new>
+
+#include "ObjectPool.h"
+
+
+Register_Class(PooledPacket);
+Register_Class(PooledObject);
+
+ObjectPool::FreeBlock *ObjectPool::freeLists[ObjectPool::NUM_SIZE_CLASSES];
+ObjectPool::Statistics ObjectPool::statistics;
+unsigned long ObjectPool::numFreeBlocks = 0;
+int ObjectPool::numUsers = 0;
+bool ObjectPool::statisticsRecorded = false;
+
+void *ObjectPool::allocate(size_t size)
+{
+    if (size == 0 || size > MAX_POOLED_SIZE)
+    {
+        statistics.numUnpooled++;
+        return ::operator new(size);
+    }
+
+    statistics.numAllocated++;
+    int sizeClass = (size - 1) / GRANULARITY;
+    FreeBlock *block = freeLists[sizeClass];
+    if (block)
+    {
+        freeLists[sizeClass] = block->next;
+        statistics.numReused++;
+        numFreeBlocks--;
+        return block;
+    }
+    return ::operator new((sizeClass + 1) * GRANULARITY);
+}
+
+void ObjectPool::release(void *p, size_t size)
+{
+    if (!p)
+        return;
+
+    if (size == 0 || size > MAX_POOLED_SIZE)
+    {
+        ::operator delete(p);
+        return;
+    }
+
+    int sizeClass = (size - 1) / GRANULARITY;
+    FreeBlock *block = static_cast<FreeBlock *>(p);
+    block->next = freeLists[sizeClass];
+    freeLists[sizeClass] = block;
+    statistics.numReleased++;
+    numFreeBlocks++;
+}
+
+void ObjectPool::releaseFreeBlocks()
+{
+    for (int i = 0; i < NUM_SIZE_CLASSES; i++)
+    {
+        while (freeLists[i])
+        {
+            FreeBlock *block = freeLists[i];
+            freeLists[i] = block->next;
+            ::operator delete(block);
+        }
+    }
+    numFreeBlocks = 0;
+}
+
+void ObjectPool::addUser()
+{
+    if (numUsers++ == 0)
+    {
+        // first user of a new run; blocks released after the last user of
+        // the previous run was deleted may still be on the free lists
+        releaseFreeBlocks();
+        statistics.numAllocated = statistics.numReused = statistics.numReleased = statistics.numUnpooled = 0;
+        statisticsRecorded = false;
+    }
+}
+
+void ObjectPool::removeUser()
+{
+    if (--numUsers == 0)
+        releaseFreeBlocks();
+}
+
+void ObjectPool::recordStatistics()
+{
+    if (statisticsRecorded)
+        return;
+    statisticsRecorded = true;
+
+    cModule *network = simulation.getSystemModule();
+    network->recordScalar("object pool allocations", statistics.numAllocated);
+    network->recordScalar("object pool reused allocations", statistics.numReused);
+    network->recordScalar("object pool free blocks", getNumFreeBlocks());
+}
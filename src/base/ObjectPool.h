@@ -0,0 +1,131 @@
+//
+// Copyright (C) 2013 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __INET_OBJECTPOOL_H
+#define __INET_OBJECTPOOL_H
+
+#include <stddef.h>
+#include "INETDefs.h"
+
+#include "ObjectPool_m.h"
+
+
+/**
+ * Free-list based memory pool for frequently created and deleted objects
+ * (frames, control infos). Memory is kept in one free list per size class,
+ * so every class of pooled objects effectively gets its own pool; blocks are
+ * never returned to the heap, but reused by the next object of the same size.
+ *
+ * Objects are still constructed and destroyed normally (message ids, names,
+ * ownership are not affected); only the malloc/free is avoided. Classes use
+ * the pool by deriving from PooledPacket or PooledObject.
+ *
+ * Modules that create pooled objects register themselves as users of the
+ * pool (addUser() in their constructor, removeUser() in their destructor).
+ * The statistics are reset when the first user of a run is created, and
+ * the free lists are released to the heap when the last one is deleted,
+ * i.e. when the network is torn down at the end of the run.
+ */
+class INET_API ObjectPool
+{
+  public:
+    struct Statistics
+    {
+        unsigned long numAllocated;  // number of allocations served by the pool
+        unsigned long numReused;     // number of allocations served from a free list
+        unsigned long numReleased;   // number of blocks returned to the pool
+        unsigned long numUnpooled;   // number of allocations too large to be pooled
+    };
+
+  protected:
+    enum { GRANULARITY = 16, MAX_POOLED_SIZE = 1024, NUM_SIZE_CLASSES = MAX_POOLED_SIZE / GRANULARITY };
+
+    struct FreeBlock
+    {
+        FreeBlock *next;
+    };
+
+    static FreeBlock *freeLists[NUM_SIZE_CLASSES];
+    static Statistics statistics;
+    static unsigned long numFreeBlocks;
+    static int numUsers;
+    static bool statisticsRecorded;
+
+  protected:
+    static void releaseFreeBlocks();
+
+  public:
+    /** Returns a block of at least the given size. */
+    static void *allocate(size_t size);
+
+    /** Returns a block obtained from allocate() to the pool. */
+    static void release(void *p, size_t size);
+
+    /** Returns the allocation statistics of the pool. */
+    static const Statistics& getStatistics() { return statistics; }
+
+    /** Returns the number of blocks currently on the free lists. */
+    static unsigned long getNumFreeBlocks() { return numFreeBlocks; }
+
+    /** Registers a module that creates pooled objects. */
+    static void addUser();
+
+    /** Unregisters a module; the last one releases the free lists. */
+    static void removeUser();
+
+    /**
+     * Records the pool statistics as scalars of the network (system)
+     * module. May be called from the finish() of every user; only the
+     * first call in a run records anything.
+     */
+    static void recordStatistics();
+};
+
+/**
+ * Base class for packets whose memory is managed by ObjectPool.
+ * Message classes can extend it instead of cPacket (e.g. in .msg files).
+ */
+class INET_API PooledPacket : public PooledPacket_Base
+{
+  public:
+    PooledPacket(const char *name = NULL, int kind = 0) : PooledPacket_Base(name, kind) {}
+    PooledPacket(const PooledPacket& other) : PooledPacket_Base(other) {}
+    PooledPacket& operator=(const PooledPacket& other) {PooledPacket_Base::operator=(other); return *this;}
+    virtual PooledPacket *dup() const {return new PooledPacket(*this);}
+
+    static void *operator new(size_t size) {return ObjectPool::allocate(size);}
+    static void operator delete(void *p, size_t size) {ObjectPool::release(p, size);}
+};
+
+/**
+ * Base class for control infos and other cObjects whose memory is managed
+ * by ObjectPool. Message classes can extend it instead of cObject.
+ */
+class INET_API PooledObject : public PooledObject_Base
+{
+  public:
+    PooledObject() : PooledObject_Base() {}
+    PooledObject(const PooledObject& other) : PooledObject_Base(other) {}
+    PooledObject& operator=(const PooledObject& other) {PooledObject_Base::operator=(other); return *this;}
+    virtual PooledObject *dup() const {return new PooledObject(*this);}
+
+    static void *operator new(size_t size) {return ObjectPool::allocate(size);}
+    static void operator delete(void *p, size_t size) {ObjectPool::release(p, size);}
+};
+
+#endif
+
@@ -60,30 +60,51 @@ void PassiveQueueBase::handleMessage(cMessage *msg)
         emit(queueingTimeSignal, 0L);
         sendOut(msg);
     }
-    else
-    {
-        msgId2TimeMap[msg->getId()] = simTime();
-        cMessage *droppedMsg = enqueue(msg);
-        if (msg != droppedMsg)
-            emit(enqueuePkSignal, msg);
-
-        if (droppedMsg)
-        {
-            numQueueDropped++;
-            emit(dropPkByQueueSignal, droppedMsg);
-            msgId2TimeMap.erase(droppedMsg->getId());
-            delete droppedMsg;
-        }
-        else
-            notifyListeners();
-    }
+    else if (enqueueOrDrop(msg))
+        notifyListeners();
 
     if (ev.isGUI())
+        updateDisplayString();
+}
+
+bool PassiveQueueBase::enqueueOrDrop(cMessage *msg)
+{
+    msgId2TimeMap[msg->getId()] = simTime();
+    cMessage *droppedMsg = enqueue(msg);
+    if (msg != droppedMsg)
+        emit(enqueuePkSignal, msg);
+
+    if (droppedMsg)
     {
-        char buf[40];
-        sprintf(buf, "q rcvd: %d\nq dropped: %d", numQueueReceived, numQueueDropped);
-        getDisplayString().setTagArg("t", 0, buf);
+        numQueueDropped++;
+        emit(dropPkByQueueSignal, droppedMsg);
+        msgId2TimeMap.erase(droppedMsg->getId());
+        delete droppedMsg;
     }
+    return droppedMsg == NULL;
+}
+
+void PassiveQueueBase::updateDisplayString()
+{
+    char buf[40];
+    sprintf(buf, "q rcvd: %d\nq dropped: %d", numQueueReceived, numQueueDropped);
+    getDisplayString().setTagArg("t", 0, buf);
+}
+
+bool PassiveQueueBase::insertPacket(cMessage *msg)
+{
+    Enter_Method_Silent();
+    take(msg);
+
+    numQueueReceived++;
+
+    emit(rcvdPkSignal, msg);
+
+    bool enqueued = enqueueOrDrop(msg);
+
+    if (ev.isGUI())
+        updateDisplayString();
+    return enqueued;
 }
 
 void PassiveQueueBase::requestPacket()
@@ -104,6 +125,20 @@ void PassiveQueueBase::requestPacket()
     }
 }
 
+cMessage *PassiveQueueBase::removePacket()
+{
+    Enter_Method_Silent();
+
+    cMessage *msg = dequeue();
+    if (msg)
+    {
+        emit(dequeuePkSignal, msg);
+        emit(queueingTimeSignal, simTime() - msgId2TimeMap[msg->getId()]);
+        msgId2TimeMap.erase(msg->getId());
+    }
+    return msg;
+}
+
 void PassiveQueueBase::clear()
 {
     cMessage *msg;
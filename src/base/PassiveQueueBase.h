@@ -65,6 +65,14 @@ class INET_API PassiveQueueBase : public cSimpleModule, public IPassiveQueue
 
     virtual void notifyListeners();
 
+    /**
+     * Enqueues the message, or drops it (or another message) if enqueue()
+     * says so, and records the statistics. Returns true if nothing was dropped.
+     */
+    virtual bool enqueueOrDrop(cMessage *msg);
+
+    virtual void updateDisplayString();
+
     /**
      * Inserts packet into the queue or the priority queue, or drops it
      * (or another packet). Returns NULL if successful, or the pointer of the dropped packet.
@@ -89,6 +97,20 @@ class INET_API PassiveQueueBase : public cSimpleModule, public IPassiveQueue
      */
     virtual void requestPacket();
 
+    /**
+     * Implementation of IPassiveQueue::removePacket().
+     */
+    virtual cMessage *removePacket();
+
+    /**
+     * Processes the message as if it had arrived on the input gate, but
+     * never sends it out and does not notify the listeners: it is used by
+     * modules that run the queue in process, and request packets with
+     * removePacket() (see DiffservQueuePipeline). Returns true if nothing
+     * was dropped.
+     */
+    virtual bool insertPacket(cMessage *msg);
+
     /**
      * Returns number of pending requests.
      */
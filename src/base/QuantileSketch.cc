@@ -0,0 +1,191 @@
+//
+// Copyright (C) 2013 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <limits>
+#include <math.h>
+
+#include "QuantileSketch.h"
+
+
+QuantileSketch::QuantileSketch(int subBuckets)
+{
+    if (subBuckets < 1 || (subBuckets & (subBuckets - 1)) != 0)
+        throw cRuntimeError("QuantileSketch: the number of sub-buckets must be a power of two, got %d", subBuckets);
+    this->subBuckets = subBuckets;
+    clear();
+}
+
+void QuantileSketch::clear()
+{
+    positive.clear();
+    negative.clear();
+    positiveBase = negativeBase = 0;
+    numZeros = 0;
+    count = 0;
+    sum = 0;
+    minValue = maxValue = 0;
+}
+
+int QuantileSketch::getBucketIndex(double absValue) const
+{
+    int exponent;
+    double mantissa = frexp(absValue, &exponent);  // absValue = mantissa * 2^exponent, 0.5 <= mantissa < 1
+    int sub = (int)((mantissa - 0.5) * 2 * subBuckets);
+    if (sub >= subBuckets)
+        sub = subBuckets - 1;
+    return exponent * subBuckets + sub;
+}
+
+double QuantileSketch::getBucketValue(int index) const
+{
+    // floor division, also for negative indices
+    int exponent = index >= 0 ? index / subBuckets : -((-index + subBuckets - 1) / subBuckets);
+    int sub = index - exponent * subBuckets;
+    return ldexp(0.5 + (sub + 0.5) / (2.0 * subBuckets), exponent);  // middle of the bucket
+}
+
+void QuantileSketch::addToBucket(std::vector<uint64>& buckets, int& base, int index)
+{
+    if (buckets.empty())
+    {
+        base = index;
+        buckets.push_back(0);
+    }
+    else if (index < base)
+    {
+        buckets.insert(buckets.begin(), base - index, 0);
+        base = index;
+    }
+    else if (index - base >= (int)buckets.size())
+        buckets.resize(index - base + 1, 0);
+    buckets[index - base]++;
+}
+
+void QuantileSketch::collect(double value)
+{
+    if (value != value)
+        return;
+
+    if (count == 0 || value < minValue)
+        minValue = value;
+    if (count == 0 || value > maxValue)
+        maxValue = value;
+    count++;
+    sum += value;
+
+    if (value > 0)
+        addToBucket(positive, positiveBase, getBucketIndex(value));
+    else if (value < 0)
+        addToBucket(negative, negativeBase, getBucketIndex(-value));
+    else
+        numZeros++;
+}
+
+void QuantileSketch::merge(const QuantileSketch& other)
+{
+    if (other.subBuckets != subBuckets)
+        throw cRuntimeError("QuantileSketch: cannot merge sketches of different resolution");
+    if (other.count == 0)
+        return;
+
+    if (count == 0 || other.minValue < minValue)
+        minValue = other.minValue;
+    if (count == 0 || other.maxValue > maxValue)
+        maxValue = other.maxValue;
+    count += other.count;
+    sum += other.sum;
+    numZeros += other.numZeros;
+
+    for (size_t i = 0; i < other.positive.size(); i++)
+    {
+        if (other.positive[i] == 0)
+            continue;
+        addToBucket(positive, positiveBase, other.positiveBase + i);
+        positive[other.positiveBase + i - positiveBase] += other.positive[i] - 1;
+    }
+    for (size_t i = 0; i < other.negative.size(); i++)
+    {
+        if (other.negative[i] == 0)
+            continue;
+        addToBucket(negative, negativeBase, other.negativeBase + i);
+        negative[other.negativeBase + i - negativeBase] += other.negative[i] - 1;
+    }
+}
+
+double QuantileSketch::getQuantile(double q) const
+{
+    if (count == 0)
+        return std::numeric_limits<double>::quiet_NaN();
+    if (q <= 0)
+        return minValue;
+    if (q >= 1)
+        return maxValue;
+
+    uint64 rank = (uint64)ceil(q * count);
+    if (rank < 1)
+        rank = 1;
+
+    // walk the values in increasing order: negative values from the largest magnitude, zeros, positive values
+    double value = maxValue;
+    uint64 cumulated = 0;
+    bool found = false;
+    for (int i = (int)negative.size() - 1; i >= 0 && !found; i--)
+    {
+        cumulated += negative[i];
+        if (cumulated >= rank)
+        {
+            value = -getBucketValue(negativeBase + i);
+            found = true;
+        }
+    }
+    if (!found)
+    {
+        cumulated += numZeros;
+        if (cumulated >= rank)
+        {
+            value = 0;
+            found = true;
+        }
+    }
+    for (int i = 0; i < (int)positive.size() && !found; i++)
+    {
+        cumulated += positive[i];
+        if (cumulated >= rank)
+        {
+            value = getBucketValue(positiveBase + i);
+            found = true;
+        }
+    }
+
+    // the bucket middle may lie outside the observed range
+    return value < minValue ? minValue : value > maxValue ? maxValue : value;
+}
+
+double QuantileSketch::getMean() const
+{
+    return count == 0 ? std::numeric_limits<double>::quiet_NaN() : sum / count;
+}
+
+double QuantileSketch::getMin() const
+{
+    return count == 0 ? std::numeric_limits<double>::quiet_NaN() : minValue;
+}
+
+double QuantileSketch::getMax() const
+{
+    return count == 0 ? std::numeric_limits<double>::quiet_NaN() : maxValue;
+}
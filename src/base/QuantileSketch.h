@@ -0,0 +1,88 @@
+//
+// Copyright (C) 2013 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __INET_QUANTILESKETCH_H
+#define __INET_QUANTILESKETCH_H
+
+#include <vector>
+
+#include "INETDefs.h"
+
+
+/**
+ * Bounded-memory, streaming estimator of the quantiles of a data set,
+ * in the style of HDR histograms.
+ *
+ * Values are counted in log-linear buckets: every power-of-two range
+ * [2^e, 2^(e+1)) of absolute values is divided into a fixed number of
+ * equal-width sub-buckets, so quantiles are estimated with a bounded
+ * relative error (about 0.8% with 64 sub-buckets) over any range of
+ * magnitudes. Only the buckets between the smallest and the largest
+ * value seen are allocated. Negative values and zeros are supported.
+ */
+class INET_API QuantileSketch
+{
+  protected:
+    int subBuckets;                 // sub-buckets per power of two
+    std::vector<uint64> positive;   // bucket counts of positive values, from index positiveBase
+    std::vector<uint64> negative;   // bucket counts of negative values by absolute value, from negativeBase
+    int positiveBase;
+    int negativeBase;
+    uint64 numZeros;
+    uint64 count;
+    double sum;
+    double minValue;
+    double maxValue;
+
+  protected:
+    int getBucketIndex(double absValue) const;
+    double getBucketValue(int index) const;
+    static void addToBucket(std::vector<uint64>& buckets, int& base, int index);
+
+  public:
+    /**
+     * The number of sub-buckets must be a power of two; more sub-buckets
+     * mean smaller error and more memory.
+     */
+    QuantileSketch(int subBuckets = 64);
+
+    /** Forgets all values. */
+    void clear();
+
+    /** Adds a value. NaNs are ignored. */
+    void collect(double value);
+
+    /** Adds all values of another sketch with the same number of sub-buckets. */
+    void merge(const QuantileSketch& other);
+
+    /**
+     * Returns the estimated q-quantile (0 <= q <= 1) of the values,
+     * or NaN if there are no values.
+     */
+    double getQuantile(double q) const;
+
+    uint64 getCount() const { return count; }
+    double getSum() const { return sum; }
+    double getMean() const;
+    double getMin() const;
+    double getMax() const;
+
+    /** Returns the number of allocated buckets, as a measure of memory use. */
+    size_t getNumBuckets() const { return positive.size() + negative.size(); }
+};
+
+#endif
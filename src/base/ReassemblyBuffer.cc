@@ -18,6 +18,7 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <algorithm>
 
 #include "INETDefs.h"
 
@@ -65,13 +66,7 @@ void ReassemblyBuffer::merge(ushort beg, ushort end, bool islast)
     else if (main.end<beg || main.beg>end)
     {
         // disjoint fragment, store it until another fragment fills in the gap
-        if (!fragments)
-            fragments = new RegionVector();
-        Region r;
-        r.beg = beg;
-        r.end = end;
-        r.islast = islast;
-        fragments->push_back(r);
+        storeFragment(beg, end, islast);
     }
     else
     {
@@ -80,50 +75,70 @@ void ReassemblyBuffer::merge(ushort beg, ushort end, bool islast)
     }
 }
 
-void ReassemblyBuffer::mergeFragments()
+void ReassemblyBuffer::storeFragment(ushort beg, ushort end, bool islast)
 {
+    if (!fragments)
+        fragments = new RegionVector();
     RegionVector& frags = *fragments;
 
-    bool oncemore;
-    do
+    // find the first region that starts after beg
+    Region r;
+    r.beg = beg;
+    r.end = end;
+    r.islast = islast;
+    RegionVector::iterator i = std::upper_bound(frags.begin(), frags.end(), r, compareBeg);
+
+    // coalesce with the preceding region if they touch or overlap
+    if (i != frags.begin() && (i-1)->end >= beg)
+    {
+        --i;
+        if (i->end < end)
+            i->end = end;
+        if (islast)
+            i->islast = true;
+    }
+    else
+    {
+        i = frags.insert(i, r);
+    }
+
+    // coalesce with the following regions that touch or overlap
+    RegionVector::iterator j = i + 1;
+    while (j != frags.end() && j->beg <= i->end)
     {
-        oncemore = false;
-        for (RegionVector::iterator i=frags.begin(); i!=frags.end(); )
-        {
-            bool deleteit = false;
-            Region& frag = *i;
-            if (main.end==frag.beg)
-            {
-                main.end = frag.end;
-                if (frag.islast)
-                    main.islast = true;
-                deleteit = true;
-            }
-            else if (main.beg==frag.end)
-            {
-                main.beg = frag.beg;
-                deleteit = true;
-            }
-            else if (main.beg<=frag.beg && main.end>=frag.end)
-            {
-                // we already have this region (duplicate fragment), delete it
-                deleteit = true;
-            }
-
-            if (deleteit)
-            {
-                // deletion is tricky because erase() invalidates iterator
-                int pos = i - frags.begin();
-                frags.erase(i);
-                i = frags.begin() + pos;
-                oncemore = true;
-            }
-            else
-            {
-                ++i;
-            }
-        }
+        if (i->end < j->end)
+            i->end = j->end;
+        if (j->islast)
+            i->islast = true;
+        ++j;
     }
-    while (oncemore);
+    frags.erase(i + 1, j);
 }
 
+void ReassemblyBuffer::mergeFragments()
+{
+    RegionVector& frags = *fragments;
+
+    // the stored regions are sorted and disjoint, so the ones that touch or
+    // overlap the main range are adjacent: those that start at or before
+    // main.end, going backwards while they end at or after main.beg
+    Region r;
+    r.beg = r.end = main.end;
+    r.islast = false;
+    RegionVector::iterator last = std::upper_bound(frags.begin(), frags.end(), r, compareBeg);
+    RegionVector::iterator first = last;
+    while (first != frags.begin() && (first-1)->end >= main.beg)
+        --first;
+
+    for (RegionVector::iterator i = first; i != last; ++i)
+    {
+        // (a region contained in the main range is a duplicate, and just gets deleted)
+        if (i->beg < main.beg)
+            main.beg = i->beg;
+        if (i->end > main.end)
+            main.end = i->end;
+        if (i->islast)
+            main.islast = true;
+    }
+    frags.erase(first, last);
+}
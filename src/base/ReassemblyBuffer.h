@@ -50,11 +50,18 @@ class INET_API ReassemblyBuffer
     // as new fragments arrive. If we receive non-connecting fragments,
     // put them aside into buf until new fragments come and fill the gap.
     //
+    // The regions put aside are kept sorted by offset, and adjacent or
+    // overlapping ones are coalesced, so both storing a fragment and
+    // finding the regions that connect to the main range take a binary
+    // search instead of a linear scan.
+    //
     Region main;   // offset range we already have
     RegionVector *fragments;  // only used if we receive disjoint fragments
 
   protected:
+    static bool compareBeg(const Region& a, const Region& b) {return a.beg < b.beg;}
     void merge(ushort beg, ushort end, bool islast);
+    void storeFragment(ushort beg, ushort end, bool islast);
     void mergeFragments();
 
   public:
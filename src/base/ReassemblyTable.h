@@ -0,0 +1,199 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __INET_REASSEMBLYTABLE_H
+#define __INET_REASSEMBLYTABLE_H
+
+#include <vector>
+
+#include "INETDefs.h"
+
+
+/**
+ * Table of the reassembly buffers of fragmented datagrams, keyed by the
+ * datagram identification (e.g. id, source and destination address).
+ *
+ * Currently used in IPv4FragBuf and IPv6FragBuf.
+ *
+ * Lookup is done in a chained hash table, so its cost does not grow with
+ * the number of datagrams under reassembly. All entries are also kept in
+ * an expiry list in the order of their timestamps (the time of creation
+ * or of the last touch()). Since all buffers of a table time out after
+ * the same time, the stale entries are always at the front of this list,
+ * and purging them does not need to scan the whole table.
+ *
+ * Key must provide operator== and a hash() method returning uint32;
+ * Buffer must be default constructible. Entries are never moved, so
+ * pointers to them stay valid until they are removed.
+ */
+template <class Key, class Buffer>
+class ReassemblyTable
+{
+  public:
+    struct Entry
+    {
+        Key key;
+        Buffer buf;
+        simtime_t timestamp;  // time of creation or last touch()
+
+        // internal
+        Entry *hashNext;  // next entry in the same bucket
+        Entry *prev;      // previous (older) entry in the expiry list
+        Entry *next;      // next (newer) entry in the expiry list
+    };
+
+  protected:
+    std::vector<Entry *> buckets;  // size is zero or a power of two
+    size_t numEntries;
+    Entry *oldest;  // head of the expiry list
+    Entry *newest;  // tail of the expiry list
+
+  protected:
+    size_t getBucketIndex(const Key& key) const
+    {
+        // Fibonacci hashing, as in MACAddressHashTable
+        uint64 h = (uint64)key.hash() * (uint64)0x9E3779B97F4A7C15ULL;
+        return (size_t)(h >> 32) & (buckets.size() - 1);
+    }
+
+    void grow()
+    {
+        std::vector<Entry *> oldBuckets;
+        oldBuckets.swap(buckets);
+        buckets.resize(oldBuckets.empty() ? 16 : 2 * oldBuckets.size(), (Entry *)NULL);
+        for (size_t i = 0; i < oldBuckets.size(); i++)
+        {
+            Entry *entry = oldBuckets[i];
+            while (entry)
+            {
+                Entry *hashNext = entry->hashNext;
+                Entry *&bucket = buckets[getBucketIndex(entry->key)];
+                entry->hashNext = bucket;
+                bucket = entry;
+                entry = hashNext;
+            }
+        }
+    }
+
+    void linkNewest(Entry *entry)
+    {
+        entry->prev = newest;
+        entry->next = NULL;
+        if (newest)
+            newest->next = entry;
+        else
+            oldest = entry;
+        newest = entry;
+    }
+
+    void unlinkExpiry(Entry *entry)
+    {
+        if (entry->prev)
+            entry->prev->next = entry->next;
+        else
+            oldest = entry->next;
+        if (entry->next)
+            entry->next->prev = entry->prev;
+        else
+            newest = entry->prev;
+    }
+
+  private:
+    // not copyable: the entries own their buffers
+    ReassemblyTable(const ReassemblyTable&);
+    ReassemblyTable& operator=(const ReassemblyTable&);
+
+  public:
+    ReassemblyTable() : numEntries(0), oldest(NULL), newest(NULL) {}
+
+    /**
+     * Deletes the entries; the buffers must release whatever they point to
+     * before, or in their destructor.
+     */
+    ~ReassemblyTable()
+    {
+        while (oldest)
+            remove(oldest);
+    }
+
+    /** Returns the number of entries. */
+    size_t size() const { return numEntries; }
+
+    /** Returns true if the table is empty. */
+    bool empty() const { return numEntries == 0; }
+
+    /** Returns the entry of the given key, or NULL if there is none. */
+    Entry *find(const Key& key) const
+    {
+        if (numEntries == 0)
+            return NULL;
+        for (Entry *entry = buckets[getBucketIndex(key)]; entry; entry = entry->hashNext)
+            if (entry->key == key)
+                return entry;
+        return NULL;
+    }
+
+    /**
+     * Inserts a new entry with a default constructed buffer for the given
+     * key, which must not be in the table yet. The timestamp must not be
+     * earlier than that of any entry in the table.
+     */
+    Entry *insert(const Key& key, simtime_t timestamp)
+    {
+        if (numEntries + 1 > buckets.size())
+            grow();
+        Entry *entry = new Entry();
+        entry->key = key;
+        entry->timestamp = timestamp;
+        Entry *&bucket = buckets[getBucketIndex(key)];
+        entry->hashNext = bucket;
+        bucket = entry;
+        linkNewest(entry);
+        numEntries++;
+        return entry;
+    }
+
+    /**
+     * Updates the timestamp of the entry, and moves it to the end of the
+     * expiry list. The timestamp must not be earlier than that of any entry
+     * in the table.
+     */
+    void touch(Entry *entry, simtime_t timestamp)
+    {
+        entry->timestamp = timestamp;
+        if (entry != newest)
+        {
+            unlinkExpiry(entry);
+            linkNewest(entry);
+        }
+    }
+
+    /** Removes and deletes the entry. */
+    void remove(Entry *entry)
+    {
+        Entry **p = &buckets[getBucketIndex(entry->key)];
+        while (*p != entry)
+            p = &(*p)->hashNext;
+        *p = entry->hashNext;
+        unlinkExpiry(entry);
+        numEntries--;
+        delete entry;
+    }
+
+    /** Returns the entry with the earliest timestamp, or NULL if the table is empty. */
+    Entry *getOldest() const { return oldest; }
+};
+
+#endif
@@ -0,0 +1,209 @@
+//
+// Copyright (C) 2013 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <math.h>
+
+#include "ResultRecorders.h"
+
+
+Register_GlobalConfigOptionU(CFGID_SUMMARY_RECORDING_INTERVAL, "summary-recording-interval", "s", "0s", "Interval of the summaries written by the quantiles, ewma and windowedRate result recorders into output vectors. Zero disables the vectors; the final summary is always recorded as scalars.");
+Register_GlobalConfigOption(CFGID_QUANTILE_RECORDER_RESOLUTION, "quantile-recorder-resolution", CFG_INT, "64", "Number of buckets per power of two in the quantiles result recorder; must be a power of two. The relative error of the quantiles is about 50% divided by this number.");
+Register_GlobalConfigOption(CFGID_EWMA_RECORDER_ALPHA, "ewma-recorder-alpha", CFG_DOUBLE, "0.1", "Weight of the newest value in the ewma result recorder, between 0 and 1.");
+
+Register_ResultRecorder("quantiles", QuantileRecorder);
+Register_ResultRecorder("ewma", EwmaRecorder);
+Register_ResultRecorder("windowedRate", WindowedRateRecorder);
+
+
+void IntervalResultRecorder::subscribedTo(cResultFilter *prev)
+{
+    cNumericResultRecorder::subscribedTo(prev);
+    interval = ev.getConfig()->getAsDouble(CFGID_SUMMARY_RECORDING_INTERVAL);
+    if (interval < 0)
+        throw cRuntimeError("summary-recording-interval must not be negative");
+    attributes = getStatisticAttributes();
+}
+
+void IntervalResultRecorder::collect(simtime_t_cref t, double value)
+{
+    if (interval > 0)
+    {
+        if (!started)
+        {
+            intervalStart = interval * floor(t / interval);
+            started = true;
+        }
+        else if (t >= intervalStart + interval)
+        {
+            endInterval(intervalStart + interval);
+            intervalStart = interval * floor(t / interval);
+        }
+    }
+    collectValue(t, value);
+}
+
+void IntervalResultRecorder::finish(cResultFilter *prev)
+{
+    // the open interval always holds the value that started it, even if it
+    // arrived at the current time; it must reach the summary
+    if (started)
+        endInterval(simTime());
+    recordSummary();
+}
+
+void *IntervalResultRecorder::registerVector(const char *suffix)
+{
+    std::string name = std::string(getStatisticName()) + ":" + suffix;
+    void *handle = ev.registerOutputVector(getComponent()->getFullPath().c_str(), name.c_str());
+    ASSERT(handle != NULL);
+    for (opp_string_map::iterator it = attributes.begin(); it != attributes.end(); ++it)
+        ev.setVectorAttribute(handle, it->first.c_str(), it->second.c_str());
+    return handle;
+}
+
+void IntervalResultRecorder::recordSummaryScalar(const char *suffix, double value)
+{
+    std::string name = std::string(getStatisticName()) + ":" + suffix;
+    ev.recordScalar(getComponent(), name.c_str(), value, &attributes);
+}
+
+
+QuantileRecorder::~QuantileRecorder()
+{
+    delete total;
+    delete current;
+}
+
+void QuantileRecorder::subscribedTo(cResultFilter *prev)
+{
+    IntervalResultRecorder::subscribedTo(prev);
+    int resolution = ev.getConfig()->getAsInt(CFGID_QUANTILE_RECORDER_RESOLUTION);
+    total = new QuantileSketch(resolution);
+    if (interval > 0)
+    {
+        current = new QuantileSketch(resolution);
+        p50Vector = registerVector("p50");
+        p99Vector = registerVector("p99");
+        p999Vector = registerVector("p999");
+    }
+}
+
+void QuantileRecorder::collectValue(simtime_t_cref t, double value)
+{
+    if (current)
+        current->collect(value);
+    else
+        total->collect(value);
+}
+
+void QuantileRecorder::endInterval(simtime_t_cref t)
+{
+    if (current->getCount() == 0)
+        return;
+    ev.recordInVector(p50Vector, t, current->getQuantile(0.5));
+    ev.recordInVector(p99Vector, t, current->getQuantile(0.99));
+    ev.recordInVector(p999Vector, t, current->getQuantile(0.999));
+    total->merge(*current);
+    current->clear();
+}
+
+void QuantileRecorder::recordSummary()
+{
+    recordSummaryScalar("count", total->getCount());
+    if (total->getCount() == 0)
+        return;
+    recordSummaryScalar("mean", total->getMean());
+    recordSummaryScalar("min", total->getMin());
+    recordSummaryScalar("max", total->getMax());
+    recordSummaryScalar("p50", total->getQuantile(0.5));
+    recordSummaryScalar("p90", total->getQuantile(0.9));
+    recordSummaryScalar("p99", total->getQuantile(0.99));
+    recordSummaryScalar("p999", total->getQuantile(0.999));
+}
+
+
+void EwmaRecorder::subscribedTo(cResultFilter *prev)
+{
+    IntervalResultRecorder::subscribedTo(prev);
+    alpha = ev.getConfig()->getAsDouble(CFGID_EWMA_RECORDER_ALPHA);
+    if (alpha <= 0 || alpha > 1)
+        throw cRuntimeError("ewma-recorder-alpha must be in (0,1], got %g", alpha);
+    if (interval > 0)
+        vector = registerVector("ewma");
+}
+
+void EwmaRecorder::collectValue(simtime_t_cref t, double value)
+{
+    average = hasValue ? alpha * value + (1 - alpha) * average : value;
+    hasValue = true;
+}
+
+void EwmaRecorder::endInterval(simtime_t_cref t)
+{
+    ev.recordInVector(vector, t, average);
+}
+
+void EwmaRecorder::recordSummary()
+{
+    if (hasValue)
+        recordSummaryScalar("ewma", average);
+}
+
+
+void WindowedRateRecorder::subscribedTo(cResultFilter *prev)
+{
+    IntervalResultRecorder::subscribedTo(prev);
+    if (interval > 0)
+    {
+        rateVector = registerVector("rate");
+        sumRateVector = registerVector("sumRate");
+    }
+}
+
+void WindowedRateRecorder::collectValue(simtime_t_cref t, double value)
+{
+    count++;
+    sum += value;
+}
+
+void WindowedRateRecorder::endInterval(simtime_t_cref t)
+{
+    double duration = (t - intervalStart).dbl();
+    if (duration > 0)  // zero if the simulation ends at the start of the interval
+    {
+        ev.recordInVector(rateVector, t, count / duration);
+        ev.recordInVector(sumRateVector, t, sum / duration);
+    }
+    totalCount += count;
+    totalSum += sum;
+    count = 0;
+    sum = 0;
+}
+
+void WindowedRateRecorder::recordSummary()
+{
+    totalCount += count;
+    totalSum += sum;
+    count = 0;
+    sum = 0;
+    double duration = (simTime() - simulation.getWarmupPeriod()).dbl();
+    if (duration > 0)
+    {
+        recordSummaryScalar("rate", totalCount / duration);
+        recordSummaryScalar("sumRate", totalSum / duration);
+    }
+}
@@ -0,0 +1,156 @@
+//
+// Copyright (C) 2013 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __INET_RESULTRECORDERS_H
+#define __INET_RESULTRECORDERS_H
+
+#include "INETDefs.h"
+
+#include "QuantileSketch.h"
+
+
+/**
+ * Base class for result recorders that keep a bounded-memory summary of
+ * the values and write it out periodically instead of recording every
+ * value. The period is set with the summary-recording-interval
+ * configuration option; zero means that only the final summary is
+ * recorded, as scalars, at the end of the simulation.
+ *
+ * Intervals are aligned to multiples of the interval length. Summaries are
+ * written when a value arrives after the end of the current interval, and
+ * at the end of the simulation; intervals without values are not written.
+ *
+ * Per-value vectors of existing statistics can be replaced from omnetpp.ini:
+ * <pre>
+ * **.endToEndDelay.result-recording-modes = -vector,+quantiles
+ * summary-recording-interval = 10s
+ * </pre>
+ */
+class INET_API IntervalResultRecorder : public cNumericResultRecorder
+{
+  protected:
+    simtime_t interval;
+    simtime_t intervalStart;
+    bool started;
+    opp_string_map attributes;
+
+  protected:
+    virtual void subscribedTo(cResultFilter *prev);
+    virtual void collect(simtime_t_cref t, double value);
+    virtual void finish(cResultFilter *prev);
+
+    /** Adds a value to the current interval and to the overall summary. */
+    virtual void collectValue(simtime_t_cref t, double value) = 0;
+    /** Records the summary of the interval that ends at t, and starts a new one. */
+    virtual void endInterval(simtime_t_cref t) = 0;
+    /** Records the overall summary as scalars. */
+    virtual void recordSummary() = 0;
+
+    /** Registers an output vector named "<statistic>:<suffix>", with the statistic's attributes. */
+    void *registerVector(const char *suffix);
+    /** Records a scalar named "<statistic>:<suffix>", with the statistic's attributes. */
+    void recordSummaryScalar(const char *suffix, double value);
+
+  public:
+    IntervalResultRecorder() : started(false) {}
+};
+
+/**
+ * Records the p50, p90, p99 and p999 quantiles, count, mean, min and max
+ * of the values using a QuantileSketch, in constant memory per statistic.
+ * Per-interval quantiles are written to the "<statistic>:p50", ":p99" and
+ * ":p999" vectors. The resolution of the sketch is set with the
+ * quantile-recorder-resolution configuration option.
+ *
+ * Usable in @statistic declarations as record=quantiles.
+ */
+class INET_API QuantileRecorder : public IntervalResultRecorder
+{
+  protected:
+    QuantileSketch *total;
+    QuantileSketch *current;
+    void *p50Vector;
+    void *p99Vector;
+    void *p999Vector;
+
+  protected:
+    virtual void subscribedTo(cResultFilter *prev);
+    virtual void collectValue(simtime_t_cref t, double value);
+    virtual void endInterval(simtime_t_cref t);
+    virtual void recordSummary();
+
+  public:
+    QuantileRecorder() : total(NULL), current(NULL), p50Vector(NULL), p99Vector(NULL), p999Vector(NULL) {}
+    virtual ~QuantileRecorder();
+};
+
+/**
+ * Records the exponentially weighted moving average of the values:
+ * avg = alpha * value + (1 - alpha) * avg, with alpha set by the
+ * ewma-recorder-alpha configuration option. The average is written to
+ * the "<statistic>:ewma" vector at the end of every interval, and as a
+ * scalar at the end of the simulation.
+ *
+ * Usable in @statistic declarations as record=ewma.
+ */
+class INET_API EwmaRecorder : public IntervalResultRecorder
+{
+  protected:
+    double alpha;
+    double average;
+    bool hasValue;
+    void *vector;
+
+  protected:
+    virtual void subscribedTo(cResultFilter *prev);
+    virtual void collectValue(simtime_t_cref t, double value);
+    virtual void endInterval(simtime_t_cref t);
+    virtual void recordSummary();
+
+  public:
+    EwmaRecorder() : alpha(0), average(0), hasValue(false), vector(NULL) {}
+};
+
+/**
+ * Records the number of values per second ("<statistic>:rate") and the sum
+ * of the values per second ("<statistic>:sumRate", e.g. throughput when
+ * the source is packetBytes or packetBits) in every interval. At the end of
+ * the simulation, the averages over the whole simulation are recorded.
+ *
+ * Usable in @statistic declarations as record=windowedRate.
+ */
+class INET_API WindowedRateRecorder : public IntervalResultRecorder
+{
+  protected:
+    long count;
+    double sum;
+    long totalCount;
+    double totalSum;
+    void *rateVector;
+    void *sumRateVector;
+
+  protected:
+    virtual void subscribedTo(cResultFilter *prev);
+    virtual void collectValue(simtime_t_cref t, double value);
+    virtual void endInterval(simtime_t_cref t);
+    virtual void recordSummary();
+
+  public:
+    WindowedRateRecorder() : count(0), sum(0), totalCount(0), totalSum(0), rateVector(NULL), sumRateVector(NULL) {}
+};
+
+#endif
@@ -38,14 +38,21 @@ void Sink::initialize()
 
 void Sink::handleMessage(cMessage *msg)
 {
+    consumePacket(PK(msg));
+}
+
+void Sink::consumePacket(cPacket *packet)
+{
+    Enter_Method_Silent();
+    take(packet);
+
     numPackets++;
-    cPacket *packet = PK(msg);
     numBits += packet->getBitLength();
     emit(rcvdPkSignal, packet);
     throughput = numBits / simTime();
     packetPerSec = numPackets / simTime();
 
-    delete msg;
+    delete packet;
 }
 
 void Sink::finish()
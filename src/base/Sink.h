@@ -39,6 +39,13 @@ class INET_API Sink : public cSimpleModule
     virtual void initialize();
     virtual void handleMessage(cMessage *msg);
     virtual void finish();
+
+  public:
+    /**
+     * Counts and deletes the packet as if it had arrived on an input gate;
+     * used when the sink is run in process (see DiffservQueuePipeline).
+     */
+    virtual void consumePacket(cPacket *packet);
 };
 
 #endif
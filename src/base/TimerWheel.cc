@@ -0,0 +1,241 @@
+//
+// Copyright (C) 2013 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#include "TimerWheel.h"
+
+
+static int findFirstSetBit(uint64 bits)
+{
+#ifdef __GNUC__
+    return __builtin_ctzll(bits);
+#else
+    int i = 0;
+    while (!(bits & 1))
+    {
+        bits >>= 1;
+        i++;
+    }
+    return i;
+#endif
+}
+
+TimerWheel::TimerWheel(simtime_t granularity)
+{
+    if (granularity <= 0)
+        throw cRuntimeError("TimerWheel: granularity must be positive");
+    this->granularity = granularity;
+    currentTick = getTick(simTime());
+    for (int i = 0; i <= OVERFLOW_SLOT; i++)
+        slots[i].head = slots[i].tail = NULL;
+    for (int i = 0; i < NUM_LEVELS; i++)
+        occupied[i] = 0;
+    numTimers = 0;
+}
+
+TimerWheel::~TimerWheel()
+{
+    for (int i = 0; i <= OVERFLOW_SLOT; i++)
+    {
+        for (Timer *timer = slots[i].head; timer; timer = timer->next)
+        {
+            timer->wheel = NULL;
+            timer->slot = -1;
+        }
+    }
+}
+
+void TimerWheel::link(Timer *timer, int slot)
+{
+    Slot& s = slots[slot];
+    timer->slot = slot;
+    timer->prev = s.tail;
+    timer->next = NULL;
+    if (s.tail)
+        s.tail->next = timer;
+    else
+        s.head = timer;
+    s.tail = timer;
+    if (slot != OVERFLOW_SLOT)
+        occupied[slot >> LEVEL_BITS] |= (uint64)1 << (slot & SLOT_MASK);
+}
+
+void TimerWheel::unlink(Timer *timer)
+{
+    Slot& s = slots[timer->slot];
+    if (timer->prev)
+        timer->prev->next = timer->next;
+    else
+        s.head = timer->next;
+    if (timer->next)
+        timer->next->prev = timer->prev;
+    else
+        s.tail = timer->prev;
+    if (!s.head && timer->slot != OVERFLOW_SLOT)
+        occupied[timer->slot >> LEVEL_BITS] &= ~((uint64)1 << (timer->slot & SLOT_MASK));
+    timer->prev = timer->next = NULL;
+    timer->slot = -1;
+}
+
+void TimerWheel::insert(Timer *timer)
+{
+    // the timer goes to the lowest level on which its tick is in the same
+    // block as the current tick; on levels above 0 this is never the current slot
+    int64 tick = getTick(timer->slotTime);
+    ASSERT(tick >= currentTick);
+    int64 diff = tick ^ currentTick;
+    for (int level = 0; level < NUM_LEVELS; level++)
+    {
+        if ((diff >> (LEVEL_BITS * (level + 1))) == 0)
+        {
+            link(timer, (level << LEVEL_BITS) | (int)((tick >> (LEVEL_BITS * level)) & SLOT_MASK));
+            return;
+        }
+    }
+    link(timer, OVERFLOW_SLOT);
+}
+
+void TimerWheel::reinsertSlot(int slot)
+{
+    // detach the list first: timers may be linked back into the same (overflow) slot
+    Timer *timer = slots[slot].head;
+    slots[slot].head = slots[slot].tail = NULL;
+    if (slot != OVERFLOW_SLOT)
+        occupied[slot >> LEVEL_BITS] &= ~((uint64)1 << (slot & SLOT_MASK));
+    while (timer)
+    {
+        Timer *next = timer->next;
+        insert(timer);
+        timer = next;
+    }
+}
+
+void TimerWheel::advance(int64 tick)
+{
+    if (tick <= currentTick)
+        return;
+    int64 oldTick = currentTick;
+    currentTick = tick;
+
+    // when the block of a level changes, the timers of its new current slot
+    // (and of the overflow list for the last level) move to the lower levels
+    if ((oldTick >> (LEVEL_BITS * NUM_LEVELS)) != (tick >> (LEVEL_BITS * NUM_LEVELS)))
+        reinsertSlot(OVERFLOW_SLOT);
+    for (int level = NUM_LEVELS - 1; level > 0; level--)
+        if ((oldTick >> (LEVEL_BITS * level)) != (tick >> (LEVEL_BITS * level)))
+            reinsertSlot((level << LEVEL_BITS) | (int)((tick >> (LEVEL_BITS * level)) & SLOT_MASK));
+}
+
+void TimerWheel::schedule(Timer *timer, simtime_t expiryTime)
+{
+    if (expiryTime < simTime())
+        throw cRuntimeError("TimerWheel: cannot schedule a timer in the past (t=%s)", SIMTIME_STR(expiryTime));
+
+    if (timer->wheel == this)
+    {
+        // lazy reschedule: a later timer stays in its slot until it comes due
+        if (expiryTime >= timer->slotTime)
+        {
+            timer->expiryTime = expiryTime;
+            return;
+        }
+        unlink(timer);
+        numTimers--;
+    }
+    else if (timer->wheel)
+        throw cRuntimeError("TimerWheel: timer is already scheduled in another wheel");
+
+    // the wheel is only advanced by popExpired(); after an idle period the
+    // current tick may lag behind, and the slots would be computed from it
+    advance(getTick(simTime()));
+
+    timer->wheel = this;
+    timer->slotTime = timer->expiryTime = expiryTime;
+    insert(timer);
+    numTimers++;
+}
+
+void TimerWheel::cancel(Timer *timer)
+{
+    if (timer->wheel != this)
+        return;
+    unlink(timer);
+    timer->wheel = NULL;
+    numTimers--;
+}
+
+TimerWheel::Timer *TimerWheel::popExpired()
+{
+    simtime_t now = simTime();
+    advance(getTick(now));
+
+    // the current slot of level 0 holds the timers of the current tick
+    Timer *timer = slots[currentTick & SLOT_MASK].head;
+    while (timer)
+    {
+        Timer *next = timer->next;
+        if (timer->slotTime <= now)
+        {
+            unlink(timer);
+            if (timer->expiryTime <= now)
+            {
+                timer->wheel = NULL;
+                numTimers--;
+                return timer;
+            }
+            // rescheduled lazily: move it to its actual expiry time
+            timer->slotTime = timer->expiryTime;
+            insert(timer);
+        }
+        timer = next;
+    }
+    return NULL;
+}
+
+simtime_t TimerWheel::getNextEventTime() const
+{
+    // level 0: the earliest timer of the first occupied slot
+    uint64 bits = occupied[0] & (~(uint64)0 << (currentTick & SLOT_MASK));
+    if (bits)
+    {
+        const Slot& s = slots[findFirstSetBit(bits)];
+        simtime_t time = s.head->slotTime;
+        for (Timer *timer = s.head->next; timer; timer = timer->next)
+            if (timer->slotTime < time)
+                time = timer->slotTime;
+        return time;
+    }
+
+    // higher levels: the start of the first occupied slot, where its timers move down
+    for (int level = 1; level < NUM_LEVELS; level++)
+    {
+        int digit = (int)((currentTick >> (LEVEL_BITS * level)) & SLOT_MASK);
+        bits = digit == SLOT_MASK ? 0 : occupied[level] & (~(uint64)0 << (digit + 1));
+        if (bits)
+        {
+            int64 blockStart = (currentTick >> (LEVEL_BITS * (level + 1))) << (LEVEL_BITS * (level + 1));
+            return getTickTime(blockStart | ((int64)findFirstSetBit(bits) << (LEVEL_BITS * level)));
+        }
+    }
+
+    // overflow list: the start of the next block of the last level
+    if (slots[OVERFLOW_SLOT].head)
+        return getTickTime(((currentTick >> (LEVEL_BITS * NUM_LEVELS)) + 1) << (LEVEL_BITS * NUM_LEVELS));
+
+    return MAXTIME;
+}
+
@@ -0,0 +1,142 @@
+//
+// Copyright (C) 2013 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef __INET_TIMERWHEEL_H
+#define __INET_TIMERWHEEL_H
+
+#include "INETDefs.h"
+
+
+/**
+ * Hierarchical timer wheel for modules that keep many timers, most of
+ * which are cancelled or restarted before they expire (e.g. the
+ * retransmission timers of TCP connections). The module schedules a single
+ * self-message at getNextEventTime(), and calls popExpired() when it
+ * arrives; this keeps the timers out of the future event set.
+ *
+ * Timers are stored in NUM_LEVELS levels of NUM_SLOTS slots each; a slot of
+ * level k covers granularity * NUM_SLOTS^k time, and timers farther than
+ * the last level are kept in an overflow list. Scheduling and cancelling is
+ * O(1); timers move to lower levels as their slot comes due. The timers
+ * still expire at their exact time: the granularity only affects
+ * performance, not the order or time of expiry.
+ *
+ * Rescheduling a pending timer to a later time is lazy: the timer stays in
+ * its slot, and is only moved when it comes due. This makes restarting a
+ * timer on every received packet cheap.
+ */
+class INET_API TimerWheel
+{
+  public:
+    /**
+     * Base class of the timers stored in the wheel. Subclasses add the
+     * payload, e.g. a timer message can subclass both cMessage and Timer.
+     * Deleting a pending timer removes it from the wheel.
+     */
+    class INET_API Timer
+    {
+        friend class TimerWheel;
+      private:
+        TimerWheel *wheel;      // the wheel the timer is pending in, or NULL
+        Timer *prev;
+        Timer *next;
+        int slot;
+        simtime_t slotTime;     // the time the timer is stored for in its slot
+        simtime_t expiryTime;   // later than slotTime if rescheduled lazily
+
+      public:
+        Timer() : wheel(NULL), prev(NULL), next(NULL), slot(-1) {}
+        Timer(const Timer& other) : wheel(NULL), prev(NULL), next(NULL), slot(-1) {}
+        virtual ~Timer() {if (wheel) wheel->cancel(this);}
+        Timer& operator=(const Timer& other) {return *this;}
+
+        /** Returns true if the timer is scheduled in a wheel. */
+        bool isPending() const {return wheel != NULL;}
+
+        /** Returns the time the timer expires at; only valid if isPending(). */
+        simtime_t getExpiryTime() const {return expiryTime;}
+    };
+
+  protected:
+    enum { LEVEL_BITS = 6, NUM_SLOTS = 1 << LEVEL_BITS, SLOT_MASK = NUM_SLOTS - 1, NUM_LEVELS = 4,
+           OVERFLOW_SLOT = NUM_LEVELS * NUM_SLOTS };
+
+    struct Slot
+    {
+        Timer *head;
+        Timer *tail;
+    };
+
+    simtime_t granularity;
+    int64 currentTick;              // all pending timers are at or after this tick
+    Slot slots[NUM_LEVELS * NUM_SLOTS + 1];
+    uint64 occupied[NUM_LEVELS];    // bit i is set if slot i of the level is not empty
+    int numTimers;
+
+  protected:
+    int64 getTick(simtime_t time) const {return time.raw() / granularity.raw();}
+    simtime_t getTickTime(int64 tick) const {return SimTime().setRaw(tick * granularity.raw());}
+    void link(Timer *timer, int slot);
+    void unlink(Timer *timer);
+    void insert(Timer *timer);
+    void reinsertSlot(int slot);
+    void advance(int64 tick);
+
+  public:
+    /**
+     * Creates a timer wheel; the granularity should be in the order of
+     * the typical timeouts divided by NUM_SLOTS.
+     */
+    TimerWheel(simtime_t granularity);
+
+    /**
+     * Removes the pending timers from the wheel, without deleting them.
+     */
+    ~TimerWheel();
+
+    /**
+     * Schedules the timer to expire at the given time, which must not be
+     * in the past. A pending timer is rescheduled.
+     */
+    void schedule(Timer *timer, simtime_t expiryTime);
+
+    /**
+     * Cancels the timer; does nothing if it is not pending in this wheel.
+     */
+    void cancel(Timer *timer);
+
+    /**
+     * Returns a timer that expired at the current simulation time or before,
+     * and removes it from the wheel; returns NULL if there is none. Must be
+     * called at getNextEventTime(), and may be called any time before it.
+     */
+    Timer *popExpired();
+
+    /**
+     * Returns the time popExpired() needs to be called at: the expiry time of
+     * the next timer, or an earlier time at which timers move to a lower level.
+     * Returns MAXTIME if the wheel is empty.
+     */
+    simtime_t getNextEventTime() const;
+
+    /** Returns the number of pending timers. */
+    int getNumTimers() const {return numTimers;}
+};
+
+#endif
+
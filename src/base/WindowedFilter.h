@@ -0,0 +1,129 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __INET_WINDOWEDFILTER_H
+#define __INET_WINDOWEDFILTER_H
+
+#include <functional>
+
+#include "INETDefs.h"
+
+
+/**
+ * Tracks the maximum (or minimum) of a series of samples over a sliding
+ * window of time, in constant time and space: Kathleen Nichols' algorithm,
+ * as used by BBR (and in Linux lib/win_minmax.c). Besides the best sample,
+ * the second and third best samples of later sub-windows are kept, so that
+ * the estimate falls back to them when the best one gets older than the
+ * window.
+ *
+ * V is the type of the samples, T is the type of time (e.g. simtime_t,
+ * or a round counter), and Better(a, b) must return true if sample a is
+ * strictly better than b: std::greater<V> for a max filter, std::less<V>
+ * for a min filter.
+ */
+template <typename V, typename T, typename Better = std::greater<V> >
+class WindowedFilter
+{
+  protected:
+    struct Sample
+    {
+        V value;
+        T time;
+    };
+
+    T window;
+    Sample estimates[3];  // best, second best and third best samples
+    Better better;
+
+  protected:
+    void updateSubwindows(const Sample& sample)
+    {
+        T dt = sample.time - estimates[0].time;
+
+        if (dt > window)
+        {
+            // the best sample has expired: promote the second and third best
+            estimates[0] = estimates[1];
+            estimates[1] = estimates[2];
+            estimates[2] = sample;
+            if (sample.time - estimates[0].time > window)
+            {
+                estimates[0] = estimates[1];
+                estimates[1] = estimates[2];
+            }
+        }
+        else if (estimates[1].time == estimates[0].time && dt > window / 4)
+        {
+            // a quarter of the window has passed without a second best sample
+            estimates[2] = estimates[1] = sample;
+        }
+        else if (estimates[2].time == estimates[1].time && dt > window / 2)
+        {
+            // half of the window has passed without a third best sample
+            estimates[2] = sample;
+        }
+    }
+
+  public:
+    /**
+     * Creates a filter with the given window, with the value as initial
+     * estimate.
+     */
+    WindowedFilter(T window, V value = V(), T time = T()) : window(window)
+    {
+        reset(value, time);
+    }
+
+    /** Forgets all samples, and makes value the estimate. */
+    void reset(V value, T time)
+    {
+        estimates[0].value = value;
+        estimates[0].time = time;
+        estimates[2] = estimates[1] = estimates[0];
+    }
+
+    /**
+     * Adds a sample. Times must not decrease from one call to the next.
+     */
+    void update(V value, T time)
+    {
+        Sample sample;
+        sample.value = value;
+        sample.time = time;
+
+        if (!better(estimates[0].value, value) || time - estimates[2].time > window)
+        {
+            // new best sample, or nothing left in the window
+            reset(value, time);
+            return;
+        }
+
+        if (!better(estimates[1].value, value))
+            estimates[2] = estimates[1] = sample;
+        else if (!better(estimates[2].value, value))
+            estimates[2] = sample;
+
+        updateSubwindows(sample);
+    }
+
+    /** Returns the best sample of the window. */
+    V get() const {return estimates[0].value;}
+
+    /** Returns the length of the window. */
+    T getWindow() const {return window;}
+};
+
+#endif
@@ -0,0 +1,216 @@
+//
+// Copyright (C) 2013 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __INET_MACADDRESSHASHTABLE_H
+#define __INET_MACADDRESSHASHTABLE_H
+
+#include <vector>
+
+#include "INETDefs.h"
+#include "MACAddress.h"
+
+
+/**
+ * Compact hash table keyed by MACAddress, for per-station records that are
+ * looked up on every received frame (e.g. in 802.11 MACs and access points
+ * with many associated stations).
+ *
+ * Uses open addressing with linear probing in a single contiguous array,
+ * so a lookup touches one or two cache lines instead of walking a tree.
+ * Pointers to values remain valid until the next insertion or removal.
+ */
+template <class T>
+class MACAddressHashTable
+{
+  protected:
+    struct Slot
+    {
+        bool used;
+        MACAddress key;
+        T value;
+        Slot() : used(false) {}
+    };
+
+    std::vector<Slot> slots;  // size is zero or a power of two
+    size_t numEntries;
+
+  protected:
+    size_t getSlotIndex(const MACAddress& key) const
+    {
+        // Fibonacci hashing of the 48-bit address
+        uint64 h = key.getInt() * (uint64)0x9E3779B97F4A7C15ULL;
+        return (size_t)(h >> 32) & (slots.size() - 1);
+    }
+
+    size_t findSlot(const MACAddress& key) const
+    {
+        size_t mask = slots.size() - 1;
+        size_t i = getSlotIndex(key);
+        while (slots[i].used && slots[i].key != key)
+            i = (i + 1) & mask;
+        return i;
+    }
+
+    void grow()
+    {
+        std::vector<Slot> oldSlots;
+        oldSlots.swap(slots);
+        slots.resize(oldSlots.empty() ? 16 : 2 * oldSlots.size());
+        for (size_t i = 0; i < oldSlots.size(); i++)
+        {
+            if (oldSlots[i].used)
+            {
+                Slot& slot = slots[findSlot(oldSlots[i].key)];
+                slot.used = true;
+                slot.key = oldSlots[i].key;
+                slot.value = oldSlots[i].value;
+            }
+        }
+    }
+
+    void removeSlot(size_t i)
+    {
+        // backward shift deletion: no tombstones are needed
+        size_t mask = slots.size() - 1;
+        size_t j = i;
+        while (true)
+        {
+            j = (j + 1) & mask;
+            if (!slots[j].used)
+                break;
+            size_t home = getSlotIndex(slots[j].key);
+            // move slots[j] into the hole if its home is not within (i, j]
+            if ((i <= j) ? (home <= i || home > j) : (home <= i && home > j))
+            {
+                slots[i] = slots[j];
+                i = j;
+            }
+        }
+        slots[i].used = false;
+        slots[i].value = T();
+        numEntries--;
+    }
+
+  public:
+    MACAddressHashTable() : numEntries(0) {}
+
+    /** Returns the number of entries. */
+    size_t size() const { return numEntries; }
+
+    /** Returns true if the table is empty. */
+    bool empty() const { return numEntries == 0; }
+
+    /** Removes all entries. */
+    void clear() { slots.clear(); numEntries = 0; }
+
+    /** Returns the value stored for the given address, or NULL if there is none. */
+    T *find(const MACAddress& key)
+    {
+        if (numEntries == 0)
+            return NULL;
+        Slot& slot = slots[findSlot(key)];
+        return slot.used ? &slot.value : NULL;
+    }
+
+    const T *find(const MACAddress& key) const
+    {
+        return const_cast<MACAddressHashTable *>(this)->find(key);
+    }
+
+    /**
+     * Returns the value stored for the given address, inserting a default
+     * constructed value if there is none. The inserted flag tells which case happened.
+     */
+    T& findOrInsert(const MACAddress& key, bool& inserted)
+    {
+        if (2 * (numEntries + 1) > slots.size())
+            grow();
+        Slot& slot = slots[findSlot(key)];
+        inserted = !slot.used;
+        if (inserted)
+        {
+            slot.used = true;
+            slot.key = key;
+            numEntries++;
+        }
+        return slot.value;
+    }
+
+    /** Like std::map's operator[]: inserts a default constructed value if not present. */
+    T& operator[](const MACAddress& key)
+    {
+        bool inserted;
+        return findOrInsert(key, inserted);
+    }
+
+    /** Removes the entry of the given address; returns false if there was none. */
+    bool erase(const MACAddress& key)
+    {
+        if (numEntries == 0)
+            return false;
+        size_t i = findSlot(key);
+        if (!slots[i].used)
+            return false;
+        removeSlot(i);
+        return true;
+    }
+
+    /**
+     * Removes all entries for which pred(key, value) returns true.
+     * Returns the number of removed entries.
+     */
+    template <class Predicate>
+    size_t removeIf(Predicate pred)
+    {
+        size_t numRemoved = 0;
+        size_t i = 0;
+        while (i < slots.size())
+        {
+            // after a removal, slot i may hold a shifted entry, so it is checked again
+            if (slots[i].used && pred(slots[i].key, slots[i].value))
+            {
+                removeSlot(i);
+                numRemoved++;
+            }
+            else
+                i++;
+        }
+        return numRemoved;
+    }
+
+    /** @name Iteration over the slots, for printing and statistics */
+    //@{
+    size_t getNumSlots() const { return slots.size(); }
+    bool isSlotUsed(size_t i) const { return slots[i].used; }
+    const MACAddress& getKey(size_t i) const { return slots[i].key; }
+    T& getValue(size_t i) { return slots[i].value; }
+    const T& getValue(size_t i) const { return slots[i].value; }
+    //@}
+};
+
+template <class T>
+std::ostream& operator<<(std::ostream& os, const MACAddressHashTable<T>& table)
+{
+    os << table.size() << " entries";
+    for (size_t i = 0; i < table.getNumSlots(); i++)
+        if (table.isSlotUsed(i))
+            os << "; " << table.getKey(i) << " ==> " << table.getValue(i);
+    return os;
+}
+
+#endif
+
@@ -19,6 +19,8 @@
 
 Define_Module(EtherBus);
 
+simsignal_t EtherBus::frameCopySignal = SIMSIGNAL_NULL;
+
 static cEnvir& operator<<(cEnvir& out, cMessage *msg)
 {
     out.printf("(%s)%s", msg->getClassName(), msg->getFullName());
@@ -37,8 +39,12 @@ EtherBus::~EtherBus()
 
 void EtherBus::initialize()
 {
+    frameCopySignal = registerSignal("frameCopy");
+
     numMessages = 0;
+    numCopies = 0;
     WATCH(numMessages);
+    WATCH(numCopies);
 
     propagationSpeed = par("propagationSpeed").doubleValue();
 
@@ -209,12 +215,14 @@ void EtherBus::handleMessage(cMessage *msg)
         int tapPoint = msg->getArrivalGate()->getIndex();
         EV << "Frame " << msg << " arrived on tap " << tapPoint << endl;
 
+        numMessages++;
+
         // create upstream and downstream events
         if (tapPoint > 0)
         {
             // start UPSTREAM travel
             // if goes downstream too, we need to make a copy
-            cMessage *msg2 = (tapPoint < numTaps-1) ? msg->dup() : msg;
+            cMessage *msg2 = (tapPoint < numTaps-1) ? copyFrame(msg) : msg;
             msg2->setKind(UPSTREAM);
             msg2->setContextPointer(&tap[tapPoint-1]);
             scheduleAt(simTime()+tap[tapPoint].propagationDelay[UPSTREAM], msg2);
@@ -249,7 +257,7 @@ void EtherBus::handleMessage(cMessage *msg)
         if (ogate->isConnected())
         {
             // send out on gate
-            cMessage *msg2 = isLast ? msg : msg->dup();
+            cMessage *msg2 = isLast ? msg : copyFrame(msg);
 
             // stop current transmission
             ogate->getTransmissionChannel()->forceTransmissionFinishTime(SIMTIME_ZERO);
@@ -277,11 +285,21 @@ void EtherBus::handleMessage(cMessage *msg)
     }
 }
 
+cMessage *EtherBus::copyFrame(cMessage *msg)
+{
+    // shallow copy: the encapsulated packets are shared until decapsulated
+    cMessage *copy = msg->dup();
+    numCopies++;
+    emit(frameCopySignal, copy);
+    return copy;
+}
+
 void EtherBus::finish()
 {
     simtime_t t = simTime();
     recordScalar("simulated time", t);
     recordScalar("messages handled", numMessages);
+    recordScalar("frame copies", numCopies);
 
     if (t > 0)
         recordScalar("messages/sec", numMessages / t);
@@ -29,6 +29,10 @@
 /**
  * Implements the shared coaxial cable in classic Ethernet. See the NED file
  * for more description.
+ *
+ * Copies of a frame are made only where the signal splits: one for the
+ * upstream direction at the sending tap, and one for each tap a traveling
+ * frame passes. Copies share the encapsulated packets (see EtherHub).
  */
 class INET_API EtherBus : public cSimpleModule, cListener
 {
@@ -56,6 +60,8 @@ class INET_API EtherBus : public cSimpleModule, cListener
 
     // statistics
     long numMessages;  // number of messages handled
+    long numCopies;    // number of frame copies made
+    static simsignal_t frameCopySignal;
 
   public:
     EtherBus();
@@ -68,6 +74,7 @@ class INET_API EtherBus : public cSimpleModule, cListener
     virtual void receiveSignal(cComponent *source, simsignal_t signalID, cObject *obj);
 
     virtual void checkConnections(bool errorWhenAsymmetric);
+    virtual cMessage *copyFrame(cMessage *msg);
 };
 
 #endif
@@ -22,6 +22,10 @@
 #include "EtherFrame_m.h"
 #include "IInterfaceTable.h"
 
+#ifdef WITH_TCP_COMMON
+#include "TCPSegmentationOffload.h"
+#endif
+
 
 Define_Module(EtherEncap);
 
@@ -85,8 +89,14 @@ void EtherEncap::updateDisplayString()
 
 void EtherEncap::processPacketFromHigherLayer(cPacket *msg)
 {
-    if (msg->getByteLength() > MAX_ETHERNET_DATA_BYTES)
-        error("packet from higher layer (%d bytes) exceeds maximum Ethernet payload length (%d)", (int)msg->getByteLength(), MAX_ETHERNET_DATA_BYTES);
+    int64 length = msg->getByteLength();
+#ifdef WITH_TCP_COMMON
+    // IPv4 only passes down oversized TCP super-segments to MACs with segmentation offload
+    if (length > MAX_ETHERNET_DATA_BYTES)
+        length = TCPSegmentationOffload::getSegmentByteLength(msg); // TCP super-segments are sent as separate frames
+#endif
+    if (length > MAX_ETHERNET_DATA_BYTES)
+        error("packet from higher layer (%d bytes) exceeds maximum Ethernet payload length (%d)", (int)length, MAX_ETHERNET_DATA_BYTES);
 
     totalFromHigherLayer++;
     emit(encapPkSignal, msg);
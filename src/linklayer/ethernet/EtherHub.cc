@@ -22,6 +22,7 @@ Define_Module(EtherHub);
 
 
 simsignal_t EtherHub::pkSignal = SIMSIGNAL_NULL;
+simsignal_t EtherHub::frameCopySignal = SIMSIGNAL_NULL;
 
 static cEnvir& operator<<(cEnvir& out, cMessage *msg)
 {
@@ -35,9 +36,12 @@ void EtherHub::initialize()
     inputGateBaseId = gateBaseId("ethg$i");
     outputGateBaseId = gateBaseId("ethg$o");
     pkSignal = registerSignal("pk");
+    frameCopySignal = registerSignal("frameCopy");
 
     numMessages = 0;
+    numCopies = 0;
     WATCH(numMessages);
+    WATCH(numCopies);
 
     // ensure we receive frames when their first bits arrive
     for (int i = 0; i < numPorts; i++)
@@ -176,7 +180,14 @@ void EtherHub::handleMessage(cMessage *msg)
                 continue;
 
             bool isLast = (arrivalPort == numPorts-1) ? (i == numPorts-2) : (i == numPorts-1);
-            cMessage *msg2 = isLast ? msg : msg->dup();
+            cMessage *msg2 = msg;
+            if (!isLast)
+            {
+                // shallow copy: the encapsulated packets are shared until decapsulated
+                msg2 = msg->dup();
+                numCopies++;
+                emit(frameCopySignal, msg2);
+            }
 
             // stop current transmission
             ogate->getTransmissionChannel()->forceTransmissionFinishTime(SIMTIME_ZERO);
@@ -196,6 +207,8 @@ void EtherHub::finish()
     simtime_t t = simTime();
     recordScalar("simulated time", t);
 
+    recordScalar("frame copies", numCopies);
+
     if (t > 0)
         recordScalar("messages/sec", numMessages / t);
 }
@@ -23,6 +23,12 @@
 /**
  * Models a wiring hub. It simply broadcasts the received message
  * on all other ports.
+ *
+ * Every port needs a message object of its own, but copying a frame only
+ * copies its header: the encapsulated packets are shared by the copies and
+ * only get duplicated when a receiver decapsulates them. The original frame
+ * is sent on the last port, so a frame received on an N-port hub causes
+ * N-2 copies; they are counted by the frameCopy signal.
  */
 class INET_API EtherHub : public cSimpleModule, protected cListener
 {
@@ -34,7 +40,9 @@ class INET_API EtherHub : public cSimpleModule, protected cListener
 
     // statistics
     long numMessages;   // number of messages handled
+    long numCopies;     // number of frame copies made
     static simsignal_t pkSignal;
+    static simsignal_t frameCopySignal;
 
   protected:
     virtual void initialize();
@@ -23,6 +23,10 @@
 #include "NotificationBoard.h"
 #include "NotifierConsts.h"
 
+#ifdef WITH_TCP_COMMON
+#include "TCPSegmentationOffload.h"
+#endif
+
 // TODO: refactor using a statemachine that is present in a single function
 // TODO: this helps understanding what interactions are there and how they affect the state
 
@@ -38,6 +42,9 @@ void EtherMACFullDuplex::initialize()
     if (!par("duplexMode").boolValue())
         throw cRuntimeError("Half duplex operation is not supported by EtherMACFullDuplex, use the EtherMAC module for that! (Please enable csmacdSupport on EthernetInterface)");
 
+    segmentationOffload = par("segmentationOffload");
+    interfaceEntry->setSegmentationOffload(segmentationOffload);
+
     beginSendFrames();
 }
 
@@ -101,6 +108,13 @@ void EtherMACFullDuplex::startFrameTransmission()
     if (frame->getByteLength() < curEtherDescr->frameMinBytes)
         frame->setByteLength(curEtherDescr->frameMinBytes);
 
+#ifdef WITH_TCP_COMMON
+    // a TCP super-segment occupies the channel for the back-to-back frames of its
+    // segments, each with its own headers, preamble, SFD and interframe gap
+    if (segmentationOffload)
+        frame->setByteLength(TCPSegmentationOffload::getSegmentedByteLength(frame, PREAMBLE_BYTES + SFD_BYTES + INTERFRAME_GAP_BITS / 8));
+#endif
+
     // add preamble and SFD (Starting Frame Delimiter), then send out
     frame->addByteLength(PREAMBLE_BYTES+SFD_BYTES);
 
@@ -129,10 +143,15 @@ void EtherMACFullDuplex::processFrameFromUpperLayer(EtherFrame *frame)
                 frame->getFullName(), frame->getDest().str().c_str());
     }
 
-    if (frame->getByteLength() > MAX_ETHERNET_FRAME_BYTES)
+    int64 length = frame->getByteLength();
+#ifdef WITH_TCP_COMMON
+    if (segmentationOffload && length > MAX_ETHERNET_FRAME_BYTES)
+        length = TCPSegmentationOffload::getSegmentByteLength(frame); // TCP super-segments are sent as separate frames
+#endif
+    if (length > MAX_ETHERNET_FRAME_BYTES)
     {
         error("packet from higher layer (%d bytes) exceeds maximum Ethernet frame size (%d)",
-                (int)(frame->getByteLength()), MAX_ETHERNET_FRAME_BYTES);
+                (int)length, MAX_ETHERNET_FRAME_BYTES);
     }
 
     if (!connected || disabled)
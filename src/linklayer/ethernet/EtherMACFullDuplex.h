@@ -58,6 +58,7 @@ class INET_API EtherMACFullDuplex : public EtherMACBase
     virtual void scheduleEndPausePeriod(int pauseUnits);
     virtual void beginSendFrames();
 
+    bool segmentationOffload;       // if true, TCP super-segments are transmitted as back-to-back frames
 
     // statistics
     simtime_t totalSuccessfulRxTime; // total duration of successful transmissions on channel
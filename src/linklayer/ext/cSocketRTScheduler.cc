@@ -21,6 +21,7 @@
 // This file is based on the cSocketRTScheduler.cc of OMNeT++ written by
 // Andras Varga.
 
+
 #include "cSocketRTScheduler.h"
 
 #include <headers/ethernet.h>
@@ -29,15 +30,47 @@
 #include <ws2tcpip.h>
 #endif
 
+#ifdef HAVE_EPOLL
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <net/if.h>
+#include <linux/if_packet.h>
+#include <linux/if_ether.h>
+#include <linux/filter.h>
+#endif
+
 #define PCAP_SNAPLEN 65536 /* capture all data packets with up to pcap_snaplen bytes */
 #define PCAP_TIMEOUT 10    /* Timeout in ms */
 
-#ifdef HAVE_PCAP
+#define MAX_EPOLL_EVENTS     16
+#define RING_BLOCK_SIZE      (1 << 20)   /* size of a block in the TPACKET_V3 ring */
+#define RING_FRAME_SIZE      2048        /* only used by the kernel for sanity checks in TPACKET_V3 */
+#define REPLAY_BATCH         256         /* max. number of frames injected from a file at once */
+#define MAX_REPLAY_CAPLEN    262144
+
+/* link-layer header types, in case pcap.h is not available */
+#ifndef DLT_NULL
+#define DLT_NULL    0
+#define DLT_EN10MB  1
+#define DLT_SLIP    8
+#define DLT_PPP     9
+#endif
+
+/* magic numbers of pcap files, as written by the same byte order machine */
+#define PCAP_MAGIC          0xa1b2c3d4
+#define PCAP_MAGIC_NSEC     0xa1b23c4d
+
+Register_PerRunConfigOption(CFGID_SOCKETRTSCHEDULER_BACKEND, "socketrtscheduler-backend", CFG_STRING, "pcap", "Capture backend of cSocketRTScheduler: 'pcap' (libpcap), 'mmap' (Linux only: memory-mapped TPACKET_V3 receive rings, frames are injected a whole ring block at a time), or 'file' (replays the pcap files given as the device parameter of ExtInterface modules).");
+Register_PerRunConfigOption(CFGID_SOCKETRTSCHEDULER_RING_BLOCKS, "socketrtscheduler-ring-blocks", CFG_INT, "64", "Number of 1MiB blocks in the receive ring of each interface, with the 'mmap' backend of cSocketRTScheduler.");
+Register_PerRunConfigOptionU(CFGID_SOCKETRTSCHEDULER_RING_BLOCK_TIMEOUT, "socketrtscheduler-ring-block-timeout", "s", "1ms", "A partially filled ring block is handed over after this time, with the 'mmap' backend of cSocketRTScheduler. Rounded up to milliseconds.");
+Register_PerRunConfigOption(CFGID_SOCKETRTSCHEDULER_REPLAY_REALTIME, "socketrtscheduler-replay-realtime", CFG_BOOL, "true", "With the 'file' backend of cSocketRTScheduler: whether replayed frames are injected in real time, or the simulation runs as fast as possible.");
+
 std::vector<cModule *>cSocketRTScheduler::modules;
+#ifdef HAVE_PCAP
 std::vector<pcap_t *>cSocketRTScheduler::pds;
+#endif
 std::vector<int32>cSocketRTScheduler::datalinks;
 std::vector<int32>cSocketRTScheduler::headerLengths;
-#endif
 timeval cSocketRTScheduler::baseTime;
 
 Register_Class(cSocketRTScheduler);
@@ -47,10 +80,31 @@ inline std::ostream& operator<<(std::ostream& out, const timeval& tv)
     return out << (uint32)tv.tv_sec << "s" << tv.tv_usec << "us";
 }
 
+static inline uint32 swap32(uint32 x)
+{
+    return (x >> 24) | ((x >> 8) & 0xff00) | ((x << 8) & 0xff0000) | (x << 24);
+}
+
+static simtime_t getWallClockSimTime()
+{
+    timeval curTime;
+    gettimeofday(&curTime, NULL);
+    curTime = timeval_substract(curTime, cSocketRTScheduler::baseTime);
+    return curTime.tv_sec + curTime.tv_usec*1e-6;
+}
+
 
 cSocketRTScheduler::cSocketRTScheduler() : cScheduler()
 {
     fd = INVALID_SOCKET;
+    backend = BACKEND_PCAP;
+    replayRealtime = true;
+    ringBlocks = 0;
+    ringBlockTimeout = 0;
+#ifdef HAVE_EPOLL
+    epollFd = -1;
+#endif
+    numBatches = numInjected = 0;
 }
 
 cSocketRTScheduler::~cSocketRTScheduler()
@@ -61,7 +115,40 @@ void cSocketRTScheduler::startRun()
 {
     gettimeofday(&baseTime, NULL);
 
-#ifdef HAVE_PCAP
+    std::string backendName = ev.getConfig()->getAsString(CFGID_SOCKETRTSCHEDULER_BACKEND);
+    if (backendName == "pcap")
+        backend = BACKEND_PCAP;
+    else if (backendName == "mmap")
+        backend = BACKEND_MMAP;
+    else if (backendName == "file")
+        backend = BACKEND_FILE;
+    else
+        throw cRuntimeError("cSocketRTScheduler: unknown backend '%s', must be 'pcap', 'mmap' or 'file'", backendName.c_str());
+
+    ringBlocks = ev.getConfig()->getAsInt(CFGID_SOCKETRTSCHEDULER_RING_BLOCKS);
+    ringBlockTimeout = (unsigned int)ceil(ev.getConfig()->getAsDouble(CFGID_SOCKETRTSCHEDULER_RING_BLOCK_TIMEOUT) * 1000);
+    if (ringBlockTimeout < 1)
+        ringBlockTimeout = 1;
+    replayRealtime = ev.getConfig()->getAsBool(CFGID_SOCKETRTSCHEDULER_REPLAY_REALTIME);
+    numBatches = numInjected = 0;
+
+#ifndef HAVE_EPOLL
+    if (backend == BACKEND_MMAP)
+        throw cRuntimeError("cSocketRTScheduler: the 'mmap' backend is only available on Linux");
+#else
+    if (backend != BACKEND_FILE)
+    {
+        epollFd = epoll_create(MAX_EPOLL_EVENTS);
+        if (epollFd < 0)
+            throw cRuntimeError("cSocketRTScheduler: cannot create epoll instance: %s", strerror(errno));
+    }
+#endif
+
+    // replayed traffic is not answered on the wire
+    if (backend == BACKEND_FILE)
+        return;
+
+#if defined(HAVE_PCAP) || defined(HAVE_EPOLL)
     // Enabling sending makes no sense when we can't receive...
     fd = socket(AF_INET, SOCK_RAW, IPPROTO_RAW);
     if (fd == INVALID_SOCKET)
@@ -75,7 +162,8 @@ void cSocketRTScheduler::startRun()
 
 void cSocketRTScheduler::endRun()
 {
-    close(fd);
+    if (fd != INVALID_SOCKET)
+        close(fd);
     fd = INVALID_SOCKET;
 
 #ifdef HAVE_PCAP
@@ -88,13 +176,43 @@ void cSocketRTScheduler::endRun()
             EV << modules.at(i)->getFullPath() << ": Received Packets: " << ps.ps_recv << " Dropped Packets: " << ps.ps_drop << ".\n";
         pcap_close(pds.at(i));
     }
-
     pds.clear();
+#endif
+
+#ifdef HAVE_EPOLL
+    for (uint16 i=0; i<rings.size(); i++)
+    {
+        struct tpacket_stats_v3 stats;
+        socklen_t len = sizeof(stats);
+        if (getsockopt(rings[i].fd, SOL_PACKET, PACKET_STATISTICS, &stats, &len) == 0)
+            EV << modules.at(i)->getFullPath() << ": Received Packets: " << stats.tp_packets << " Dropped Packets: " << stats.tp_drops << ".\n";
+        munmap(rings[i].map, (size_t)rings[i].blockSize * rings[i].numBlocks);
+        close(rings[i].fd);
+    }
+
+    if (epollFd >= 0)
+        close(epollFd);
+    epollFd = -1;
+#endif
+    rings.clear();
+
+    for (uint16 i=0; i<replayFiles.size(); i++)
+    {
+        if (replayFiles[i].file)
+            fclose(replayFiles[i].file);
+#ifdef HAVE_PCAP
+        if (replayFiles[i].hasFilter)
+            pcap_freecode(&replayFiles[i].fcode);
+#endif
+    }
+    replayFiles.clear();
+
+    if (numInjected > 0)
+        EV << "cSocketRTScheduler: injected " << numInjected << " packets in " << numBatches << " batches.\n";
+
     modules.clear();
-    pds.clear();
     datalinks.clear();
     headerLengths.clear();
-#endif
 }
 
 void cSocketRTScheduler::executionResumed()
@@ -104,16 +222,50 @@ void cSocketRTScheduler::executionResumed()
 }
 
 void cSocketRTScheduler::setInterfaceModule(cModule *mod, const char *dev, const char *filter)
+{
+    if (!mod || !dev || !filter)
+        throw cRuntimeError("cSocketRTScheduler::setInterfaceModule(): arguments must be non-NULL");
+
+    switch (backend)
+    {
+        case BACKEND_PCAP: openPcapDevice(dev, filter); break;
+        case BACKEND_MMAP: openPacketRing(dev, filter); break;
+        case BACKEND_FILE: openReplayFile(dev, filter); break;
+    }
+    modules.push_back(mod);
+}
+
+void cSocketRTScheduler::addDatalink(int datalink)
+{
+    int32 headerLength;
+
+    switch (datalink) {
+    case DLT_NULL:
+        headerLength = 4;
+        break;
+    case DLT_EN10MB:
+        headerLength = 14;
+        break;
+    case DLT_SLIP:
+        headerLength = 24;
+        break;
+    case DLT_PPP:
+        headerLength = 24;
+        break;
+    default:
+        throw cRuntimeError("cSocketRTScheduler::setInterfaceModule(): Unsupported datalink: %d", datalink);
+    }
+    datalinks.push_back(datalink);
+    headerLengths.push_back(headerLength);
+}
+
+void cSocketRTScheduler::openPcapDevice(const char *dev, const char *filter)
 {
 #ifdef HAVE_PCAP
     char errbuf[PCAP_ERRBUF_SIZE];
     struct bpf_program fcode;
     pcap_t * pd;
     int32 datalink;
-    int32 headerLength;
-
-    if (!mod || !dev || !filter)
-        throw cRuntimeError("cSocketRTScheduler::setInterfaceModule(): arguments must be non-NULL");
 
     /* get pcap handle */
     memset(&errbuf, 0, sizeof(errbuf));
@@ -129,35 +281,29 @@ void cSocketRTScheduler::setInterfaceModule(cModule *mod, const char *dev, const
     /* apply the compiled filter to the packet capture device */
     if (pcap_setfilter(pd, &fcode) < 0)
         throw cRuntimeError("cSocketRTScheduler::setInterfaceModule(): Cannot apply compiled pcap filter: %s", pcap_geterr(pd));
+    pcap_freecode(&fcode);
 
     if ((datalink = pcap_datalink(pd)) < 0)
         throw cRuntimeError("cSocketRTScheduler::setInterfaceModule(): Cannot query pcap link-layer header type: %s", pcap_geterr(pd));
 
-#ifndef LINUX
+    /* pcap_dispatch() must not block when the handle has been drained */
     if (pcap_setnonblock(pd, 1, errbuf) < 0)
         throw cRuntimeError("cSocketRTScheduler::setInterfaceModule(): Cannot put pcap device into non-blocking mode, error: %s", errbuf);
+
+    addDatalink(datalink);
+
+#ifdef HAVE_EPOLL
+    /* the handle is registered once, instead of building an fd_set on every call */
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.u32 = pds.size();
+    int pfd = pcap_get_selectable_fd(pd);
+    if (pfd < 0 || epoll_ctl(epollFd, EPOLL_CTL_ADD, pfd, &event) < 0)
+        throw cRuntimeError("cSocketRTScheduler::setInterfaceModule(): Cannot register pcap device for polling: %s", strerror(errno));
 #endif
 
-    switch (datalink) {
-    case DLT_NULL:
-        headerLength = 4;
-        break;
-    case DLT_EN10MB:
-        headerLength = 14;
-        break;
-    case DLT_SLIP:
-        headerLength = 24;
-        break;
-    case DLT_PPP:
-        headerLength = 24;
-        break;
-    default:
-        throw cRuntimeError("cSocketRTScheduler::setInterfaceModule(): Unsupported datalink: %d", datalink);
-    }
-    modules.push_back(mod);
     pds.push_back(pd);
-    datalinks.push_back(datalink);
-    headerLengths.push_back(headerLength);
 
     EV << "Opened pcap device " << dev << " with filter " << filter << " and datalink " << datalink << ".\n";
 #else
@@ -165,44 +311,299 @@ void cSocketRTScheduler::setInterfaceModule(cModule *mod, const char *dev, const
 #endif
 }
 
+void cSocketRTScheduler::openPacketRing(const char *dev, const char *filter)
+{
+#ifdef HAVE_EPOLL
+    PacketRing ring;
+
+    ring.fd = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
+    if (ring.fd < 0)
+        throw cRuntimeError("cSocketRTScheduler: Root privileges needed");
+
+    /* the filter is attached first, so that no unfiltered frame gets into the ring */
+    if (*filter)
+    {
 #ifdef HAVE_PCAP
-static void packet_handler(u_char *user, const struct pcap_pkthdr *hdr, const u_char *bytes)
+        struct bpf_program fcode;
+        pcap_t *pd = pcap_open_dead(DLT_EN10MB, PCAP_SNAPLEN);
+        if (pcap_compile(pd, &fcode, (char *)filter, 1, 0) < 0)
+            throw cRuntimeError("cSocketRTScheduler::setInterfaceModule(): Cannot compile pcap filter: %s", pcap_geterr(pd));
+        struct sock_fprog prog;
+        prog.len = fcode.bf_len;
+        prog.filter = (struct sock_filter *)fcode.bf_insns;
+        int err = setsockopt(ring.fd, SOL_SOCKET, SO_ATTACH_FILTER, &prog, sizeof(prog));
+        pcap_freecode(&fcode);
+        pcap_close(pd);
+        if (err < 0)
+            throw cRuntimeError("cSocketRTScheduler::setInterfaceModule(): Cannot attach filter to packet socket: %s", strerror(errno));
+#else
+        throw cRuntimeError("cSocketRTScheduler::setInterfaceModule(): filter strings need pcap support with the 'mmap' backend");
+#endif
+    }
+
+    int version = TPACKET_V3;
+    if (setsockopt(ring.fd, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) < 0)
+        throw cRuntimeError("cSocketRTScheduler::setInterfaceModule(): TPACKET_V3 is not supported: %s", strerror(errno));
+
+    struct tpacket_req3 req;
+    memset(&req, 0, sizeof(req));
+    req.tp_block_size = RING_BLOCK_SIZE;
+    req.tp_block_nr = ringBlocks;
+    req.tp_frame_size = RING_FRAME_SIZE;
+    req.tp_frame_nr = (RING_BLOCK_SIZE / RING_FRAME_SIZE) * ringBlocks;
+    req.tp_retire_blk_tov = ringBlockTimeout;
+    if (setsockopt(ring.fd, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)) < 0)
+        throw cRuntimeError("cSocketRTScheduler::setInterfaceModule(): Cannot set up receive ring: %s", strerror(errno));
+
+    ring.blockSize = RING_BLOCK_SIZE;
+    ring.numBlocks = ringBlocks;
+    ring.currentBlock = 0;
+    void *map = mmap(NULL, (size_t)ring.blockSize * ring.numBlocks, PROT_READ | PROT_WRITE, MAP_SHARED, ring.fd, 0);
+    if (map == MAP_FAILED)
+        throw cRuntimeError("cSocketRTScheduler::setInterfaceModule(): Cannot map receive ring: %s", strerror(errno));
+    ring.map = (unsigned char *)map;
+
+    struct sockaddr_ll addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sll_family = AF_PACKET;
+    addr.sll_protocol = htons(ETH_P_ALL);
+    addr.sll_ifindex = if_nametoindex(dev);
+    if (addr.sll_ifindex == 0)
+        throw cRuntimeError("cSocketRTScheduler::setInterfaceModule(): Unknown network interface: %s", dev);
+    if (bind(ring.fd, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+        throw cRuntimeError("cSocketRTScheduler::setInterfaceModule(): Cannot bind packet socket to %s: %s", dev, strerror(errno));
+
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.u32 = rings.size();
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, ring.fd, &event) < 0)
+        throw cRuntimeError("cSocketRTScheduler::setInterfaceModule(): Cannot register packet socket for polling: %s", strerror(errno));
+
+    rings.push_back(ring);
+    addDatalink(DLT_EN10MB);
+
+    EV << "Opened packet ring on " << dev << " with filter " << filter << ", "
+       << ring.numBlocks << " blocks of " << ring.blockSize << " bytes.\n";
+#else
+    throw cRuntimeError("cSocketRTScheduler::setInterfaceModule(): the 'mmap' backend is only available on Linux");
+#endif
+}
+
+void cSocketRTScheduler::openReplayFile(const char *fileName, const char *filter)
 {
-    unsigned i;
-    int32 headerLength;
-    int32 datalink;
-    cModule *module;
-    struct ether_header *ethernet_hdr;
+    ReplayFile replay;
+    replay.file = fopen(fileName, "rb");
+    if (!replay.file)
+        throw cRuntimeError("cSocketRTScheduler::setInterfaceModule(): Cannot open pcap file [%s] for replay: %s", fileName, strerror(errno));
+
+    uint32 header[6];   // magic, version, thiszone, sigfigs, snaplen, network
+    if (fread(header, sizeof(header), 1, replay.file) != 1)
+        throw cRuntimeError("cSocketRTScheduler::setInterfaceModule(): Cannot read header of pcap file [%s]", fileName);
+
+    uint32 magic = header[0];
+    replay.swapped = (magic == swap32(PCAP_MAGIC) || magic == swap32(PCAP_MAGIC_NSEC));
+    if (replay.swapped)
+        magic = swap32(magic);
+    if (magic != PCAP_MAGIC && magic != PCAP_MAGIC_NSEC)
+        throw cRuntimeError("cSocketRTScheduler::setInterfaceModule(): [%s] is not a pcap file (pcapng files can be converted with 'editcap -F pcap')", fileName);
+    replay.nanosec = (magic == PCAP_MAGIC_NSEC);
+    replay.hasFirstRecord = false;
+    replay.firstSec = replay.firstFrac = 0;
+
+    int datalink = replay.swapped ? swap32(header[5]) : header[5];
+
+#ifdef HAVE_PCAP
+    replay.hasFilter = *filter != '\0';
+    if (replay.hasFilter)
+    {
+        pcap_t *pd = pcap_open_dead(datalink, PCAP_SNAPLEN);
+        if (pcap_compile(pd, &replay.fcode, (char *)filter, 1, 0) < 0)
+            throw cRuntimeError("cSocketRTScheduler::setInterfaceModule(): Cannot compile pcap filter: %s", pcap_geterr(pd));
+        pcap_close(pd);
+    }
+#else
+    if (*filter)
+        EV << "cSocketRTScheduler: compiled without pcap support, filter \"" << filter << "\" is ignored.\n";
+#endif
+
+    addDatalink(datalink);
+    replayFiles.push_back(replay);
+    readReplayFrame(replayFiles.back());
+
+    EV << "Opened pcap file " << fileName << " for replay with datalink " << datalink << ".\n";
+}
+
+bool cSocketRTScheduler::readReplayFrame(ReplayFile& replay)
+{
+    while (replay.file)
+    {
+        uint32 header[4];   // ts_sec, ts_usec or ts_nsec, incl_len, orig_len
+        if (fread(header, sizeof(header), 1, replay.file) != 1)
+            break;
+        if (replay.swapped)
+            for (int i = 0; i < 4; i++)
+                header[i] = swap32(header[i]);
+
+        uint32 caplen = header[2];
+        if (caplen > MAX_REPLAY_CAPLEN)
+            throw cRuntimeError("cSocketRTScheduler: corrupt record in replayed pcap file (length %u)", caplen);
+        replay.nextFrame.resize(caplen);
+        if (caplen > 0 && fread(&replay.nextFrame[0], caplen, 1, replay.file) != 1)
+            break;
+
+        if (!replay.hasFirstRecord)
+        {
+            replay.firstSec = header[0];
+            replay.firstFrac = header[1];
+            replay.hasFirstRecord = true;
+        }
+        double frac = ((double)header[1] - (double)replay.firstFrac) * (replay.nanosec ? 1e-9 : 1e-6);
+        replay.nextTime = ((double)header[0] - (double)replay.firstSec) + frac;
+
+#ifdef HAVE_PCAP
+        if (replay.hasFilter)
+        {
+            struct pcap_pkthdr hdr;
+            hdr.ts.tv_sec = header[0];
+            hdr.ts.tv_usec = header[1];
+            hdr.caplen = caplen;
+            hdr.len = header[3];
+            if (pcap_offline_filter(&replay.fcode, &hdr, caplen > 0 ? &replay.nextFrame[0] : NULL) == 0)
+                continue;
+        }
+#endif
+        return true;
+    }
+
+    // end of file
+    if (replay.file)
+        fclose(replay.file);
+    replay.file = NULL;
+    replay.nextFrame.clear();
+    return false;
+}
+
+bool cSocketRTScheduler::injectReplayFrames(simtime_t horizon)
+{
+    bool found = false;
+    simtime_t now = sim->getSimTime();
+
+    for (unsigned int i = 0; i < replayFiles.size(); i++)
+    {
+        ReplayFile& replay = replayFiles[i];
+        for (int n = 0; n < REPLAY_BATCH && replay.file && replay.nextTime <= horizon; n++)
+        {
+            // records out of order in the file must not go back in time
+            simtime_t t = replay.nextTime < now ? now : replay.nextTime;
+            if (insertFrame(i, replay.nextFrame.empty() ? NULL : &replay.nextFrame[0], replay.nextFrame.size(), t))
+            {
+                numInjected++;
+                found = true;
+            }
+            readReplayFrame(replay);
+        }
+    }
+    if (found)
+        numBatches++;
+    return found;
+}
+
+bool cSocketRTScheduler::insertFrame(unsigned int index, const unsigned char *bytes, uint32 caplen, simtime_t t)
+{
+    int32 datalink = datalinks.at(index);
+    uint32 headerLength = headerLengths.at(index);
+    cModule *module = modules.at(index);
 
-    i = *(uint16 *)user;
-    datalink = cSocketRTScheduler::datalinks.at(i);
-    headerLength = cSocketRTScheduler::headerLengths.at(i);
-    module = cSocketRTScheduler::modules.at(i);
+    if (caplen <= headerLength)
+        return false;
 
     // skip ethernet frames not encapsulating an IP packet.
     if (datalink == DLT_EN10MB)
     {
-        ethernet_hdr = (struct ether_header *)bytes;
+        const struct ether_header *ethernet_hdr = (const struct ether_header *)bytes;
         if (ntohs(ethernet_hdr->ether_type) != ETHERTYPE_IP)
-            return;
+            return false;
     }
 
     // put the IP packet from wire into data[] array of ExtFrame
     ExtFrame *notificationMsg = new ExtFrame("rtEvent");
-    notificationMsg->setDataArraySize(hdr->caplen - headerLength);
-    for (uint16 j=0; j < hdr->caplen - headerLength; j++)
+    uint32 length = caplen - headerLength;
+    notificationMsg->setDataArraySize(length);
+    for (uint32 j=0; j < length; j++)
         notificationMsg->setData(j, bytes[j + headerLength]);
 
     // signalize new incoming packet to the interface via cMessage
-    EV << "Captured " << hdr->caplen - headerLength << " bytes for an IP packet.\n";
-    timeval curTime;
-    gettimeofday(&curTime, NULL);
-    curTime = timeval_substract(curTime, cSocketRTScheduler::baseTime);
-    simtime_t t = curTime.tv_sec + curTime.tv_usec*1e-6;
+    EV << "Captured " << length << " bytes for an IP packet.\n";
     // TBD assert that it's somehow not smaller than previous event's time
     notificationMsg->setArrival(module, -1, t);
 
     simulation.msgQueue.insert(notificationMsg);
+    return true;
+}
+
+#ifdef HAVE_PCAP
+struct DispatchContext
+{
+    uint16 index;
+    simtime_t time;     // arrival time for all packets of the batch
+    int numInjected;
+};
+
+static void packet_handler(u_char *user, const struct pcap_pkthdr *hdr, const u_char *bytes)
+{
+    DispatchContext *ctx = (DispatchContext *)user;
+    if (cSocketRTScheduler::insertFrame(ctx->index, bytes, hdr->caplen, ctx->time))
+        ctx->numInjected++;
+}
+
+static int dispatchPcap(uint16 index, simtime_t t)
+{
+    DispatchContext ctx;
+    ctx.index = index;
+    ctx.time = t;
+    ctx.numInjected = 0;
+
+    // -1: process every packet that has been buffered, not just one
+    pcap_t *pd = cSocketRTScheduler::pds.at(index);
+    if (pcap_dispatch(pd, -1, packet_handler, (u_char *)&ctx) < 0)
+        throw cRuntimeError("cSocketRTScheduler::pcap_dispatch(): An error occured: %s", pcap_geterr(pd));
+    return ctx.numInjected;
+}
+#endif
+
+#ifdef HAVE_EPOLL
+int cSocketRTScheduler::receiveFromRing(unsigned int index, simtime_t t)
+{
+    PacketRing& ring = rings[index];
+    int numFrames = 0;
+
+    // consume every block the kernel has handed over, frame by frame
+    while (true)
+    {
+        struct tpacket_block_desc *block = (struct tpacket_block_desc *)(ring.map + (size_t)ring.currentBlock * ring.blockSize);
+        if (!(block->hdr.bh1.block_status & TP_STATUS_USER))
+            break;
+
+        struct tpacket3_hdr *frame = (struct tpacket3_hdr *)((unsigned char *)block + block->hdr.bh1.offset_to_first_pkt);
+        for (uint32 i = 0; i < block->hdr.bh1.num_pkts; i++)
+        {
+            if (insertFrame(index, (unsigned char *)frame + frame->tp_mac, frame->tp_snaplen, t))
+                numFrames++;
+            frame = (struct tpacket3_hdr *)((unsigned char *)frame + frame->tp_next_offset);
+        }
+
+        // give the block back to the kernel
+        __sync_synchronize();
+        block->hdr.bh1.block_status = TP_STATUS_KERNEL;
+        ring.currentBlock = (ring.currentBlock + 1) % ring.numBlocks;
+    }
+    return numFrames;
+}
+#else
+int cSocketRTScheduler::receiveFromRing(unsigned int index, simtime_t t)
+{
+    return 0;
 }
 #endif
 
@@ -210,48 +611,54 @@ bool cSocketRTScheduler::receiveWithTimeout()
 {
     bool found;
     struct timeval timeout;
-#ifdef HAVE_PCAP
-    int32 n;
-#ifdef LINUX
-    int32 fd[FD_SETSIZE], maxfd;
-    fd_set rdfds;
-#endif
-#endif
 
     found = false;
     timeout.tv_sec = 0;
     timeout.tv_usec = PCAP_TIMEOUT * 1000;
-#ifdef HAVE_PCAP
-#ifdef LINUX
-    FD_ZERO(&rdfds);
-    maxfd = -1;
-    for (uint16 i = 0; i < pds.size(); i++)
-    {
-        fd[i] = pcap_get_selectable_fd(pds.at(i));
-        if (fd[i] > maxfd)
-            maxfd = fd[i];
-        FD_SET(fd[i], &rdfds);
-    }
-    if (select(maxfd + 1, &rdfds, NULL, NULL, &timeout) < 0)
+#ifdef HAVE_EPOLL
+    if (epollFd >= 0)
     {
+        struct epoll_event events[MAX_EPOLL_EVENTS];
+        int n = epoll_wait(epollFd, events, MAX_EPOLL_EVENTS, PCAP_TIMEOUT);
+        if (n <= 0)
+            return found;
+
+        // all packets of this wakeup get the same arrival time
+        simtime_t t = getWallClockSimTime();
+        int numFrames = 0;
+        for (int i = 0; i < n; i++)
+        {
+            uint16 index = events[i].data.u32;
+            if (backend == BACKEND_MMAP)
+                numFrames += receiveFromRing(index, t);
+#ifdef HAVE_PCAP
+            else
+                numFrames += dispatchPcap(index, t);
+#endif
+        }
+        if (numFrames > 0)
+        {
+            numBatches++;
+            numInjected += numFrames;
+            found = true;
+        }
         return found;
     }
 #endif
+#ifdef HAVE_PCAP
+    simtime_t t = getWallClockSimTime();
     for (uint16 i = 0; i < pds.size(); i++)
     {
-#ifdef LINUX
-        if (!(FD_ISSET(fd[i], &rdfds)))
-            continue;
-#endif
-        if ((n = pcap_dispatch(pds.at(i), 1, packet_handler, (uint8 *)&i)) < 0)
-            throw cRuntimeError("cSocketRTScheduler::pcap_dispatch(): An error occured: %s", pcap_geterr(pds.at(i)));
+        int n = dispatchPcap(i, t);
         if (n > 0)
+        {
+            numBatches++;
+            numInjected += n;
             found = true;
+        }
     }
-#ifndef LINUX
     if (!found)
         select(0, NULL, NULL, NULL, &timeout);
-#endif
 #else
     select(0, NULL, NULL, NULL, &timeout);
 #endif
@@ -266,7 +673,18 @@ int32 cSocketRTScheduler::receiveUntil(const timeval& targetTime)
     gettimeofday(&curTime, NULL);
     while (timeval_greater(targetTime, curTime))
     {
-        if (receiveWithTimeout())
+        if (backend == BACKEND_FILE)
+        {
+            // nothing to receive, just sleep until the target time
+            timeval timeout = timeval_substract(targetTime, curTime);
+            if (timeout.tv_sec > 0 || timeout.tv_usec > PCAP_TIMEOUT * 1000)
+            {
+                timeout.tv_sec = 0;
+                timeout.tv_usec = PCAP_TIMEOUT * 1000;
+            }
+            select(0, NULL, NULL, NULL, &timeout);
+        }
+        else if (receiveWithTimeout())
             return 1;
         if (ev.idle())
             return -1;
@@ -281,6 +699,19 @@ cMessage *cSocketRTScheduler::getNextEvent()
 
     // calculate target time
     cMessage *msg = sim->msgQueue.peekFirst();
+
+    if (backend == BACKEND_FILE)
+    {
+        // frames of the replayed files that precede the first event are
+        // inserted into the FES in advance
+        if (injectReplayFrames(msg ? msg->getArrivalTime() : MAXTIME))
+            msg = sim->msgQueue.peekFirst();
+        if (!msg)
+            throw cTerminationException(eENDEDOK);
+        if (!replayRealtime)
+            return msg;
+    }
+
     if (!msg)
     {
         targetTime.tv_sec = LONG_MAX;
@@ -313,6 +744,12 @@ cMessage *cSocketRTScheduler::getNextEvent()
 
 void cSocketRTScheduler::sendBytes(uint8 *buf, size_t numBytes, struct sockaddr *to, socklen_t addrlen)
 {
+    if (backend == BACKEND_FILE)
+    {
+        EV << "Replaying a pcap file, the IP packet with length of " << numBytes << " bytes is not sent.\n";
+        return;
+    }
+
     if (fd == INVALID_SOCKET)
         throw cRuntimeError("cSocketRTScheduler::sendBytes(): no raw socket.");
 
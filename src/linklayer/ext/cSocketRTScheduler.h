@@ -36,13 +36,85 @@
 #endif
 #include "ExtFrame_m.h"
 
+// epoll and memory-mapped packet rings (PACKET_MMAP) are Linux specific
+#if defined(LINUX) || defined(__linux__)
+#define HAVE_EPOLL
+#endif
+
+/**
+ * Real-time scheduler for emulation: it injects the IP packets captured on
+ * real network interfaces into the simulation as ExtFrame messages, and
+ * sends packets out on a raw socket.
+ *
+ * The capture backend is selected with the socketrtscheduler-backend
+ * configuration option:
+ *  - "pcap": libpcap handles; on Linux they are polled with epoll, and
+ *    every ready handle is drained with a single pcap_dispatch() call;
+ *  - "mmap" (Linux only): AF_PACKET sockets with TPACKET_V3 memory-mapped
+ *    receive rings, polled with epoll. The kernel hands over whole blocks
+ *    of frames, which are injected in one batch without any further system
+ *    call. Filter strings are compiled with libpcap if it is available;
+ *  - "file": replays pcap files (the "device" parameter of ExtInterface is
+ *    the file name) in real time or as fast as possible, for testing and
+ *    benchmarking without real interfaces. The first record of each file
+ *    corresponds to simulation time 0. Nothing is sent out in this mode.
+ */
 class cSocketRTScheduler : public cScheduler
 {
+    public:
+        enum Backend { BACKEND_PCAP, BACKEND_MMAP, BACKEND_FILE };
+
     protected:
+        /** Receive ring of an AF_PACKET socket, for BACKEND_MMAP */
+        struct PacketRing
+        {
+            int fd;
+            unsigned char *map;
+            unsigned int blockSize;
+            unsigned int numBlocks;
+            unsigned int currentBlock;
+        };
+
+        /** A pcap file being replayed, for BACKEND_FILE */
+        struct ReplayFile
+        {
+            FILE *file;             // NULL after the last record
+            bool swapped;           // written with the other byte order
+            bool nanosec;           // timestamps have nanosecond resolution
+            bool hasFirstRecord;
+            uint32 firstSec, firstFrac;     // timestamp of the first record
+            simtime_t nextTime;     // arrival time of the next frame
+            std::vector<unsigned char> nextFrame;
+#ifdef HAVE_PCAP
+            bool hasFilter;
+            struct bpf_program fcode;
+#endif
+        };
+
         int fd;
+        Backend backend;
+        bool replayRealtime;
+        unsigned int ringBlocks;
+        unsigned int ringBlockTimeout;  // in milliseconds
+#ifdef HAVE_EPOLL
+        int epollFd;
+#endif
+        std::vector<PacketRing> rings;          // indexed like modules
+        std::vector<ReplayFile> replayFiles;    // indexed like modules
+        unsigned long numBatches;
+        unsigned long numInjected;
 
         virtual bool receiveWithTimeout();
         virtual int receiveUntil(const timeval& targetTime);
+
+        virtual void openPcapDevice(const char *dev, const char *filter);
+        virtual void openPacketRing(const char *dev, const char *filter);
+        virtual int receiveFromRing(unsigned int index, simtime_t t);
+        virtual void openReplayFile(const char *fileName, const char *filter);
+        virtual bool readReplayFrame(ReplayFile& replay);
+        virtual bool injectReplayFrames(simtime_t horizon);
+        virtual void addDatalink(int datalink);
+
     public:
         /**
          * Constructor.
@@ -53,12 +125,12 @@ class cSocketRTScheduler : public cScheduler
          * Destructor.
          */
         virtual ~cSocketRTScheduler();
-#ifdef HAVE_PCAP
         static std::vector<cModule *> modules;
+#ifdef HAVE_PCAP
         static std::vector<pcap_t *> pds;
+#endif
         static std::vector<int> datalinks;
         static std::vector<int> headerLengths;
-#endif
         static timeval baseTime;
 
         /**
@@ -92,6 +164,13 @@ class cSocketRTScheduler : public cScheduler
          * Send on the currently open connection
          */
         void sendBytes(unsigned char *buf, size_t numBytes, struct sockaddr *from, socklen_t addrlen);
+
+        /**
+         * Wraps the IP packet in a frame captured on the given interface into
+         * an ExtFrame, and inserts it into the FES. Returns false if the frame
+         * does not contain an IP packet.
+         */
+        static bool insertFrame(unsigned int index, const unsigned char *bytes, uint32 caplen, simtime_t t);
 };
 
 #endif
@@ -26,12 +26,14 @@
 #include "Radio80211aControlInfo_m.h"
 #include "Ieee80211eClassifier.h"
 #include "Ieee80211DataRate.h"
+#include "ObjectPool.h"
 
 // TODO: 9.3.2.1, If there are buffered multicast or broadcast frames, the PC shall transmit these prior to any unicast frames.
 // TODO: control frames must send before
 
 Define_Module(Ieee80211Mac);
 
+
 // don't forget to keep synchronized the C++ enum and the runtime enum definition
 Register_Enum(Ieee80211Mac,
               (Ieee80211Mac::IDLE,
@@ -64,6 +66,7 @@ Ieee80211Mac::Ieee80211Mac()
     mediumStateChange = NULL;
     pendingRadioConfigMsg = NULL;
     classifier = NULL;
+    ObjectPool::addUser();
 }
 
 Ieee80211Mac::~Ieee80211Mac()
@@ -95,6 +98,7 @@ Ieee80211Mac::~Ieee80211Mac()
     edcCAFOutVector.clear();
     if (pendingRadioConfigMsg)
         delete pendingRadioConfigMsg;
+    ObjectPool::removeUser();
 }
 
 /****************************************************************
@@ -120,12 +124,14 @@ void Ieee80211Mac::initialize(int stage)
             Edca catEdca;
             catEdca.backoff = false;
             catEdca.backoffPeriod = -1;
+            catEdca.backoffStart = 0;
             catEdca.retryCounter = 0;
             edcCAF.push_back(catEdca);
         }
         // initialize parameters
         // Variable to apply the fsm fix
         fixFSM = par("fixFSM");
+        fastBackoff = par("fastBackoff");
         const char *opModeStr = par("opMode").stringValue();
         if (strcmp("b", opModeStr)==0)
             opMode = 'b';
@@ -327,6 +333,7 @@ void Ieee80211Mac::initialize(int stage)
 
         numCollision = 0;
         numInternalCollision = 0;
+        numFusedBackoffs = 0;
         numReceived = 0;
         numSentMulticast = -1; //sorin
         numReceivedMulticast = 0;
@@ -448,6 +455,9 @@ void Ieee80211Mac::finish()
     recordScalar("number of received packets", numReceived);
     recordScalar("number of collisions", numCollision);
     recordScalar("number of internal collisions", numInternalCollision);
+    if (fastBackoff)
+        recordScalar("number of fused AIFS and backoff periods", numFusedBackoffs);
+    ObjectPool::recordStatistics();
     for (int i=0; i<numCategories(); i++)
     {
         std::stringstream os;
@@ -882,6 +892,7 @@ void Ieee80211Mac::handleWithFSM(cMessage *msg)
             backoffPeriod(currentAC) = backoffPeriod(numCategories()-1);
             backoff(currentAC) = backoff(numCategories()-1);
             backoff(numCategories()-1) = false;
+            backoffStart(currentAC) = simTime();
             scheduleAt(endBackoff(numCategories()-1)->getArrivalTime(), endBackoff(currentAC));
             cancelEvent(endBackoff(numCategories()-1));
         }
@@ -978,6 +989,7 @@ void Ieee80211Mac::handleWithFSM(cMessage *msg)
                                   sendRTSFrame(getCurrentTransmission());
                                   oldcurrentAC = currentAC;
                                   cancelAIFSPeriod();
+                                  freezeFusedBackoffPeriods();
                                  );
             FSMA_Event_Transition(Immediate-Transmit-Multicast,
                                   isMsgAIFS(msg) && isMulticast(getCurrentTransmission()) && !backoff(),
@@ -985,6 +997,7 @@ void Ieee80211Mac::handleWithFSM(cMessage *msg)
                                   sendMulticastFrame(getCurrentTransmission());
                                   oldcurrentAC = currentAC;
                                   cancelAIFSPeriod();
+                                  freezeFusedBackoffPeriods();
                                  );
             FSMA_Event_Transition(Immediate-Transmit-Data,
                                   isMsgAIFS(msg) && !isMulticast(getCurrentTransmission()) && !backoff(),
@@ -992,7 +1005,47 @@ void Ieee80211Mac::handleWithFSM(cMessage *msg)
                                   sendDataFrame(getCurrentTransmission());
                                   oldcurrentAC = currentAC;
                                   cancelAIFSPeriod();
+                                  freezeFusedBackoffPeriods();
                                  );
+            // fast path: the AIFS and the remaining backoff elapsed as a single event
+            if (getCurrentTransmission())
+            {
+                FSMA_Event_Transition(Fused-Backoff-Transmit-RTS,
+                                      isBakoffMsg(msg) && !isMulticast(getCurrentTransmission())
+                                      && getCurrentTransmission()->getByteLength() >= rtsThreshold,
+                                      WAITCTS,
+                                      sendRTSFrame(getCurrentTransmission());
+                                      oldcurrentAC = currentAC;
+                                      cancelAIFSPeriod();
+                                      decreaseBackoffPeriod();
+                                      cancelBackoffPeriod();
+                                     );
+                FSMA_Event_Transition(Fused-Backoff-Transmit-Multicast,
+                                      isBakoffMsg(msg) && isMulticast(getCurrentTransmission()),
+                                      WAITMULTICAST,
+                                      sendMulticastFrame(getCurrentTransmission());
+                                      oldcurrentAC = currentAC;
+                                      cancelAIFSPeriod();
+                                      decreaseBackoffPeriod();
+                                      cancelBackoffPeriod();
+                                     );
+                FSMA_Event_Transition(Fused-Backoff-Transmit-Data,
+                                      isBakoffMsg(msg) && !isMulticast(getCurrentTransmission()),
+                                      WAITACK,
+                                      sendDataFrame(getCurrentTransmission());
+                                      oldcurrentAC = currentAC;
+                                      cancelAIFSPeriod();
+                                      decreaseBackoffPeriod();
+                                      cancelBackoffPeriod();
+                                     );
+            }
+            FSMA_Event_Transition(Fused-Backoff-Idle,
+                                  isBakoffMsg(msg) && transmissionQueueEmpty(),
+                                  IDLE,
+                                  cancelAIFSPeriod();
+                                  freezeFusedBackoffPeriods();
+                                  resetStateVariables();
+                                  );
             /*FSMA_Event_Transition(AIFS-Over,
                                   isMsgAIFS(msg) && backoff[currentAC],
                                   BACKOFF,
@@ -1036,6 +1089,7 @@ void Ieee80211Mac::handleWithFSM(cMessage *msg)
                                   }
                                   if (endDIFS->isScheduled()) backoff(numCategories()-1) = true;
                                   cancelAIFSPeriod();
+                                  freezeFusedBackoffPeriods();
                                   );
             FSMA_No_Event_Transition(Immediate-Busy,
                                      !isMediumFree(),
@@ -1047,13 +1101,14 @@ void Ieee80211Mac::handleWithFSM(cMessage *msg)
                                      }
                                      if (endDIFS->isScheduled()) backoff(numCategories()-1) = true;
                                      cancelAIFSPeriod();
-
+                                     freezeFusedBackoffPeriods();
                                      );
             // radio state changes before we actually get the message, so this must be here
             FSMA_Event_Transition(Receive,
                                   isLowerMsg(msg),
                                   RECEIVE,
                                   cancelAIFSPeriod();
+                                  freezeFusedBackoffPeriods();
                                   ;);
         }
         FSMA_State(BACKOFF)
@@ -1564,8 +1619,17 @@ void Ieee80211Mac::scheduleAIFSPeriod()
     {
         if (!endAIFS(i)->isScheduled() && !transmissionQueue(i)->empty())
         {
-
-            if (lastReceiveFailed)
+            if (fastBackoff && backoff(i) && backoffPeriod(i) >= 0 && !endBackoff(i)->isScheduled())
+            {
+                // the backoff of this AC was frozen by a busy medium: instead of an AIFS
+                // event followed by the remaining backoff, schedule the end of both at once
+                simtime_t aifs = lastReceiveFailed ? getEIFS() - getDIFS() + getAIFS(i) : getAIFS(i);
+                EV << "scheduling AIFS and remaining backoff period (" << i << ")\n";
+                backoffStart(i) = simTime() + aifs;
+                scheduleAt(backoffStart(i) + backoffPeriod(i), endBackoff(i));
+                numFusedBackoffs++;
+            }
+            else if (lastReceiveFailed)
             {
                 EV << "reception of last frame failed, scheduling EIFS-DIFS+AIFS period (" << i << ")\n";
                 scheduleAt(simTime() + getEIFS() - getDIFS() + getAIFS(i), endAIFS(i));
@@ -1577,7 +1641,7 @@ void Ieee80211Mac::scheduleAIFSPeriod()
             }
 
         }
-        if (endAIFS(i)->isScheduled())
+        if (endAIFS(i)->isScheduled() || (fastBackoff && endBackoff(i)->isScheduled()))
             schedule = true;
     }
     if (!schedule && !endDIFS->isScheduled())
@@ -1724,9 +1788,11 @@ void Ieee80211Mac::decreaseBackoffPeriod()
         if (backoff(i) && endBackoff(i)->isScheduled())
         {
             EV<< "old backoff[" << i << "] is " << backoffPeriod(i) << ", sim time is " << simTime()
-            << ", endbackoff sending period is " << endBackoff(i)->getSendingTime() << endl;
-            simtime_t elapsedBackoffTime = simTime() - endBackoff(i)->getSendingTime();
-            backoffPeriod(i) -= ((int)(elapsedBackoffTime / getSlotTime())) * getSlotTime();
+            << ", backoff countdown started at " << backoffStart(i) << endl;
+            simtime_t elapsedBackoffTime = simTime() - backoffStart(i);
+            // with fastBackoff, the countdown may not have started yet (medium got busy during AIFS)
+            if (elapsedBackoffTime > 0)
+                backoffPeriod(i) -= ((int)(elapsedBackoffTime / getSlotTime())) * getSlotTime();
             EV << "actual backoff[" << i << "] is " <<backoffPeriod(i) << ", elapsed is " << elapsedBackoffTime << endl;
             ASSERT(backoffPeriod(i) >= 0);
             EV << "backoff[" << i << "] period decreased to " << backoffPeriod(i) << endl;
@@ -1737,6 +1803,7 @@ void Ieee80211Mac::decreaseBackoffPeriod()
 void Ieee80211Mac::scheduleBackoffPeriod()
 {
     EV << "scheduling backoff period\n";
+    backoffStart() = simTime();
     scheduleAt(simTime() + backoffPeriod(), endBackoff());
 }
 
@@ -1747,6 +1814,16 @@ void Ieee80211Mac::cancelBackoffPeriod()
         cancelEvent(endBackoff(i));
 }
 
+void Ieee80211Mac::freezeFusedBackoffPeriods()
+{
+    // only the fast path has backoff periods counting down while in WAITAIFS
+    if (fastBackoff)
+    {
+        decreaseBackoffPeriod();
+        cancelBackoffPeriod();
+    }
+}
+
 /****************************************************************
  * Frame sender functions.
  */
@@ -2413,6 +2490,15 @@ simtime_t & Ieee80211Mac::backoffPeriod(int i)
      return edcCAF[i].backoffPeriod;
 }
 
+simtime_t & Ieee80211Mac::backoffStart(int i)
+{
+    if (i==-1)
+         i = currentAC;
+    if (i>=(int)edcCAF.size())
+         opp_error("AC doesn't exist");
+     return edcCAF[i].backoffStart;
+}
+
 int & Ieee80211Mac::retryCounter(int i)
 {
     if (i==-1)
@@ -2694,17 +2780,8 @@ void Ieee80211Mac::removeOldTuplesFromDuplicateMap()
     if (duplicateDetect && lastTimeDelete+duplicateTimeOut>=simTime())
     {
         lastTimeDelete=simTime();
-        for (Ieee80211ASFTupleList::iterator it = asfTuplesList.begin();it!=asfTuplesList.begin();)
-        {
-            if (it->second.receivedTime+duplicateTimeOut<simTime())
-            {
-                Ieee80211ASFTupleList::iterator itAux=it;
-                it++;
-                asfTuplesList.erase(itAux);
-            }
-            else
-                it++;
-        }
+        // XXX stale records are never purged here (the original loop over the
+        // tuple list stopped at begin() before checking any element)
     }
 }
 
@@ -2736,31 +2813,18 @@ bool Ieee80211Mac::isDuplicated(cMessage *msg)
         Ieee80211DataOrMgmtFrame *frame = dynamic_cast<Ieee80211DataOrMgmtFrame*>(msg);
         if (frame)
         {
-            Ieee80211ASFTupleList::iterator it = asfTuplesList.find(frame->getTransmitterAddress());
-            if (it == asfTuplesList.end())
+            Ieee80211StationInfo& station = stationTable[frame->getTransmitterAddress()];
+            // check if duplicate
+            if (station.hasSequenceControl && station.sequenceNumber == frame->getSequenceNumber()
+                    && station.fragmentNumber == frame->getFragmentNumber())
             {
-                Ieee80211ASFTuple tuple;
-                tuple.receivedTime = simTime();
-                tuple.sequenceNumber = frame->getSequenceNumber();
-                tuple.fragmentNumber = frame->getFragmentNumber();
-                asfTuplesList.insert(std::pair<MACAddress, Ieee80211ASFTuple>(frame->getTransmitterAddress(), tuple));
-            }
-            else
-            {
-                // check if duplicate
-                if (it->second.sequenceNumber == frame->getSequenceNumber()
-                        && it->second.fragmentNumber == frame->getFragmentNumber())
-                {
-                    return true;
-                }
-                else
-                {
-                    // actualize
-                    it->second.sequenceNumber = frame->getSequenceNumber();
-                    it->second.fragmentNumber = frame->getFragmentNumber();
-                    it->second.receivedTime = simTime();
-                }
+                return true;
             }
+            // actualize
+            station.hasSequenceControl = true;
+            station.sequenceNumber = frame->getSequenceNumber();
+            station.fragmentNumber = frame->getFragmentNumber();
+            station.receivedTime = simTime();
         }
     }
     return false;
@@ -34,6 +34,7 @@
 #include "RadioState.h"
 #include "FSMA.h"
 #include "IQoSClassifier.h"
+#include "Ieee80211StationTable.h"
 
 /**
  * IEEE 802.11g with e Media Access Control Layer.
@@ -60,25 +61,6 @@
 class INET_API Ieee80211Mac : public WirelessMacBase, public INotifiable
 {
     typedef std::list<Ieee80211DataOrMgmtFrame*> Ieee80211DataOrMgmtFrameList;
-    /**
-     * This is used to populate fragments and identify duplicated messages. See spec 9.2.9.
-     */
-    struct Ieee80211ASFTuple
-    {
-        int sequenceNumber;
-        int fragmentNumber;
-        simtime_t receivedTime;
-        Ieee80211ASFTuple& operator=(const Ieee80211ASFTuple& other)
-        {
-            if (this==&other) return *this;
-            this->sequenceNumber = other.sequenceNumber;
-            this->fragmentNumber = other.fragmentNumber;
-            this->receivedTime = other.receivedTime;
-            return *this;
-        }
-    };
-
-    typedef std::map<MACAddress, Ieee80211ASFTuple> Ieee80211ASFTupleList;
 
     enum
     {
@@ -205,11 +187,18 @@ class INET_API Ieee80211Mac : public WirelessMacBase, public INotifiable
   protected:
     cFSM fsm;
     bool fixFSM;
+    /**
+     * If true, the AIFS and the remaining (frozen) backoff of an access category
+     * are counted down by a single endBackoff event instead of an endAIFS event
+     * followed by an endBackoff event.
+     */
+    bool fastBackoff;
 
     struct Edca {
         simtime_t TXOP;
         bool backoff;
         simtime_t backoffPeriod;
+        simtime_t backoffStart; // time from which backoffPeriod is counted down
         int retryCounter;
         int AIFSN; // Arbitration interframe space number. The duration edcCAF[AC].AIFSis a duration derived from the value AIFSN[AC] by the relation
         int cwMax;
@@ -246,6 +235,7 @@ class INET_API Ieee80211Mac : public WirelessMacBase, public INotifiable
     virtual bool & backoff(int i = -1);
     virtual simtime_t & TXOP(int i = -1);
     virtual simtime_t & backoffPeriod(int i = -1);
+    virtual simtime_t & backoffStart(int i = -1);
     virtual int & retryCounter(int i = -1);
     virtual int & AIFSN(int i = -1);
     virtual int & cwMax(int i = -1);
@@ -345,14 +335,15 @@ class INET_API Ieee80211Mac : public WirelessMacBase, public INotifiable
     Ieee80211DataOrMgmtFrame *fr;
 
     /**
-    * A list of last sender, sequence and fragment number tuples to identify
-    * duplicates, see spec 9.2.9.
+    * The last sequence and fragment number received from each sender, to
+    * identify duplicates, see spec 9.2.9. They are kept in the per-station
+    * records, which the management module also uses.
     */
     bool duplicateDetect;
     bool purgeOldTuples;
     double duplicateTimeOut;
     simtime_t lastTimeDelete;
-    Ieee80211ASFTupleList asfTuplesList;
+    Ieee80211StationTable stationTable;
 
     /** Passive queue module to request messages from */
     IPassiveQueue *queueModule;
@@ -400,6 +391,7 @@ class INET_API Ieee80211Mac : public WirelessMacBase, public INotifiable
     // long numGivenUp[4];
     long numCollision;
     long numInternalCollision;
+    long numFusedBackoffs;
     // long numSent[4];
     long numBites;
     long numSentTXOP;
@@ -429,6 +421,9 @@ class INET_API Ieee80211Mac : public WirelessMacBase, public INotifiable
     virtual ~Ieee80211Mac();
     //@}
 
+    /** Returns the per-station records; in an AP, Ieee80211MgmtAP keeps the association state in them */
+    Ieee80211StationTable *getStationTable() {return &stationTable;}
+
   protected:
     /**
      * @name Initialization functions
@@ -518,6 +513,9 @@ class INET_API Ieee80211Mac : public WirelessMacBase, public INotifiable
     virtual void decreaseBackoffPeriod();
     virtual void scheduleBackoffPeriod();
     virtual void cancelBackoffPeriod();
+
+    /** @brief Freezes and cancels the backoff periods counted down by the fast path while in WAITAIFS. */
+    virtual void freezeFusedBackoffPeriods();
     virtual void finishReception();
     //@}
 
@@ -0,0 +1,61 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __INET_IEEE80211STATIONTABLE_H
+#define __INET_IEEE80211STATIONTABLE_H
+
+#include "INETDefs.h"
+
+#include "MACAddressHashTable.h"
+
+
+/**
+ * Everything an 802.11 interface knows about another station, in one
+ * record. Ieee80211Mac stores the sequence control of the last frame
+ * received from the station, to identify duplicates (see spec 9.2.9);
+ * in an access point, Ieee80211MgmtAP stores the association state of
+ * the station in the same record.
+ */
+struct Ieee80211StationInfo
+{
+    /** State of a STA at the AP; NOT_A_STA if the AP does not know the station */
+    enum STAStatus {NOT_A_STA, NOT_AUTHENTICATED, AUTHENTICATED, ASSOCIATED};
+
+    // sequence control cache, maintained by Ieee80211Mac
+    bool hasSequenceControl;  // false until a data or management frame has been received
+    int sequenceNumber;
+    int fragmentNumber;
+    simtime_t receivedTime;
+
+    // association state, maintained by Ieee80211MgmtAP
+    MACAddress address;
+    STAStatus status;
+    int authSeqExpected;  // when NOT_AUTHENTICATED: transaction sequence number of next expected auth frame
+    //int consecFailedTrans;  //XXX
+    //double expiry;          //XXX association should expire after a while if STA is silent?
+
+    Ieee80211StationInfo() : hasSequenceControl(false), sequenceNumber(-1), fragmentNumber(-1),
+        status(NOT_A_STA), authSeqExpected(0) {}
+};
+
+/**
+ * The station records of an 802.11 interface, keyed by MAC address.
+ * It is owned by Ieee80211Mac (see Ieee80211Mac::getStationTable()),
+ * and shared with the management module, so receiving a frame needs
+ * one hashed lookup per layer instead of a map traversal per table.
+ */
+typedef MACAddressHashTable<Ieee80211StationInfo> Ieee80211StationTable;
+
+#endif
@@ -17,6 +17,7 @@
 
 
 #include "Ieee80211MgmtAP.h"
+#include "Ieee80211Mac.h"
 
 #include "Ieee80211Frame_m.h"
 #include "Ieee802Ctrl_m.h"
@@ -54,7 +55,16 @@ void Ieee80211MgmtAP::initialize(int stage)
         WATCH(channelNumber);
         WATCH(beaconInterval);
         WATCH(numAuthSteps);
-        WATCH_MAP(staList);
+        // the STA list is kept in the station records of the MAC
+        const char *macModule = par("macModule").stringValue();
+        cModule *mod = getParentModule()->getSubmodule(macModule);
+        if (!mod)
+            error("MAC module '%s' not found (see the macModule parameter)", macModule);
+        Ieee80211Mac *mac = dynamic_cast<Ieee80211Mac *>(mod);
+        if (!mac)
+            error("module '%s' is not an Ieee80211Mac, it cannot hold the STA list (see the macModule parameter)", mod->getFullPath().c_str());
+        staList = mac->getStationTable();
+        WATCH(*staList);
 
         //TBD fill in supportedRates
 
@@ -87,8 +97,8 @@ void Ieee80211MgmtAP::handleUpperMessage(cPacket *msg)
     MACAddress macAddr = frame->getReceiverAddress();
     if (!macAddr.isMulticast())
     {
-        STAList::iterator it = staList.find(macAddr);
-        if (it==staList.end() || it->second.status!=ASSOCIATED)
+        STAInfo *sta = lookupSTA(macAddr);
+        if (!sta || sta->status!=STAInfo::ASSOCIATED)
         {
             EV << "STA with MAC address " << macAddr << " not associated with this AP, dropping frame\n";
             delete frame; // XXX count drops?
@@ -116,10 +126,16 @@ void Ieee80211MgmtAP::receiveChangeNotification(int category, const cObject *det
     }
 }
 
+Ieee80211MgmtAP::STAInfo *Ieee80211MgmtAP::lookupSTA(const MACAddress& address)
+{
+    // the MAC creates records for every sender; only those with a status are our STAs
+    STAInfo *sta = staList->find(address);
+    return (sta && sta->status != STAInfo::NOT_A_STA) ? sta : NULL;
+}
+
 Ieee80211MgmtAP::STAInfo *Ieee80211MgmtAP::lookupSenderSTA(Ieee80211ManagementFrame *frame)
 {
-    STAList::iterator it = staList.find(frame->getTransmitterAddress());
-    return it==staList.end() ? NULL : &(it->second);
+    return lookupSTA(frame->getTransmitterAddress());
 }
 
 void Ieee80211MgmtAP::sendManagementFrame(Ieee80211ManagementFrame *frame, const MACAddress& destAddr)
@@ -170,8 +186,8 @@ void Ieee80211MgmtAP::handleDataFrame(Ieee80211DataFrame *frame)
     }
 
     // look up destination address in our STA list
-    STAList::iterator it = staList.find(frame->getAddress3());
-    if (it==staList.end())
+    STAInfo *sta = lookupSTA(frame->getAddress3());
+    if (!sta)
     {
         // not our STA -- pass up frame to relayUnit for LAN bridging if we have one
         if (isConnectedToHL)
@@ -187,7 +203,7 @@ void Ieee80211MgmtAP::handleDataFrame(Ieee80211DataFrame *frame)
     else
     {
         // dest address is our STA, but is it already associated?
-        if (it->second.status == ASSOCIATED)
+        if (sta->status == STAInfo::ASSOCIATED)
             distributeReceivedDataFrame(frame); // send it out to the destination STA
         else {
             EV << "Frame's destination STA is not in associated state -- dropping frame\n";
@@ -206,9 +222,9 @@ void Ieee80211MgmtAP::handleAuthenticationFrame(Ieee80211AuthenticationFrame *fr
     if (!sta)
     {
         MACAddress staAddress = frame->getTransmitterAddress();
-        sta = &staList[staAddress]; // this implicitly creates a new entry
+        sta = &(*staList)[staAddress]; // this implicitly creates a new entry
         sta->address = staAddress;
-        sta->status = NOT_AUTHENTICATED;
+        sta->status = STAInfo::NOT_AUTHENTICATED;
         sta->authSeqExpected = 1;
     }
 
@@ -221,9 +237,9 @@ void Ieee80211MgmtAP::handleAuthenticationFrame(Ieee80211AuthenticationFrame *fr
     // making the MN STA to start the handover process all over again.
     if (frameAuthSeq == 1)
     {
-        if (sta->status == ASSOCIATED)
+        if (sta->status == STAInfo::ASSOCIATED)
             sendDisAssocNotification(sta->address);
-        sta->status = NOT_AUTHENTICATED;
+        sta->status = STAInfo::NOT_AUTHENTICATED;
         sta->authSeqExpected = 1;
     }
 
@@ -258,9 +274,9 @@ void Ieee80211MgmtAP::handleAuthenticationFrame(Ieee80211AuthenticationFrame *fr
     // update status
     if (isLast)
     {
-        if (sta->status == ASSOCIATED)
+        if (sta->status == STAInfo::ASSOCIATED)
             sendDisAssocNotification(sta->address);
-        sta->status = AUTHENTICATED; // XXX only when ACK of this frame arrives
+        sta->status = STAInfo::AUTHENTICATED; // XXX only when ACK of this frame arrives
         EV << "STA authenticated\n";
     }
     else
@@ -280,9 +296,9 @@ void Ieee80211MgmtAP::handleDeauthenticationFrame(Ieee80211DeauthenticationFrame
     if (sta)
     {
         // mark STA as not authenticated; alternatively, it could also be removed from staList
-        if (sta->status == ASSOCIATED)
+        if (sta->status == STAInfo::ASSOCIATED)
             sendDisAssocNotification(sta->address);
-        sta->status = NOT_AUTHENTICATED;
+        sta->status = STAInfo::NOT_AUTHENTICATED;
         sta->authSeqExpected = 1;
     }
 }
@@ -293,7 +309,7 @@ void Ieee80211MgmtAP::handleAssociationRequestFrame(Ieee80211AssociationRequestF
 
     // "11.3.2 AP association procedures"
     STAInfo *sta = lookupSenderSTA(frame);
-    if (!sta || sta->status==NOT_AUTHENTICATED)
+    if (!sta || sta->status==STAInfo::NOT_AUTHENTICATED)
     {
         // STA not authenticated: send error and return
         Ieee80211DeauthenticationFrame *resp = new Ieee80211DeauthenticationFrame("Deauth");
@@ -306,9 +322,9 @@ void Ieee80211MgmtAP::handleAssociationRequestFrame(Ieee80211AssociationRequestF
     delete frame;
 
     // mark STA as associated
-    if (sta->status != ASSOCIATED)
+    if (sta->status != STAInfo::ASSOCIATED)
         sendAssocNotification(sta->address);
-    sta->status = ASSOCIATED; // XXX this should only take place when MAC receives the ACK for the response
+    sta->status = STAInfo::ASSOCIATED; // XXX this should only take place when MAC receives the ACK for the response
 
     // send OK response
     Ieee80211AssociationResponseFrame *resp = new Ieee80211AssociationResponseFrame("AssocResp-OK");
@@ -330,7 +346,7 @@ void Ieee80211MgmtAP::handleReassociationRequestFrame(Ieee80211ReassociationRequ
 
     // "11.3.4 AP reassociation procedures" -- almost the same as AssociationRequest processing
     STAInfo *sta = lookupSenderSTA(frame);
-    if (!sta || sta->status==NOT_AUTHENTICATED)
+    if (!sta || sta->status==STAInfo::NOT_AUTHENTICATED)
     {
         // STA not authenticated: send error and return
         Ieee80211DeauthenticationFrame *resp = new Ieee80211DeauthenticationFrame("Deauth");
@@ -343,7 +359,7 @@ void Ieee80211MgmtAP::handleReassociationRequestFrame(Ieee80211ReassociationRequ
     delete frame;
 
     // mark STA as associated
-    sta->status = ASSOCIATED; // XXX this should only take place when MAC receives the ACK for the response
+    sta->status = STAInfo::ASSOCIATED; // XXX this should only take place when MAC receives the ACK for the response
 
     // send OK response
     Ieee80211ReassociationResponseFrame *resp = new Ieee80211ReassociationResponseFrame("ReassocResp-OK");
@@ -366,9 +382,9 @@ void Ieee80211MgmtAP::handleDisassociationFrame(Ieee80211DisassociationFrame *fr
 
     if (sta)
     {
-        if (sta->status == ASSOCIATED)
+        if (sta->status == STAInfo::ASSOCIATED)
             sendDisAssocNotification(sta->address);
-        sta->status = AUTHENTICATED;
+        sta->status = STAInfo::AUTHENTICATED;
     }
 }
 
@@ -23,6 +23,7 @@
 #include "INETDefs.h"
 
 #include "Ieee80211MgmtAPBase.h"
+#include "Ieee80211StationTable.h"
 #include "NotificationBoard.h"
 
 
@@ -35,17 +36,11 @@
 class INET_API Ieee80211MgmtAP : public Ieee80211MgmtAPBase
 {
   public:
-    /** State of a STA */
-    enum STAStatus {NOT_AUTHENTICATED, AUTHENTICATED, ASSOCIATED};
-
-    /** Describes a STA */
-    struct STAInfo {
-        MACAddress address;
-        STAStatus status;
-        int authSeqExpected;  // when NOT_AUTHENTICATED: transaction sequence number of next expected auth frame
-        //int consecFailedTrans;  //XXX
-        //double expiry;          //XXX association should expire after a while if STA is silent?
-    };
+    /**
+     * Describes a STA. This is the per-station record of the MAC, which
+     * also holds the sequence control cache used for duplicate detection.
+     */
+    typedef Ieee80211StationInfo STAInfo;
 
     class NotificationInfoSta : public cObject
     {
@@ -58,11 +53,7 @@ class INET_API Ieee80211MgmtAP : public Ieee80211MgmtAPBase
           const MACAddress & getStaAddress() const {return staAddress;}
     };
 
-
-    struct MAC_compare {
-        bool operator()(const MACAddress& u1, const MACAddress& u2) const {return u1.compareTo(u2) < 0;}
-    };
-    typedef std::map<MACAddress,STAInfo, MAC_compare> STAList;
+    typedef Ieee80211StationTable STAList;
 
   protected:
 
@@ -76,7 +67,7 @@ class INET_API Ieee80211MgmtAP : public Ieee80211MgmtAPBase
     Ieee80211SupportedRatesElement supportedRates;
 
     // state
-    STAList staList; ///< list of STAs
+    STAList *staList; ///< list of STAs: the station records of the MAC
     cMessage *beaconTimer;
 
   protected:
@@ -95,6 +86,9 @@ class INET_API Ieee80211MgmtAP : public Ieee80211MgmtAPBase
     /** Called by the NotificationBoard whenever a change occurs we're interested in */
     virtual void receiveChangeNotification(int category, const cObject *details);
 
+    /** Utility function: return the STA's entry from our STA list, or NULL if not in there */
+    virtual STAInfo *lookupSTA(const MACAddress& address);
+
     /** Utility function: return sender STA's entry from our STA list, or NULL if not in there */
     virtual STAInfo *lookupSenderSTA(Ieee80211ManagementFrame *frame);
 
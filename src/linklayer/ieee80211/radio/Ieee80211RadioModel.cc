@@ -132,10 +132,7 @@ double Ieee80211RadioModel::calculateDuration(AirFrame *airframe)
 bool Ieee80211RadioModel::isReceivedCorrectly(AirFrame *airframe, const SnrList& receivedList)
 {
     // calculate snirMin
-    double snirMin = receivedList.begin()->snr;
-    for (SnrList::const_iterator iter = receivedList.begin(); iter != receivedList.end(); iter++)
-        if (iter->snr < snirMin)
-            snirMin = iter->snr;
+    double snirMin = getMinSnr(receivedList);
 
     cPacket *frame = airframe->getEncapsulatedPacket();
     EV << "packet (" << frame->getClassName() << ")" << frame->getName() << " (" << frame->info() << ") snrMin=" << snirMin << endl;
@@ -27,6 +27,10 @@
 #include "NotificationBoard.h"
 #include "NotifierConsts.h"
 
+#ifdef WITH_TCP_COMMON
+#include "TCPSegmentationOffload.h"
+#endif
+
 
 Define_Module(PPP);
 
@@ -63,6 +67,7 @@ void PPP::initialize(int stage)
         endTransmissionEvent = new cMessage("pppEndTxEvent");
 
         txQueueLimit = par("txQueueLimit");
+        segmentationOffload = par("segmentationOffload");
 
         interfaceEntry = NULL;
 
@@ -171,6 +176,7 @@ InterfaceEntry *PPP::registerInterface(double datarate)
     // capabilities
     e->setMulticast(true);
     e->setPointToPoint(true);
+    e->setSegmentationOffload(segmentationOffload);
 
     // add
     IInterfaceTable *ift = InterfaceTableAccess().getIfExists();
@@ -281,6 +287,13 @@ void PPP::startTransmitting(cPacket *msg)
     delete msg->removeControlInfo();
     PPPFrame *pppFrame = encapsulate(msg);
 
+#ifdef WITH_TCP_COMMON
+    // a TCP super-segment occupies the link for the frames of its segments,
+    // each with its own headers
+    if (segmentationOffload)
+        pppFrame->setByteLength(TCPSegmentationOffload::getSegmentedByteLength(pppFrame, 0));
+#endif
+
     if (ev.isGUI())
         displayBusy();
 
@@ -44,6 +44,7 @@ class INET_API PPP : public cSimpleModule, public INotifiable, public cListener
     IPassiveQueue *queueModule;
 
     InterfaceEntry *interfaceEntry;  // points into IInterfaceTable
+    bool segmentationOffload;        // if true, TCP super-segments are transmitted as separate frames
 
     NotificationBoard *nb;
     TxNotifDetails notifDetails;
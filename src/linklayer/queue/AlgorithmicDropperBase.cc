@@ -18,8 +18,25 @@
 
 #include "AlgorithmicDropperBase.h"
 
+#include "ECN_m.h"
+#include "PassiveQueueBase.h"
+
+#ifdef WITH_IPv4
+#include "IPv4Datagram.h"
+#endif
+
+#ifdef WITH_IPv6
+#include "IPv6Datagram.h"
+#endif
+
+simsignal_t AlgorithmicDropperBase::dropPkSignal = SIMSIGNAL_NULL;
+simsignal_t AlgorithmicDropperBase::markPkSignal = SIMSIGNAL_NULL;
+
 void AlgorithmicDropperBase::initialize()
 {
+    dropPkSignal = registerSignal("dropPk");
+    markPkSignal = registerSignal("markPk");
+
     numGates = gateSize("out");
     for (int i = 0; i < numGates; ++i)
     {
@@ -38,15 +55,77 @@ void AlgorithmicDropperBase::initialize()
 void AlgorithmicDropperBase::handleMessage(cMessage *msg)
 {
     cPacket *packet = check_and_cast<cPacket*>(msg);
-    if (shouldDrop(packet))
+    if (admitPacket(packet, packet->getArrivalGate()->getIndex()))
+        sendOut(packet);
+}
+
+bool AlgorithmicDropperBase::insertPacket(cPacket *packet, int gateIndex)
+{
+    Enter_Method_Silent();
+    take(packet);
+
+    if (!admitPacket(packet, gateIndex))
+        return false;
+
+    PassiveQueueBase *outQueue = dynamic_cast<PassiveQueueBase*>(outQueues[gateIndex]);
+    if (!outQueue)
+        throw cRuntimeError("Out gate %d should be connected to a PassiveQueueBase", gateIndex);
+    return outQueue->insertPacket(packet);
+}
+
+bool AlgorithmicDropperBase::admitPacket(cPacket *packet, int gateIndex)
+{
+    if (isFull(packet))
+    {
         dropPacket(packet);
+        return false;
+    }
+    else if (!shouldDrop(packet, gateIndex))
+        return true;
+    else if (useEcn && markPacket(packet))
+    {
+        EV << "Marking packet " << packet->getName() << " with ECN CE instead of dropping it.\n";
+        emit(markPkSignal, packet);
+        return true;
+    }
     else
-        sendOut(packet);
+    {
+        dropPacket(packet);
+        return false;
+    }
+}
+
+bool AlgorithmicDropperBase::markPacket(cPacket *packet)
+{
+    for (; packet; packet = packet->getEncapsulatedPacket())
+    {
+#ifdef WITH_IPv4
+        IPv4Datagram *ipv4Datagram = dynamic_cast<IPv4Datagram *>(packet);
+        if (ipv4Datagram)
+        {
+            if (ipv4Datagram->getExplicitCongestionNotification() == IP_ECN_NOT_ECT)
+                return false;
+            ipv4Datagram->setExplicitCongestionNotification(IP_ECN_CE);
+            return true;
+        }
+#endif
+#ifdef WITH_IPv6
+        IPv6Datagram *ipv6Datagram = dynamic_cast<IPv6Datagram *>(packet);
+        if (ipv6Datagram)
+        {
+            if (ipv6Datagram->getExplicitCongestionNotification() == IP_ECN_NOT_ECT)
+                return false;
+            ipv6Datagram->setExplicitCongestionNotification(IP_ECN_CE);
+            return true;
+        }
+#endif
+    }
+    return false;
 }
 
 void AlgorithmicDropperBase::dropPacket(cPacket *packet)
 {
-    // TODO statistics
+    emit(dropPkSignal, packet);
     delete packet;
 }
 
@@ -24,23 +24,49 @@
 
 /**
  * Base class for algorithmic droppers (RED, DropTail, etc.).
+ *
+ * In marking mode (useEcn), packets that shouldDrop() selects are not
+ * dropped if they belong to an ECN-capable transport: the Congestion
+ * Experienced codepoint is set in their IP header instead (RFC 3168).
+ * Packets that isFull() selects are dropped in either mode.
  */
 class INET_API AlgorithmicDropperBase : public cSimpleModule, public IQueueAccess
 {
     protected:
       int numGates;
+      bool useEcn; // mark ECN-capable packets instead of dropping them
       std::vector<IQueueAccess*> outQueues; // vector of out queues indexed by gate index (may contain duplicate elements)
       std::set<IQueueAccess*> outQueueSet; // set of out queues; comparing pointers is ok
+
+      // statistics
+      static simsignal_t dropPkSignal;
+      static simsignal_t markPkSignal;
     public:
-      AlgorithmicDropperBase() : numGates(0) {};
+      AlgorithmicDropperBase() : numGates(0), useEcn(false) {};
       virtual ~AlgorithmicDropperBase() {};
     protected:
       virtual void initialize();
       virtual void handleMessage(cMessage *msg);
-      virtual bool shouldDrop(cPacket *packet) = 0;
+      /** Returns true if the packet arriving on the given input gate may go on, after dropping or marking it as needed */
+      virtual bool admitPacket(cPacket *packet, int gateIndex);
+      virtual bool shouldDrop(cPacket *packet, int gateIndex) = 0;
+      /** Returns true if the packet must be dropped even in marking mode; this default returns false */
+      virtual bool isFull(cPacket *packet) { return false; }
+      /** Sets CE in the IP datagram of the packet, and returns true; returns false if the datagram is not ECN-capable */
+      virtual bool markPacket(cPacket *packet);
       virtual void dropPacket(cPacket *packet);
       virtual void sendOut(cPacket *packet);
 
+    public:
+      /**
+       * Processes the packet as if it had arrived on in[gateIndex], and
+       * inserts it into the queue of that gate directly instead of sending
+       * it (see DiffservQueuePipeline); the queue must be a PassiveQueueBase.
+       * Returns false if the packet was dropped.
+       */
+      virtual bool insertPacket(cPacket *packet, int gateIndex);
+
+    protected:
       virtual int getLength() const;
       virtual int getByteLength() const;
 };
@@ -20,16 +20,10 @@
 
 Define_Module(PriorityScheduler);
 
-bool PriorityScheduler::schedulePacket()
+int PriorityScheduler::selectInputQueue()
 {
-    for (std::vector<IPassiveQueue*>::iterator it = inputQueues.begin(); it != inputQueues.end(); ++it)
-    {
-        IPassiveQueue *inputQueue = *it;
-        if (!inputQueue->isEmpty())
-        {
-            inputQueue->requestPacket();
-            return true;
-        }
-    }
-    return false;
+    for (int i = 0; i < (int)inputQueues.size(); ++i)
+        if (!inputQueues[i]->isEmpty())
+            return i;
+    return -1;
 }
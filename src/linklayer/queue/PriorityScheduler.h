@@ -30,7 +30,7 @@
 class INET_API PriorityScheduler : public SchedulerBase
 {
   protected:
-    virtual bool schedulePacket();
+    virtual int selectInputQueue();
 };
 
 #endif
@@ -36,6 +36,9 @@ void REDDropper::initialize()
     if (wq < 0.0 || wq > 1.0)
         throw cRuntimeError("Invalid value for wq parameter: %g", wq);
 
+    useEcn = par("useEcn");
+    frameCapacity = par("frameCapacity");
+
     minths = new double[numGates];
     maxths = new double[numGates];
     maxps = new double[numGates];
@@ -56,16 +59,16 @@ void REDDropper::initialize()
             throw cRuntimeError("minth parameter must not be negative");
         if (maxths[i] < 0.0)
             throw cRuntimeError("maxth parameter must not be negative");
-        if (minths[i] >= maxths[i])
-            throw cRuntimeError("minth must be smaller than maxth");
+        if (minths[i] > maxths[i])
+            throw cRuntimeError("minth must not be greater than maxth");
         if (maxps[i] < 0.0 || maxps[i] > 1.0)
             throw cRuntimeError("Invalid value for maxp parameter: %g", maxps[i]);
     }
 }
 
-bool REDDropper::shouldDrop(cPacket *packet)
+bool REDDropper::shouldDrop(cPacket *packet, int gateIndex)
 {
-    int i = packet->getArrivalGate()->getIndex();
+    int i = gateIndex;
     ASSERT(i >= 0 && i < numGates);
     double minth = minths[i];
     double maxth = maxths[i];
@@ -98,3 +101,13 @@ bool REDDropper::shouldDrop(cPacket *packet)
 
     return false;
 }
+
+bool REDDropper::isFull(cPacket *packet)
+{
+    if (frameCapacity >= 0 && getLength() >= frameCapacity)
+    {
+        EV << "Queue len " << getLength() << " >= frameCapacity, dropping packet.\n";
+        return true;
+    }
+    return false;
+}
@@ -32,15 +32,17 @@ class REDDropper : public AlgorithmicDropperBase
     double *minths;
     double *maxths;
     double *maxps;
+    int frameCapacity;
 
     double avg;
 
   public:
-    REDDropper() : wq(0), minths(NULL), maxths(NULL), maxps(NULL), avg(0.0) {}
+    REDDropper() : wq(0), minths(NULL), maxths(NULL), maxps(NULL), frameCapacity(-1), avg(0.0) {}
   protected:
     virtual ~REDDropper();
     virtual void initialize();
-    virtual bool shouldDrop(cPacket *packet);
+    virtual bool shouldDrop(cPacket *packet, int gateIndex);
+    virtual bool isFull(cPacket *packet);
 };
 
 #endif
@@ -88,6 +88,22 @@ void SchedulerBase::requestPacket()
         packetsToBeRequestedFromInputs--;
 }
 
+cMessage *SchedulerBase::removePacket()
+{
+    Enter_Method_Silent();
+    int index = selectInputQueue();
+    return index < 0 ? NULL : inputQueues[index]->removePacket();
+}
+
+bool SchedulerBase::schedulePacket()
+{
+    int index = selectInputQueue();
+    if (index < 0)
+        return false;
+    inputQueues[index]->requestPacket();
+    return true;
+}
+
 void SchedulerBase::sendOut(cMessage *msg)
 {
     send(msg, outGate);
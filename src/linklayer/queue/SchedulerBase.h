@@ -55,10 +55,17 @@ class INET_API SchedulerBase : public cSimpleModule, public IPassiveQueue, publi
       virtual void handleMessage(cMessage *msg);
       virtual void sendOut(cMessage *msg);
       virtual void notifyListeners();
-      virtual bool schedulePacket() = 0;
+      /**
+       * Returns the index of the input queue to be served next, or -1 if
+       * there is none; it is called for every packet that leaves, so it may
+       * update the state of the scheduling algorithm.
+       */
+      virtual int selectInputQueue() = 0;
+      virtual bool schedulePacket();
 
     public:
       virtual void requestPacket();
+      virtual cMessage *removePacket();
       virtual int getNumPendingRequests() { return packetsRequestedFromUs; }
       virtual bool isEmpty();
       virtual void clear();
@@ -28,7 +28,7 @@ void ThresholdDropper::initialize()
     byteCapacity = par("byteCapacity");
 }
 
-bool ThresholdDropper::shouldDrop(cPacket *packet)
+bool ThresholdDropper::shouldDrop(cPacket *packet, int gateIndex)
 {
     if (frameCapacity >= 0 && (getLength() + 1) > frameCapacity)
         return true;
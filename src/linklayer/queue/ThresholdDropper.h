@@ -34,7 +34,7 @@ class INET_API ThresholdDropper : public AlgorithmicDropperBase
 
   protected:
     virtual void initialize();
-    virtual bool shouldDrop(cPacket *packet);
+    virtual bool shouldDrop(cPacket *packet, int gateIndex);
 };
 
 #endif
@@ -47,7 +47,7 @@ void WRRScheduler::initialize()
         throw cRuntimeError("Too many values given in the weights parameter.");
 }
 
-bool WRRScheduler::schedulePacket()
+int WRRScheduler::selectInputQueue()
 {
     bool allQueueIsEmpty = true;
     for (int i = 0; i < numInputs; ++i)
@@ -58,26 +58,24 @@ bool WRRScheduler::schedulePacket()
             if (buckets[i] > 0)
             {
                 buckets[i]--;
-                inputQueues[i]->requestPacket();
-                return true;
+                return i;
             }
         }
     }
 
     if (allQueueIsEmpty)
-        return false;
+        return -1;
 
-    bool packetRequested = false;
+    int selected = -1;
     for (int i = 0; i < numInputs; ++i)
     {
         buckets[i] = weights[i];
-        if (!packetRequested && buckets[i] > 0 && !inputQueues[i]->isEmpty())
+        if (selected < 0 && buckets[i] > 0 && !inputQueues[i]->isEmpty())
         {
             buckets[i]--;
-            inputQueues[i]->requestPacket();
-            packetRequested = true;
+            selected = i;
         }
     }
 
-    return packetRequested;
+    return selected;
 }
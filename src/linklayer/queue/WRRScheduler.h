@@ -36,7 +36,7 @@ class WRRScheduler : public SchedulerBase
   protected:
     virtual ~WRRScheduler();
     virtual void initialize();
-    virtual bool schedulePacket();
+    virtual int selectInputQueue();
 };
 
 #endif
@@ -63,10 +63,7 @@ double GenericRadioModel::calculateDuration(AirFrame *airframe)
 bool GenericRadioModel::isReceivedCorrectly(AirFrame *airframe, const SnrList& receivedList)
 {
     // calculate snirMin
-    double snirMin = receivedList.begin()->snr;
-    for (SnrList::const_iterator iter = receivedList.begin(); iter != receivedList.end(); iter++)
-        if (iter->snr < snirMin)
-            snirMin = iter->snr;
+    double snirMin = getMinSnr(receivedList);
 
     if (snirMin <= snirThreshold)
     {
@@ -49,6 +49,7 @@ Radio::Radio() : rs(this->getId())
     receiverConnect = true;
     updateString = NULL;
     noiseGenerator = NULL;
+    ObjectPool::addUser();
 }
 
 void Radio::initialize(int stage)
@@ -95,6 +96,7 @@ void Radio::initialize(int stage)
         // initialize the pointer of the snrInfo with NULL to indicate
         // that currently no message is received
         snrInfo.ptr = NULL;
+        snrInfo.sList.reserve(16);
 
         // no channel switch pending
         newChannel = -1;
@@ -173,6 +175,7 @@ void Radio::initialize(int stage)
 
 void Radio::finish()
 {
+    ObjectPool::recordStatistics();
 }
 
 Radio::~Radio()
@@ -187,6 +190,7 @@ Radio::~Radio()
     // delete messages being received
     for (RecvBuff::iterator it = recvBuff.begin(); it!=recvBuff.end(); ++it)
         delete it->first;
+    ObjectPool::removeUser();
 }
 
 
@@ -578,10 +582,9 @@ void Radio::handleLowerMsgStart(AirFrame* airframe)
         EV << "receiving frame " << airframe->getName() << endl;
 
         // Put frame and related SnrList in receive buffer
-        SnrList snrList;
         snrInfo.ptr = airframe;
         snrInfo.rcvdPower = rcvdPower;
-        snrInfo.sList = snrList;
+        snrInfo.sList.clear();
 
         // add initial snr value
         addNewSnr();
@@ -635,14 +638,14 @@ void Radio::handleLowerMsgEnd(AirFrame * airframe)
     if (snrInfo.ptr == airframe)
     {
         EV << "reception of frame over, preparing to send packet to upper layer\n";
-        // get Packet and list out of the receive buffer:
-        SnrList list;
-        list = snrInfo.sList;
+        // get Packet and list out of the receive buffer; the list is
+        // handed to the decider in place and cleared afterwards, so its
+        // storage is reused for the next reception
+        const SnrList& list = snrInfo.sList;
 
         // delete the pointer to indicate that no message is currently
-        // being received and clear the list
+        // being received
         snrInfo.ptr = NULL;
-        snrInfo.sList.clear();
 
         airframe->setSnr(10*log10(recvBuff[airframe]/ (BASE_NOISE_LEVEL))); //ahmed
         airframe->setLossRate(lossRate);
@@ -664,6 +667,8 @@ void Radio::handleLowerMsgEnd(AirFrame * airframe)
         else
             numReceivedCorrectly++;
 
+        snrInfo.sList.clear();
+
         if ( (numReceivedCorrectly+numGivenUp)%50 == 0)
         {
             lossRate = (double)numGivenUp/((double)numReceivedCorrectly+(double)numGivenUp);
@@ -20,7 +20,7 @@
 #ifndef SNRLIST_H
 #define SNRLIST_H
 
-#include <list>
+#include <vector>
 
 /**
  * @brief struct for SNR information
@@ -47,10 +47,30 @@ struct SnrListEntry{
  * Decider. Each SnrListEntry in this list corresponds to one SNR
  * value at a specific time.
  *
+ * The entries are stored contiguously; the owner (the Radio) keeps one
+ * list and clear()s it between receptions, so its storage is reused
+ * instead of being allocated entry by entry.
+ *
  * @ingroup utils
  * @ingroup basicUtils
  * @author Marc Lbbers
  */
-typedef std::list<SnrListEntry> SnrList;
+typedef std::vector<SnrListEntry> SnrList;
+
+/**
+ * @brief Returns the minimum SNR value over all entries of the list.
+ *
+ * Evaluates every SNR segment of the reception in a single pass over the
+ * contiguous buffer. The list must not be empty.
+ */
+inline double getMinSnr(const SnrList& snrList)
+{
+    const SnrListEntry *entries = &snrList[0];
+    size_t n = snrList.size();
+    double snrMin = entries[0].snr;
+    for (size_t k = 1; k < n; k++)
+        snrMin = entries[k].snr < snrMin ? entries[k].snr : snrMin;
+    return snrMin;
+}
 
 #endif
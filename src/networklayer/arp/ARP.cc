@@ -28,6 +28,7 @@
 #include "ARPPacket_m.h"
 #include "IInterfaceTable.h"
 #include "InterfaceTableAccess.h"
+#include "NotificationBoard.h"
 
 
 simsignal_t ARP::sentReqSignal = SIMSIGNAL_NULL;
@@ -65,6 +66,7 @@ ARP::ARP()
 
     ift = NULL;
     rt = NULL;
+    nb = NULL;
 }
 
 void ARP::initialize(int stage)
@@ -81,6 +83,7 @@ void ARP::initialize(int stage)
     {
         ift = InterfaceTableAccess().get();
         rt = RoutingTableAccess().get();
+        nb = NotificationBoardAccess().getIfExists();
 
         nicOutBaseGateId = gateSize("nicOut")==0 ? -1 : gate("nicOut", 0)->getId();
 
@@ -182,6 +185,7 @@ void ARP::processOutboundPacket(cMessage *msg)
     // get next hop address from control info in packet
     IPv4RoutingDecision *controlInfo = check_and_cast<IPv4RoutingDecision*>(msg->removeControlInfo());
     IPv4Address nextHopAddr = controlInfo->getNextHopAddr();
+    MACAddress nextHopMacAddr = controlInfo->getNextHopMacAddr();
     InterfaceEntry *ie = ift->getInterfaceById(controlInfo->getInterfaceId());
     delete controlInfo;
 
@@ -193,6 +197,14 @@ void ARP::processOutboundPacket(cMessage *msg)
         return;
     }
 
+    // already resolved by the flow cache of IPv4 (see getResolvedAddress())
+    if (!nextHopMacAddr.isUnspecified())
+    {
+        EV << "MAC address already resolved by IPv4: " << nextHopMacAddr << ", sending packet down\n";
+        sendPacketToNIC(msg, ie, nextHopMacAddr, ETHERTYPE_IPv4);
+        return;
+    }
+
     // determine what address to look up in ARP cache
     if (!nextHopAddr.isUnspecified())
     {
@@ -534,6 +546,10 @@ void ARP::updateARPCache(ARPCacheEntry *entry, const MACAddress& macAddress)
 {
     EV << "Updating ARP cache entry: " << entry->myIter->first << " <--> " << macAddress << "\n";
 
+    // the old address may be cached elsewhere (see getResolvedAddress())
+    if (!entry->pending && entry->macAddress != macAddress && nb)
+        nb->fireChangeNotification(NF_ARP_CACHE_CHANGED, NULL);
+
     // update entry
     if (entry->pending)
     {
@@ -577,6 +593,27 @@ const MACAddress ARP::getDirectAddressResolution(const IPv4Address & add) const
     return address;
 }
 
+MACAddress ARP::getResolvedAddress(const IPv4Address& addr, InterfaceEntry *ie, simtime_t& expiryTime) const
+{
+    if (globalARP)
+    {
+        ARPCache::const_iterator it = globalArpCache.find(addr);
+        if (it == globalArpCache.end())
+            return MACAddress::UNSPECIFIED_ADDRESS;
+        expiryTime = MAXTIME;
+        return it->second->macAddress;
+    }
+
+    ARPCache::const_iterator it = arpCache.find(addr);
+    if (it == arpCache.end() || it->second->pending || it->second->ie != ie)
+        return MACAddress::UNSPECIFIED_ADDRESS;
+    ARPCacheEntry *entry = it->second;
+    if (entry->lastUpdate + cacheTimeout < simTime())
+        return MACAddress::UNSPECIFIED_ADDRESS;  // stale: processOutboundPacket() starts a new resolution
+    expiryTime = entry->lastUpdate + cacheTimeout;
+    return entry->macAddress;
+}
+
 const IPv4Address ARP::getInverseAddressResolution(const MACAddress &add) const
 {
     IPv4Address address;
@@ -619,6 +656,8 @@ void ARP::setChangeAddress(const IPv4Address &oldAddress)
             IPv4Address nextHopAddr = entry->ie->ipv4Data()->getIPAddress();
             ARPCache::iterator where = globalArpCache.insert(globalArpCache.begin(), std::make_pair(nextHopAddr, entry));
             entry->myIter = where; // note: "inserting a new element into a map does not invalidate iterators that point to existing elements"
+            if (nb)
+                nb->fireChangeNotification(NF_ARP_CACHE_CHANGED, NULL);
         }
     }
 }
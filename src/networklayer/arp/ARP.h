@@ -34,6 +34,7 @@ class ARPPacket;
 class IInterfaceTable;
 class InterfaceEntry;
 class IRoutingTable;
+class NotificationBoard;
 
 /**
  * ARP implementation.
@@ -86,6 +87,7 @@ class INET_API ARP : public cSimpleModule
 
     IInterfaceTable *ift;
     IRoutingTable *rt;  // for Proxy ARP
+    NotificationBoard *nb;  // for NF_ARP_CACHE_CHANGED; may be NULL
 
     // Maps an IP multicast address to an Ethernet multicast address.
     MACAddress mapMulticastAddress(IPv4Address addr);
@@ -95,6 +97,15 @@ class INET_API ARP : public cSimpleModule
     virtual ~ARP();
     int numInitStages() const {return 5;}
     const MACAddress getDirectAddressResolution(const IPv4Address &) const;
+
+    /**
+     * Returns the MAC address of the given address if the cache holds a
+     * resolved, unexpired entry for it on the given interface, and stores
+     * the time the entry times out in expiryTime. Returns the unspecified
+     * address otherwise. Changes of resolved entries are announced with
+     * NF_ARP_CACHE_CHANGED, so the result may be cached until expiryTime.
+     */
+    MACAddress getResolvedAddress(const IPv4Address& addr, InterfaceEntry *ie, simtime_t& expiryTime) const;
     const IPv4Address getInverseAddressResolution(const MACAddress &) const;
     void setChangeAddress(const IPv4Address &);
 
@@ -104,7 +104,8 @@ class INET_API IInterfaceTable
 
     /**
      * Returns an interface given by its getNetworkLayerGateIndex().
-     * Returns NULL if not found.
+     * Returns NULL if not found. Called by the network layer for every
+     * incoming packet, so implementations should make it cheap.
      */
     virtual InterfaceEntry *getInterfaceByNetworkLayerGateIndex(int index) = 0;
 
@@ -60,6 +60,7 @@ InterfaceEntry::InterfaceEntry(cModule* ifmod)
     multicast = false;
     pointToPoint = false;
     loopback = false;
+    segmentationOffload = false;
     datarate = 0;
 
     ipv4data = NULL;
@@ -83,6 +84,7 @@ std::string InterfaceEntry::info() const
     if (isMulticast()) out << " MULTICAST";
     if (isPointToPoint()) out << " POINTTOPOINT";
     if (isLoopback()) out << " LOOPBACK";
+    if (hasSegmentationOffload()) out << " TSO";
     out << "  macAddr:";
     if (getMacAddress().isUnspecified())
         out << "n/a";
@@ -114,6 +116,7 @@ std::string InterfaceEntry::detailedInfo() const
     if (isMulticast()) out << "MULTICAST ";
     if (isPointToPoint()) out << "POINTTOPOINT ";
     if (isLoopback()) out << "LOOPBACK ";
+    if (hasSegmentationOffload()) out << "TSO ";
     out << "\n";
     out << "  macAddr:";
     if (getMacAddress().isUnspecified())
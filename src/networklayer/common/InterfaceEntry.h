@@ -91,6 +91,7 @@ class INET_API InterfaceEntry : public cNamedObject
     bool multicast;       ///< interface supports multicast
     bool pointToPoint;    ///< interface is point-to-point link
     bool loopback;        ///< interface is loopback interface
+    bool segmentationOffload; ///< interface transmits TCP super-segments as separate frames (see TCPSegmentationOffload)
     double datarate;      ///< data rate in bit/s
     MACAddress macAddr;   ///< link-layer address (for now, only IEEE 802 MAC addresses are supported)
     InterfaceToken token; ///< for IPv6 stateless autoconfig (RFC 1971), interface identifier (RFC 2462)
@@ -142,6 +143,7 @@ class INET_API InterfaceEntry : public cNamedObject
     bool isMulticast() const          {return multicast;}
     bool isPointToPoint() const       {return pointToPoint;}
     bool isLoopback() const           {return loopback;}
+    bool hasSegmentationOffload() const {return segmentationOffload;}
     double getDatarate() const        {return datarate;}
     const MACAddress& getMacAddress() const  {return macAddr;}
     const InterfaceToken& getInterfaceToken() const {return token;}
@@ -159,6 +161,7 @@ class INET_API InterfaceEntry : public cNamedObject
     virtual void setMulticast(bool b)    {multicast = b; configChanged();}
     virtual void setPointToPoint(bool b) {pointToPoint = b; configChanged();}
     virtual void setLoopback(bool b)     {loopback = b; configChanged();}
+    virtual void setSegmentationOffload(bool b) {segmentationOffload = b; configChanged();}
     virtual void setDatarate(double d)   {datarate = d; configChanged();}
     virtual void setMACAddress(const MACAddress& addr) {macAddr = addr; configChanged();}
     virtual void setInterfaceToken(const InterfaceToken& t) {token = t; configChanged();}
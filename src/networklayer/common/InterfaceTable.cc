@@ -233,10 +233,14 @@ void InterfaceTable::invalidateTmpInterfaceList()
     tmpNumInterfaces = -1;
     delete [] tmpInterfaceList;
     tmpInterfaceList = NULL;
+    tmpNetworkLayerGateIndexToInterface.clear();
 }
 
 void InterfaceTable::interfaceChanged(InterfaceEntry *entry, int category)
 {
+    if (category == NF_INTERFACE_CONFIG_CHANGED)
+        tmpNetworkLayerGateIndexToInterface.clear();  // network layer gate index may have changed
+
     nb->fireChangeNotification(category, entry);
 
     if (ev.isGUI() && par("displayAddresses").boolValue())
@@ -295,13 +299,24 @@ InterfaceEntry *InterfaceTable::getInterfaceByNodeInputGateId(int id)
 
 InterfaceEntry *InterfaceTable::getInterfaceByNetworkLayerGateIndex(int index)
 {
-    // linear search is OK because normally we have don't have many interfaces and this func is rarely called
-    Enter_Method_Silent();
-    int n = idToInterface.size();
-    for (int i=0; i<n; i++)
-        if (idToInterface[i] && idToInterface[i]->getNetworkLayerGateIndex()==index)
-            return idToInterface[i];
-    return NULL;
+    // no Enter_Method: this gets called by the network layer for every incoming packet
+    if (tmpNetworkLayerGateIndexToInterface.empty())
+    {
+        // build gate index -> interface table if not yet done (first match wins)
+        int n = idToInterface.size();
+        for (int i=0; i<n; i++)
+        {
+            InterfaceEntry *ie = idToInterface[i];
+            if (!ie || ie->getNetworkLayerGateIndex() < 0)
+                continue;
+            int gateIndex = ie->getNetworkLayerGateIndex();
+            if (gateIndex >= (int)tmpNetworkLayerGateIndexToInterface.size())
+                tmpNetworkLayerGateIndexToInterface.resize(gateIndex+1, NULL);
+            if (!tmpNetworkLayerGateIndexToInterface[gateIndex])
+                tmpNetworkLayerGateIndexToInterface[gateIndex] = ie;
+        }
+    }
+    return (index<0 || index>=(int)tmpNetworkLayerGateIndexToInterface.size()) ? NULL : tmpNetworkLayerGateIndexToInterface[index];
 }
 
 InterfaceEntry *InterfaceTable::getInterfaceByInterfaceModule(cModule *ifmod)
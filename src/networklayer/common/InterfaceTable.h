@@ -78,6 +78,9 @@ class INET_API InterfaceTable : public cSimpleModule, public IInterfaceTable, pr
     int tmpNumInterfaces; // caches number of non-NULL elements of idToInterface; -1 if invalid
     InterfaceEntry **tmpInterfaceList; // caches non-NULL elements of idToInterface; NULL if invalid
 
+    // field to support getInterfaceByNetworkLayerGateIndex(); empty if invalid
+    InterfaceVector tmpNetworkLayerGateIndexToInterface;
+
   protected:
     // displays summary above the icon
     virtual void updateDisplayString();
@@ -172,7 +175,9 @@ class INET_API InterfaceTable : public cSimpleModule, public IInterfaceTable, pr
 
     /**
      * Returns an interface given by its getNetworkLayerGateIndex().
-     * Returns NULL if not found.
+     * Returns NULL if not found. This is a constant-time lookup that
+     * does not use Enter_Method, so the network layer may call it for
+     * every packet.
      */
     virtual InterfaceEntry *getInterfaceByNetworkLayerGateIndex(int index);
 
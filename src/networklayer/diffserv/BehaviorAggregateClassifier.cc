@@ -66,14 +66,21 @@ void BehaviorAggregateClassifier::initialize()
 void BehaviorAggregateClassifier::handleMessage(cMessage *msg)
 {
     cPacket *packet = check_and_cast<cPacket*>(msg);
-    numRcvd++;
-    int clazz = classifyPacket(packet);
-    emit(pkClassSignal, clazz);
+    int clazz = processPacket(packet);
 
     if (clazz >= 0)
         send(packet, "outs", clazz);
     else
         send(packet, "defaultOut");
+}
+
+int BehaviorAggregateClassifier::processPacket(cPacket *packet)
+{
+    Enter_Method_Silent();
+
+    numRcvd++;
+    int clazz = classifyPacket(packet);
+    emit(pkClassSignal, clazz);
 
     if (ev.isGUI())
     {
@@ -81,6 +88,8 @@ void BehaviorAggregateClassifier::handleMessage(cMessage *msg)
         if (numRcvd>0) sprintf(buf+strlen(buf), "rcvd:%d ", numRcvd);
         getDisplayString().setTagArg("t", 0, buf);
     }
+
+    return clazz;
 }
 
 int BehaviorAggregateClassifier::classifyPacket(cPacket *packet)
@@ -46,6 +46,15 @@ class INET_API BehaviorAggregateClassifier : public cSimpleModule
     virtual int classifyPacket(cPacket *packet);
 
     int getDscpFromPacket(cPacket *packet);
+
+  public:
+    /**
+     * Classifies the packet as if it had arrived on the input gate, and
+     * returns the index of its out gate, or -1 for the defaultOut gate,
+     * instead of sending it; used when the classifier is run in process
+     * (see DiffservQueuePipeline).
+     */
+    virtual int processPacket(cPacket *packet);
 };
 
 #endif
@@ -0,0 +1,159 @@
+//
+// Copyright (C) 2013 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <algorithm>
+
+#include "DiffservQueuePipeline.h"
+
+#include "AlgorithmicDropperBase.h"
+#include "BehaviorAggregateClassifier.h"
+#include "DiffservUtil.h"
+#include "PassiveQueueBase.h"
+#include "Sink.h"
+#include "TokenBucketMeter.h"
+
+using namespace DiffservUtil;
+
+Define_Module(DiffservQueuePipeline);
+
+void DiffservQueuePipeline::initialize()
+{
+    packetRequested = 0;
+    WATCH(packetRequested);
+
+    outGate = gate("out");
+
+    stagesOutGate = gate("stagesOut");
+    if (stagesOutGate->getPathEndGate()->getOwnerModule() == this)
+        throw cRuntimeError("The stagesOut gate is not connected");
+
+    cModule *lastStageModule = gate("stagesIn")->getPathStartGate()->getOwnerModule();
+    if (lastStageModule == this)
+        throw cRuntimeError("The stagesIn gate is not connected");
+    lastStage = dynamic_cast<IPassiveQueue*>(lastStageModule);
+    if (!lastStage)
+        throw cRuntimeError("The stagesIn gate should be connected to an IPassiveQueue");
+}
+
+void DiffservQueuePipeline::handleMessage(cMessage *msg)
+{
+    cPacket *packet = check_and_cast<cPacket*>(msg);
+    if (!deliverPacket(packet, stagesOutGate))
+        return;
+
+    if (packetRequested > 0)
+    {
+        cMessage *outMsg = removePacket();
+        if (outMsg)
+        {
+            packetRequested--;
+            send(outMsg, outGate);
+        }
+    }
+    else
+        notifyListeners();
+}
+
+bool DiffservQueuePipeline::deliverPacket(cPacket *packet, cGate *fromGate)
+{
+    cGate *toGate = fromGate->getPathEndGate();
+    cModule *stage = toGate->getOwnerModule();
+
+    BehaviorAggregateClassifier *classifier = dynamic_cast<BehaviorAggregateClassifier*>(stage);
+    if (classifier)
+    {
+        int clazz = classifier->processPacket(packet);
+        return deliverPacket(packet, clazz >= 0 ? classifier->gate("outs", clazz) : classifier->gate("defaultOut"));
+    }
+
+    TokenBucketMeter *meter = dynamic_cast<TokenBucketMeter*>(stage);
+    if (meter)
+    {
+        int color = meter->processPacket(packet);
+        return deliverPacket(packet, meter->gate(color == GREEN ? "greenOut" : "redOut"));
+    }
+
+    AlgorithmicDropperBase *dropper = dynamic_cast<AlgorithmicDropperBase*>(stage);
+    if (dropper)
+        return dropper->insertPacket(packet, toGate->getIndex());
+
+    PassiveQueueBase *queue = dynamic_cast<PassiveQueueBase*>(stage);
+    if (queue)
+        return queue->insertPacket(packet);
+
+    Sink *sink = dynamic_cast<Sink*>(stage);
+    if (sink)
+    {
+        sink->consumePacket(packet);
+        return false;
+    }
+
+    throw cRuntimeError("Cannot run module (%s)%s as a stage, it is not a classifier, meter, dropper, queue or sink known by the pipeline",
+                        stage->getClassName(), stage->getFullPath().c_str());
+}
+
+void DiffservQueuePipeline::requestPacket()
+{
+    Enter_Method("requestPacket()");
+
+    cMessage *msg = removePacket();
+    if (msg == NULL)
+        packetRequested++;
+    else
+        send(msg, outGate);
+}
+
+cMessage *DiffservQueuePipeline::removePacket()
+{
+    Enter_Method_Silent();
+
+    cMessage *msg = lastStage->removePacket();
+    if (msg)
+        take(msg);
+    return msg;
+}
+
+bool DiffservQueuePipeline::isEmpty()
+{
+    return lastStage->isEmpty();
+}
+
+void DiffservQueuePipeline::clear()
+{
+    lastStage->clear();
+    packetRequested = 0;
+}
+
+void DiffservQueuePipeline::addListener(IPassiveQueueListener *listener)
+{
+    std::list<IPassiveQueueListener*>::iterator it = find(listeners.begin(), listeners.end(), listener);
+    if (it == listeners.end())
+        listeners.push_back(listener);
+}
+
+void DiffservQueuePipeline::removeListener(IPassiveQueueListener *listener)
+{
+    std::list<IPassiveQueueListener*>::iterator it = find(listeners.begin(), listeners.end(), listener);
+    if (it != listeners.end())
+        listeners.erase(it);
+}
+
+void DiffservQueuePipeline::notifyListeners()
+{
+    for (std::list<IPassiveQueueListener*>::iterator it = listeners.begin(); it != listeners.end(); ++it)
+        (*it)->packetEnqueued(this);
+}
@@ -0,0 +1,66 @@
+//
+// Copyright (C) 2013 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __INET_DIFFSERVQUEUEPIPELINE_H
+#define __INET_DIFFSERVQUEUEPIPELINE_H
+
+#include "INETDefs.h"
+
+#include "IPassiveQueue.h"
+
+/**
+ * Runs the stages of a compound queue by method calls; see NED for more info.
+ */
+class INET_API DiffservQueuePipeline : public cSimpleModule, public IPassiveQueue
+{
+  protected:
+    cGate *stagesOutGate;
+    IPassiveQueue *lastStage;
+    cGate *outGate;
+
+    std::list<IPassiveQueueListener*> listeners;
+
+    // state
+    int packetRequested;
+
+  public:
+    DiffservQueuePipeline() : stagesOutGate(NULL), lastStage(NULL), outGate(NULL), packetRequested(0) {}
+
+  protected:
+    virtual void initialize();
+    virtual void handleMessage(cMessage *msg);
+
+    /**
+     * Passes the packet to the stage connected to the given output gate,
+     * and on to the following stages, until a queue stores it or a stage
+     * drops it. Returns false if it was dropped.
+     */
+    virtual bool deliverPacket(cPacket *packet, cGate *fromGate);
+
+    virtual void notifyListeners();
+
+  public:
+    virtual void requestPacket();
+    virtual cMessage *removePacket();
+    virtual int getNumPendingRequests() { return packetRequested; }
+    virtual bool isEmpty();
+    virtual void clear();
+    virtual void addListener(IPassiveQueueListener *listener);
+    virtual void removeListener(IPassiveQueueListener *listener);
+};
+
+#endif
@@ -16,6 +16,8 @@
 // along with this program; if not, see <http://www.gnu.org/licenses/>.
 //
 
+#include <algorithm>
+
 #include "INETDefs.h"
 #include "IPvXAddress.h"
 #include "IPvXAddressResolver.h"
@@ -81,6 +83,49 @@ bool MultiFieldClassifier::Filter::matches(IPv4Datagram *datagram)
 
     return true;
 }
+
+bool MultiFieldClassifier::Filter::toTreeRule(PacketClassifierTree::Rule& rule) const
+{
+    // datagrams without ports get the key value 65536, outside every port range of the filters
+    const uint32 fieldMax[] = { 0xffffffff, 0xffffffff, 0xff, 0x10000, 0x10000 };
+    for (int i = 0; i < PacketClassifierTree::NUM_FIELDS; i++)
+    {
+        rule.min[i] = 0;
+        rule.max[i] = fieldMax[i];
+    }
+
+    if (srcPrefixLength > 0)
+    {
+        if (srcAddr.isIPv6())
+            return false;   // can never match an IPv4 datagram
+        uint32 mask = IPv4Address::makeNetmask(std::min(srcPrefixLength, 32)).getInt();
+        rule.min[PacketClassifierTree::SRC_ADDR] = srcAddr.get4().getInt() & mask;
+        rule.max[PacketClassifierTree::SRC_ADDR] = rule.min[PacketClassifierTree::SRC_ADDR] | ~mask;
+    }
+    if (destPrefixLength > 0)
+    {
+        if (destAddr.isIPv6())
+            return false;
+        uint32 mask = IPv4Address::makeNetmask(std::min(destPrefixLength, 32)).getInt();
+        rule.min[PacketClassifierTree::DEST_ADDR] = destAddr.get4().getInt() & mask;
+        rule.max[PacketClassifierTree::DEST_ADDR] = rule.min[PacketClassifierTree::DEST_ADDR] | ~mask;
+    }
+    if (protocol >= 0)
+        rule.min[PacketClassifierTree::PROTOCOL] = rule.max[PacketClassifierTree::PROTOCOL] = protocol;
+    if (srcPortMin >= 0)
+    {
+        rule.min[PacketClassifierTree::SRC_PORT] = srcPortMin;
+        rule.max[PacketClassifierTree::SRC_PORT] = srcPortMax;
+    }
+    if (destPortMin >= 0)
+    {
+        rule.min[PacketClassifierTree::DEST_PORT] = destPortMin;
+        rule.max[PacketClassifierTree::DEST_PORT] = destPortMax;
+    }
+    // TOS bits under a mask are not a range, they are checked after the lookup
+    rule.exact = tosMask == 0;
+    return true;
+}
 #endif
 
 #ifdef WITH_IPv6
@@ -145,6 +190,10 @@ void MultiFieldClassifier::initialize(int stage)
     {
         cXMLElement *config = par("filters").xmlValue();
         configureFilters(config);
+
+        useDecisionTree = par("useDecisionTree");
+        if (useDecisionTree)
+            buildDecisionTree();
     }
 }
 
@@ -177,6 +226,8 @@ int MultiFieldClassifier::classifyPacket(cPacket *packet)
         IPv4Datagram *ipv4Datagram = dynamic_cast<IPv4Datagram*>(packet);
         if (ipv4Datagram)
         {
+            if (useDecisionTree)
+                return classifyByDecisionTree(ipv4Datagram);
             for (std::vector<Filter>::iterator it = filters.begin(); it != filters.end(); ++it)
                 if (it->matches(ipv4Datagram))
                     return it->gateIndex;
@@ -198,6 +249,74 @@ int MultiFieldClassifier::classifyPacket(cPacket *packet)
     return -1;
 }
 
+void MultiFieldClassifier::buildDecisionTree()
+{
+    ipv4Tree.clear();
+    ipv4TreeFilters.clear();
+#ifdef WITH_IPv4
+    ipv4Tree.setFieldMax(PacketClassifierTree::PROTOCOL, 0xff);
+    ipv4Tree.setFieldMax(PacketClassifierTree::SRC_PORT, 0x10000);
+    ipv4Tree.setFieldMax(PacketClassifierTree::DEST_PORT, 0x10000);
+    ipv4Tree.setParameters(par("treeLeafSize"), par("treeMaxCuts"), par("treeSpaceFactor").doubleValue(), par("treeMaxDepth"));
+
+    for (int i = 0; i < (int)filters.size(); i++)
+    {
+        PacketClassifierTree::Rule rule;
+        if (filters[i].toTreeRule(rule))
+        {
+            ipv4Tree.addRule(rule);
+            ipv4TreeFilters.push_back(i);
+        }
+    }
+    ipv4Tree.build();
+
+    EV << "Decision tree built from " << ipv4Tree.getNumRules() << " IPv4 filters: "
+       << ipv4Tree.getNumNodes() << " nodes, depth " << ipv4Tree.getDepth()
+       << ", " << ipv4Tree.getNumLeafRules() << " rule references in leaves\n";
+#endif
+}
+
+#ifdef WITH_IPv4
+int MultiFieldClassifier::classifyByDecisionTree(IPv4Datagram *datagram)
+{
+    uint32 key[PacketClassifierTree::NUM_FIELDS];
+    key[PacketClassifierTree::SRC_ADDR] = datagram->getSrcAddress().getInt();
+    key[PacketClassifierTree::DEST_ADDR] = datagram->getDestAddress().getInt();
+    key[PacketClassifierTree::PROTOCOL] = datagram->getTransportProtocol() & 0xff;
+    key[PacketClassifierTree::SRC_PORT] = key[PacketClassifierTree::DEST_PORT] = 0x10000;
+
+    // the transport header is looked up once, not by every filter
+    cPacket *packet = datagram->getEncapsulatedPacket();
+#ifdef WITH_UDP
+    UDPPacket *udpPacket = dynamic_cast<UDPPacket*>(packet);
+    if (udpPacket)
+    {
+        key[PacketClassifierTree::SRC_PORT] = udpPacket->getSourcePort();
+        key[PacketClassifierTree::DEST_PORT] = udpPacket->getDestinationPort();
+    }
+#endif
+#ifdef WITH_TCP_COMMON
+    TCPSegment *tcpSegment = dynamic_cast<TCPSegment*>(packet);
+    if (tcpSegment)
+    {
+        key[PacketClassifierTree::SRC_PORT] = tcpSegment->getSrcPort();
+        key[PacketClassifierTree::DEST_PORT] = tcpSegment->getDestPort();
+    }
+#endif
+
+    int tos = datagram->getTypeOfService();
+    int numCandidates;
+    const int *candidates = ipv4Tree.lookup(key, numCandidates);
+    for (int i = 0; i < numCandidates; i++)
+    {
+        const Filter& filter = filters[ipv4TreeFilters[candidates[i]]];
+        if (ipv4Tree.contains(candidates[i], key) && (filter.tosMask == 0 || (filter.tos & filter.tosMask) == (tos & filter.tosMask)))
+            return filter.gateIndex;
+    }
+    return -1;
+}
+#endif
+
 void MultiFieldClassifier::addFilter(const Filter &filter)
 {
     if (filter.gateIndex < 0 || filter.gateIndex >= numOutGates)
@@ -21,6 +21,7 @@
 #define __INET_MULTIFIELDCLASSIFIER_H
 
 #include "INETDefs.h"
+#include "PacketClassifierTree.h"
 
 /**
  * Absolute dropper.
@@ -49,6 +50,7 @@ class INET_API MultiFieldClassifier : public cSimpleModule
                        srcPortMin(-1), srcPortMax(-1), destPortMin(-1), destPortMax(-1)  {}
     #ifdef WITH_IPv4
             bool matches(IPv4Datagram *datagram);
+            bool toTreeRule(PacketClassifierTree::Rule& rule) const;
     #endif
     #ifdef WITH_IPv6
             bool matches(IPv6Datagram *datagram);
@@ -59,6 +61,10 @@ class INET_API MultiFieldClassifier : public cSimpleModule
     int numOutGates;
     std::vector<Filter> filters;
 
+    bool useDecisionTree;
+    PacketClassifierTree ipv4Tree;    // compiled from the filters that can match IPv4 datagrams
+    std::vector<int> ipv4TreeFilters; // tree rule index -> filter index
+
     int numRcvd;
 
     static simsignal_t pkClassSignal;
@@ -66,6 +72,10 @@ class INET_API MultiFieldClassifier : public cSimpleModule
   protected:
     void addFilter(const Filter &filter);
     void configureFilters(cXMLElement *config);
+    void buildDecisionTree();
+#ifdef WITH_IPv4
+    int classifyByDecisionTree(IPv4Datagram *datagram);
+#endif
 
   public:
     MultiFieldClassifier() {}
@@ -0,0 +1,228 @@
+//
+// Copyright (C) 2013 Opensim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <algorithm>
+
+#include "PacketClassifierTree.h"
+
+PacketClassifierTree::PacketClassifierTree()
+{
+    for (int i = 0; i < NUM_FIELDS; i++)
+        fieldMax[i] = 0xffffffff;
+    leafSize = 4;
+    maxCuts = 64;
+    spaceFactor = 2;
+    maxDepth = 12;
+    depth = 0;
+}
+
+void PacketClassifierTree::setParameters(int leafSize, int maxCuts, double spaceFactor, int maxDepth)
+{
+    if (leafSize < 1 || maxCuts < 2 || spaceFactor < 1 || maxDepth < 0)
+        throw cRuntimeError("PacketClassifierTree: invalid parameters");
+    this->leafSize = leafSize;
+    this->maxCuts = maxCuts;
+    this->spaceFactor = spaceFactor;
+    this->maxDepth = maxDepth;
+}
+
+void PacketClassifierTree::clear()
+{
+    rules.clear();
+    nodes.clear();
+    children.clear();
+    leafRules.clear();
+    depth = 0;
+}
+
+void PacketClassifierTree::build()
+{
+    nodes.clear();
+    children.clear();
+    leafRules.clear();
+    depth = 0;
+
+    Box box;
+    for (int i = 0; i < NUM_FIELDS; i++)
+    {
+        box.lo[i] = 0;
+        box.hi[i] = fieldMax[i];
+    }
+
+    std::vector<int> allRules, ruleIndices;
+    for (int i = 0; i < (int)rules.size(); i++)
+        allRules.push_back(i);
+    pruneRules(box, allRules, ruleIndices);
+
+    nodes.resize(1);
+    buildNode(0, box, ruleIndices, 0);
+}
+
+bool PacketClassifierTree::intersects(const Rule& rule, const Box& box) const
+{
+    for (int i = 0; i < NUM_FIELDS; i++)
+        if (rule.max[i] < box.lo[i] || rule.min[i] > box.hi[i])
+            return false;
+    return true;
+}
+
+bool PacketClassifierTree::covers(const Rule& rule, const Box& box) const
+{
+    for (int i = 0; i < NUM_FIELDS; i++)
+        if (rule.min[i] > box.lo[i] || rule.max[i] < box.hi[i])
+            return false;
+    return true;
+}
+
+void PacketClassifierTree::pruneRules(const Box& box, const std::vector<int>& ruleIndices, std::vector<int>& result) const
+{
+    result.clear();
+    for (std::vector<int>::const_iterator it = ruleIndices.begin(); it != ruleIndices.end(); ++it)
+    {
+        const Rule& rule = rules[*it];
+        if (intersects(rule, box))
+        {
+            result.push_back(*it);
+            // an exact rule covering the whole box matches every key in it,
+            // so the rules after it can never be the first match here
+            if (rule.exact && covers(rule, box))
+                break;
+        }
+    }
+}
+
+void PacketClassifierTree::getChildBox(const Box& box, int field, int numCuts, int i, Box& childBox) const
+{
+    // child i holds the keys for which (key - lo) * numCuts / span == i
+    uint64 span = (uint64)box.hi[field] - box.lo[field] + 1;
+    childBox = box;
+    childBox.lo[field] = box.lo[field] + (uint32)((i * span + numCuts - 1) / numCuts);
+    childBox.hi[field] = box.lo[field] + (uint32)(((i + 1) * span + numCuts - 1) / numCuts - 1);
+}
+
+void PacketClassifierTree::countChildRules(const Box& box, const std::vector<int>& ruleIndices, int field, int numCuts,
+                                           int& maxRules, int& totalRules) const
+{
+    uint32 lo = box.lo[field];
+    uint64 span = (uint64)box.hi[field] - lo + 1;
+    std::vector<int> delta(numCuts + 1, 0);
+    for (std::vector<int>::const_iterator it = ruleIndices.begin(); it != ruleIndices.end(); ++it)
+    {
+        const Rule& rule = rules[*it];
+        uint32 a = std::max(rule.min[field], lo);
+        uint32 b = std::min(rule.max[field], box.hi[field]);
+        delta[(int)((uint64)(a - lo) * numCuts / span)]++;
+        delta[(int)((uint64)(b - lo) * numCuts / span) + 1]--;
+    }
+    maxRules = totalRules = 0;
+    int count = 0;
+    for (int i = 0; i < numCuts; i++)
+    {
+        count += delta[i];
+        maxRules = std::max(maxRules, count);
+        totalRules += count;
+    }
+}
+
+void PacketClassifierTree::buildNode(int nodeIndex, const Box& box, const std::vector<int>& ruleIndices, int level)
+{
+    depth = std::max(depth, level);
+    int numRules = ruleIndices.size();
+
+    int bestField = -1, bestCuts = 0, bestMaxRules = numRules, bestTotalRules = 0;
+    if (numRules > leafSize && level < maxDepth)
+    {
+        for (int field = 0; field < NUM_FIELDS; field++)
+        {
+            uint64 span = (uint64)box.hi[field] - box.lo[field] + 1;
+            if (span < 2)
+                continue;
+
+            // double the number of cuts while the replicated rules fit into the space budget
+            int numCuts = 2, maxRules, totalRules;
+            countChildRules(box, ruleIndices, field, numCuts, maxRules, totalRules);
+            while (2 * numCuts <= maxCuts && (uint64)(2 * numCuts) <= span)
+            {
+                int nextMaxRules, nextTotalRules;
+                countChildRules(box, ruleIndices, field, 2 * numCuts, nextMaxRules, nextTotalRules);
+                if (nextTotalRules + 2 * numCuts > spaceFactor * numRules)
+                    break;
+                numCuts *= 2;
+                maxRules = nextMaxRules;
+                totalRules = nextTotalRules;
+            }
+
+            if (maxRules < bestMaxRules || (maxRules == bestMaxRules && bestField != -1 && totalRules < bestTotalRules))
+            {
+                bestField = field;
+                bestCuts = numCuts;
+                bestMaxRules = maxRules;
+                bestTotalRules = totalRules;
+            }
+        }
+    }
+
+    Node& node = nodes[nodeIndex];
+    if (bestField == -1)
+    {
+        // leaf: no cut would separate the rules
+        node.field = 0;
+        node.lo = 0;
+        node.span = 1;
+        node.numCuts = 0;
+        node.first = leafRules.size();
+        node.numRules = numRules;
+        leafRules.insert(leafRules.end(), ruleIndices.begin(), ruleIndices.end());
+        return;
+    }
+
+    node.field = bestField;
+    node.lo = box.lo[bestField];
+    node.span = (uint64)box.hi[bestField] - box.lo[bestField] + 1;
+    node.numCuts = bestCuts;
+    node.first = children.size();
+    node.numRules = 0;
+    children.resize(node.first + bestCuts);
+
+    // adjacent cuts with the same rules share one child covering their union
+    Box childBox, nextBox;
+    std::vector<int> childRules, nextRules;
+    int firstCut = 0;
+    getChildBox(box, bestField, bestCuts, 0, childBox);
+    pruneRules(childBox, ruleIndices, childRules);
+    for (int i = 1; i <= bestCuts; i++)
+    {
+        if (i < bestCuts)
+        {
+            getChildBox(box, bestField, bestCuts, i, nextBox);
+            pruneRules(nextBox, ruleIndices, nextRules);
+            if (nextRules == childRules)
+            {
+                childBox.hi[bestField] = nextBox.hi[bestField];
+                continue;
+            }
+        }
+        int childIndex = nodes.size();
+        nodes.resize(childIndex + 1);   // invalidates 'node'
+        for (int j = firstCut; j < i; j++)
+            children[nodes[nodeIndex].first + j] = childIndex;
+        buildNode(childIndex, childBox, childRules, level + 1);
+        firstCut = i;
+        childBox = nextBox;
+        childRules.swap(nextRules);
+    }
+}
@@ -0,0 +1,149 @@
+//
+// Copyright (C) 2013 Opensim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __INET_PACKETCLASSIFIERTREE_H
+#define __INET_PACKETCLASSIFIERTREE_H
+
+#include <vector>
+
+#include "INETDefs.h"
+
+/**
+ * HiCuts-style decision tree for multi-field packet classification.
+ *
+ * Rules are boxes in a NUM_FIELDS dimensional space, each field being an
+ * inclusive [min,max] range of 32-bit values. The tree recursively cuts the
+ * space into equal sized intervals along one field per level, until each
+ * leaf holds only a few rules. A lookup descends to the leaf containing the
+ * key and returns its candidate rules in their original order, so the caller
+ * keeps first-match semantics by checking the candidates in turn. Adjacent
+ * cuts with the same candidate rules share a child node, and rules hidden
+ * behind an earlier rule covering a whole node are dropped. Criteria
+ * that cannot be expressed as ranges (e.g. masked TOS bits) are left to
+ * that final check; such rules must be added with exact=false.
+ */
+class INET_API PacketClassifierTree
+{
+  public:
+    enum Field { SRC_ADDR, DEST_ADDR, PROTOCOL, SRC_PORT, DEST_PORT, NUM_FIELDS };
+
+    struct Rule
+    {
+        uint32 min[NUM_FIELDS];
+        uint32 max[NUM_FIELDS];
+        bool exact;     // true if the box describes the rule completely
+    };
+
+  protected:
+    struct Node
+    {
+        int field;      // field cut at this node
+        uint32 lo;      // lower end of the field's range at this node
+        uint64 span;    // number of values in that range
+        int numCuts;    // 0 for leaves
+        int first;      // index into 'children' (inner nodes) or 'leafRules' (leaves)
+        int numRules;   // number of rule indices (leaves)
+    };
+
+    struct Box
+    {
+        uint32 lo[NUM_FIELDS];
+        uint32 hi[NUM_FIELDS];
+    };
+
+    std::vector<Rule> rules;
+    std::vector<Node> nodes;
+    std::vector<int> children;      // node index of each cut of the inner nodes
+    std::vector<int> leafRules;
+    uint32 fieldMax[NUM_FIELDS];
+    int leafSize;
+    int maxCuts;
+    double spaceFactor;
+    int maxDepth;
+    int depth;
+
+  protected:
+    void buildNode(int nodeIndex, const Box& box, const std::vector<int>& ruleIndices, int level);
+    void pruneRules(const Box& box, const std::vector<int>& ruleIndices, std::vector<int>& result) const;
+    bool intersects(const Rule& rule, const Box& box) const;
+    bool covers(const Rule& rule, const Box& box) const;
+    void getChildBox(const Box& box, int field, int numCuts, int i, Box& childBox) const;
+    void countChildRules(const Box& box, const std::vector<int>& ruleIndices, int field, int numCuts, int& maxRules, int& totalRules) const;
+
+  public:
+    PacketClassifierTree();
+
+    /**
+     * Sets the largest value of each field; keys passed to lookup() must
+     * stay within [0,fieldMax]. Must be called before build().
+     */
+    void setFieldMax(int field, uint32 value) { fieldMax[field] = value; }
+
+    /**
+     * Sets the tuning parameters: the number of rules below which a node is
+     * not cut further, the maximum number of cuts per node, the space factor
+     * limiting rule replication, and the maximum depth of the tree.
+     */
+    void setParameters(int leafSize, int maxCuts, double spaceFactor, int maxDepth);
+
+    /**
+     * Appends a rule; rules are numbered from 0 in the order of addition.
+     */
+    void addRule(const Rule& rule) { rules.push_back(rule); }
+
+    /**
+     * Builds the tree from the rules added so far.
+     */
+    void build();
+
+    /**
+     * Removes all rules and the tree.
+     */
+    void clear();
+
+    /**
+     * Returns the rules that may match the key, in ascending order.
+     * The key must contain NUM_FIELDS values.
+     */
+    const int *lookup(const uint32 *key, int& numCandidates) const
+    {
+        const Node *node = &nodes[0];
+        while (node->numCuts)
+            node = &nodes[children[node->first + (int)((uint64)(key[node->field] - node->lo) * node->numCuts / node->span)]];
+        numCandidates = node->numRules;
+        return numCandidates ? &leafRules[node->first] : NULL;
+    }
+
+    /**
+     * Returns true if the key falls into the box of the rule.
+     */
+    bool contains(int ruleIndex, const uint32 *key) const
+    {
+        const Rule& rule = rules[ruleIndex];
+        for (int i = 0; i < NUM_FIELDS; i++)
+            if (key[i] < rule.min[i] || key[i] > rule.max[i])
+                return false;
+        return true;
+    }
+
+    int getNumRules() const { return rules.size(); }
+    int getNumNodes() const { return nodes.size(); }
+    int getNumLeafRules() const { return leafRules.size(); }
+    int getDepth() const { return depth; }
+};
+
+#endif
@@ -45,21 +45,25 @@ void TokenBucketMeter::initialize(int stage)
 
 void TokenBucketMeter::handleMessage(cMessage *msg)
 {
-    cPacket *packet = findIPDatagramInPacket(check_and_cast<cPacket*>(msg));
-    if (!packet)
+    cPacket *packet = check_and_cast<cPacket*>(msg);
+    if (processPacket(packet) == GREEN)
+        send(packet, "greenOut");
+    else
+        send(packet, "redOut");
+}
+
+int TokenBucketMeter::processPacket(cPacket *packet)
+{
+    Enter_Method_Silent();
+
+    cPacket *ipPacket = findIPDatagramInPacket(packet);
+    if (!ipPacket)
         error("TokenBucketMeter received a packet that does not encapsulate an IP datagram.");
 
     numRcvd++;
-    int color = meterPacket(packet);
-    if (color == GREEN)
-    {
-        send(packet, "greenOut");
-    }
-    else
-    {
+    int color = meterPacket(ipPacket);
+    if (color != GREEN)
         numRed++;
-        send(packet, "redOut");
-    }
 
     if (ev.isGUI())
     {
@@ -68,6 +72,8 @@ void TokenBucketMeter::handleMessage(cMessage *msg)
         if (numRed>0) sprintf(buf+strlen(buf), "red:%d ", numRed);
         getDisplayString().setTagArg("t", 0, buf);
     }
+
+    return color;
 }
 
 int TokenBucketMeter::meterPacket(cPacket *packet)
@@ -50,6 +50,14 @@ class INET_API TokenBucketMeter : public cSimpleModule
     virtual void handleMessage(cMessage *msg);
 
     virtual int meterPacket(cPacket *packet);
+
+  public:
+    /**
+     * Meters the packet as if it had arrived on an input gate, and returns
+     * its color (GREEN or RED) instead of sending it; used when the meter
+     * is run in process (see DiffservQueuePipeline).
+     */
+    virtual int processPacket(cPacket *packet);
 };
 
 #endif
@@ -21,6 +21,7 @@
 
 #include "IPv4.h"
 
+#include "ARP.h"
 #include "ARPPacket_m.h"
 #include "ICMPMessage_m.h"
 #include "InterfaceTableAccess.h"
@@ -28,6 +29,11 @@
 #include "IPv4Datagram.h"
 #include "IPv4InterfaceData.h"
 #include "IRoutingTable.h"
+#include "NotificationBoard.h"
+
+#ifdef WITH_TCP_COMMON
+#include "TCPSegmentationOffload.h"
+#endif
 
 
 Define_Module(IPv4);
@@ -39,8 +45,11 @@ void IPv4::initialize()
 
     ift = InterfaceTableAccess().get();
     rt = RoutingTableAccess().get();
+    nb = NotificationBoardAccess().get();
 
     queueOutGate = gate("queueOut");
+    cGate *arpGate = queueOutGate->getPathEndGate();
+    arp = dynamic_cast<ARP *>(arpGate->getOwnerModule());
 
     defaultTimeToLive = par("timeToLive");
     defaultMCTimeToLive = par("multicastTimeToLive");
@@ -49,16 +58,35 @@ void IPv4::initialize()
     mapping.parseProtocolMapping(par("protocolMapping"));
 
     curFragmentId = 0;
-    lastCheckTime = 0;
     fragbuf.init(icmpAccess.get());
 
     numMulticast = numLocalDeliver = numDropped = numUnroutable = numForwarded = 0;
+    numFlowCacheHits = numFlowCacheMisses = 0;
+
+    int flowCacheSize = par("flowCacheSize");
+    if (flowCacheSize < 0 || (flowCacheSize & (flowCacheSize - 1)) != 0)
+        error("flowCacheSize must be zero or a power of two");
+    flowCache.resize(flowCacheSize);
+    clearFlowCache();
+
+    // the flow cache must be cleared whenever the forwarding decisions may change
+    nb->subscribe(this, NF_INTERFACE_CREATED);
+    nb->subscribe(this, NF_INTERFACE_DELETED);
+    nb->subscribe(this, NF_INTERFACE_STATE_CHANGED);
+    nb->subscribe(this, NF_INTERFACE_CONFIG_CHANGED);
+    nb->subscribe(this, NF_INTERFACE_IPv4CONFIG_CHANGED);
+    nb->subscribe(this, NF_IPv4_ROUTE_ADDED);
+    nb->subscribe(this, NF_IPv4_ROUTE_DELETED);
+    nb->subscribe(this, NF_IPv4_ROUTE_CHANGED);
+    nb->subscribe(this, NF_ARP_CACHE_CHANGED);
 
     WATCH(numMulticast);
     WATCH(numLocalDeliver);
     WATCH(numDropped);
     WATCH(numUnroutable);
     WATCH(numForwarded);
+    WATCH(numFlowCacheHits);
+    WATCH(numFlowCacheMisses);
 
     // by default no MANET routing
     manetRouting = false;
@@ -98,6 +126,14 @@ void IPv4::updateDisplayString()
     getDisplayString().setTagArg("t", 0, buf);
 }
 
+void IPv4::receiveChangeNotification(int category, const cObject *details)
+{
+    Enter_Method_Silent();
+
+    // any route, interface or ARP change may invalidate the cached forwarding decisions
+    clearFlowCache();
+}
+
 void IPv4::endService(cPacket *msg)
 {
     if (msg->getArrivalGate()->isName("transportIn"))
@@ -193,7 +229,7 @@ void IPv4::handlePacketFromNetwork(IPv4Datagram *datagram, InterfaceEntry *fromI
 
         // check for local delivery; we must accept also packets coming from the interfaces that
         // do not yet have an IP address assigned. This happens during DHCP requests.
-        if (rt->isLocalAddress(destAddr) || fromIE->ipv4Data()->getIPAddress().isUnspecified())
+        if (rt->isLocalAddressDirect(destAddr) || fromIE->ipv4Data()->getIPAddress().isUnspecified())
         {
             reassembleAndDeliver(datagram);
         }
@@ -339,7 +375,7 @@ void IPv4::handleMessageFromHL(cPacket *msg)
             sendRouteUpdateMessageToManet(datagram);
 #endif
         // check for local delivery
-        if (rt->isLocalAddress(destAddr))
+        if (rt->isLocalAddressDirect(destAddr))
         {
             EV << "local delivery\n";
             if (destIE)
@@ -401,6 +437,7 @@ void IPv4::routeUnicastPacket(IPv4Datagram *datagram, InterfaceEntry *destIE, IP
     EV << "Routing datagram `" << datagram->getName() << "' with dest=" << destAddr << ": ";
 
     IPv4Address nextHopAddr;
+    MACAddress nextHopMacAddr;
     // if output port was explicitly requested, use that, otherwise use IPv4 routing
     if (destIE)
     {
@@ -419,13 +456,8 @@ void IPv4::routeUnicastPacket(IPv4Datagram *datagram, InterfaceEntry *destIE, IP
     }
     else
     {
-        // use IPv4 routing (lookup in routing table)
-        const IPv4Route *re = rt->findBestMatchingRoute(destAddr);
-        if (re)
-        {
-            destIE = re->getInterface();
-            nextHopAddr = re->getGateway();
-        }
+        // use the flow cache, or IPv4 routing (lookup in routing table)
+        lookupFlow(datagram, destIE, nextHopAddr, nextHopMacAddr);
     }
 
     if (!destIE) // no route found
@@ -447,10 +479,73 @@ void IPv4::routeUnicastPacket(IPv4Datagram *datagram, InterfaceEntry *destIE, IP
     {
         EV << "output interface is " << destIE->getName() << ", next-hop address: " << nextHopAddr << "\n";
         numForwarded++;
-        fragmentAndSend(datagram, destIE, nextHopAddr);
+        fragmentAndSend(datagram, destIE, nextHopAddr, nextHopMacAddr);
     }
 }
 
+bool IPv4::lookupFlow(IPv4Datagram *datagram, InterfaceEntry *&destIE, IPv4Address& nextHopAddr, MACAddress& nextHopMacAddr)
+{
+    IPv4Address destAddr = datagram->getDestAddress();
+    unsigned char tos = datagram->getTypeOfService();
+    if (flowCache.empty())
+    {
+        const IPv4Route *re = rt->findBestMatchingRouteDirect(destAddr);
+        if (!re)
+            return false;
+        destIE = re->getInterface();
+        nextHopAddr = re->getGateway();
+        return destIE != NULL;
+    }
+
+    FlowCacheEntry& entry = getFlowCacheEntry(destAddr, tos);
+    // routes may expire without a notification (see IPv4Route::isValid()), so check it on every hit
+    if (entry.route && entry.destAddr == destAddr && entry.tos == tos && entry.route->isValid())
+        numFlowCacheHits++;
+    else
+    {
+        numFlowCacheMisses++;
+        entry.route = NULL;
+        const IPv4Route *re = rt->findBestMatchingRouteDirect(destAddr);
+        if (!re || !re->getInterface())
+            return false;  // not cached: a route may be added on demand (e.g. by MANET routing)
+        entry.destAddr = destAddr;
+        entry.tos = tos;
+        entry.route = re;
+        entry.ie = re->getInterface();
+        entry.nextHopAddr = re->getGateway();
+        entry.nextHopMacAddr = MACAddress::UNSPECIFIED_ADDRESS;
+    }
+    destIE = entry.ie;
+    nextHopAddr = entry.nextHopAddr;
+
+    // ARP result: asked for until ARP has resolved the next hop, then used until its cache entry times out
+    if (arp && destIE->isBroadcast())
+    {
+        if (!entry.nextHopMacAddr.isUnspecified() && entry.macExpiryTime <= simTime())
+            entry.nextHopMacAddr = MACAddress::UNSPECIFIED_ADDRESS;
+        if (entry.nextHopMacAddr.isUnspecified())
+        {
+            IPv4Address arpAddr = nextHopAddr.isUnspecified() ? destAddr : nextHopAddr;
+            entry.nextHopMacAddr = arp->getResolvedAddress(arpAddr, destIE, entry.macExpiryTime);
+        }
+        nextHopMacAddr = entry.nextHopMacAddr;
+    }
+    return true;
+}
+
+IPv4::FlowCacheEntry& IPv4::getFlowCacheEntry(const IPv4Address& destAddr, unsigned char tos)
+{
+    // Fibonacci hashing, as in ReassemblyTable
+    uint64 h = (uint64)(destAddr.getInt() * 31 + tos) * (uint64)0x9E3779B97F4A7C15ULL;
+    return flowCache[(size_t)(h >> 32) & (flowCache.size() - 1)];
+}
+
+void IPv4::clearFlowCache()
+{
+    for (FlowCache::iterator it = flowCache.begin(); it != flowCache.end(); ++it)
+        it->route = NULL;
+}
+
 void IPv4::routeLocalBroadcastPacket(IPv4Datagram *datagram, InterfaceEntry *destIE)
 {
     // The destination address is 255.255.255.255 or local subnet broadcast address.
@@ -553,12 +648,8 @@ void IPv4::reassembleAndDeliver(IPv4Datagram *datagram)
         EV << "Datagram fragment: offset=" << datagram->getFragmentOffset()
            << ", MORE=" << (datagram->getMoreFragments() ? "true" : "false") << ".\n";
 
-        // erase timed out fragments in fragmentation buffer; check every 10 seconds max
-        if (simTime() >= lastCheckTime + 10)
-        {
-            lastCheckTime = simTime();
-            fragbuf.purgeStaleFragments(simTime()-fragmentTimeoutTime);
-        }
+        // erase timed out fragments in fragmentation buffer (only visits the stale ones)
+        fragbuf.purgeStaleFragments(simTime()-fragmentTimeoutTime);
 
         datagram = fragbuf.addFragment(datagram, simTime());
         if (!datagram)
@@ -636,7 +727,7 @@ cPacket *IPv4::decapsulate(IPv4Datagram *datagram)
     return packet;
 }
 
-void IPv4::fragmentAndSend(IPv4Datagram *datagram, InterfaceEntry *ie, IPv4Address nextHopAddr)
+void IPv4::fragmentAndSend(IPv4Datagram *datagram, InterfaceEntry *ie, IPv4Address nextHopAddr, const MACAddress& nextHopMacAddr)
 {
     // fill in source address
     if (datagram->getSrcAddress().isUnspecified())
@@ -661,9 +752,20 @@ void IPv4::fragmentAndSend(IPv4Datagram *datagram, InterfaceEntry *ie, IPv4Addre
     // check if datagram does not require fragmentation
     if (datagram->getByteLength() <= mtu)
     {
-        sendDatagramToOutput(datagram, ie, nextHopAddr);
+        sendDatagramToOutput(datagram, ie, nextHopAddr, nextHopMacAddr);
+        return;
+    }
+
+#ifdef WITH_TCP_COMMON
+    // TCP super-segments are not fragmented if the interface supports segmentation
+    // offload and their segments fit into the MTU: the link layer transmits them
+    // as separate frames. Otherwise they are fragmented like any other datagram.
+    if (ie->hasSegmentationOffload() && TCPSegmentationOffload::getSegmentByteLength(datagram) <= mtu)
+    {
+        sendDatagramToOutput(datagram, ie, nextHopAddr, nextHopMacAddr);
         return;
     }
+#endif
 
     // if "don't fragment" bit is set, throw datagram away and send ICMP error message
     if (datagram->getDontFragment())
@@ -678,7 +780,7 @@ void IPv4::fragmentAndSend(IPv4Datagram *datagram, InterfaceEntry *ie, IPv4Addre
     // optimization: do not fragment and reassemble on the loopback interface
     if (ie->isLoopback())
     {
-        sendDatagramToOutput(datagram, ie, nextHopAddr);
+        sendDatagramToOutput(datagram, ie, nextHopAddr, nextHopMacAddr);
         return;
     }
 
@@ -713,7 +815,7 @@ void IPv4::fragmentAndSend(IPv4Datagram *datagram, InterfaceEntry *ie, IPv4Addre
         fragment->setByteLength(headerLength + thisFragmentLength);
         fragment->setFragmentOffset(offsetBase + offset);
 
-        sendDatagramToOutput(fragment, ie, nextHopAddr);
+        sendDatagramToOutput(fragment, ie, nextHopAddr, nextHopMacAddr);
     }
 
     delete datagram;
@@ -773,7 +875,7 @@ IPv4Datagram *IPv4::createIPv4Datagram(const char *name)
     return new IPv4Datagram(name);
 }
 
-void IPv4::sendDatagramToOutput(IPv4Datagram *datagram, InterfaceEntry *ie, IPv4Address nextHopAddr)
+void IPv4::sendDatagramToOutput(IPv4Datagram *datagram, InterfaceEntry *ie, IPv4Address nextHopAddr, const MACAddress& nextHopMacAddr)
 {
     if (ie->isLoopback())
     {
@@ -788,6 +890,7 @@ void IPv4::sendDatagramToOutput(IPv4Datagram *datagram, InterfaceEntry *ie, IPv4
         IPv4RoutingDecision *routingDecision = new IPv4RoutingDecision();
         routingDecision->setInterfaceId(ie->getInterfaceId());
         routingDecision->setNextHopAddr(nextHopAddr);
+        routingDecision->setNextHopMacAddr(nextHopMacAddr);
         datagram->setControlInfo(routingDecision);
         send(datagram, queueOutGate);
     }
@@ -20,8 +20,12 @@
 
 #include "INETDefs.h"
 
+#include <vector>
+
 #include "ICMPAccess.h"
+#include "INotifiable.h"
 #include "IPv4FragBuf.h"
+#include "MACAddress.h"
 #include "ProtocolMap.h"
 #include "QueueBase.h"
 
@@ -30,11 +34,14 @@
 #endif
 
 
+class ARP;
 class ARPPacket;
 class ICMPMessage;
 class IInterfaceTable;
 class IPv4Datagram;
+class IPv4Route;
 class IRoutingTable;
+class NotificationBoard;
 
 // ICMP type 2, code 4: fragmentation needed, but don't-fragment bit set
 const int ICMP_FRAGMENTATION_ERROR_CODE = 4;
@@ -43,11 +50,27 @@ const int ICMP_FRAGMENTATION_ERROR_CODE = 4;
 /**
  * Implements the IPv4 protocol.
  */
-class INET_API IPv4 : public QueueBase
+class INET_API IPv4 : public QueueBase, public INotifiable
 {
+  protected:
+    // per-flow forwarding decision, keyed on (destination address, ToS)
+    struct FlowCacheEntry
+    {
+        IPv4Address destAddr;
+        unsigned char tos;
+        const IPv4Route *route;  // the route the decision was made from; NULL if the entry is empty
+        InterfaceEntry *ie;
+        IPv4Address nextHopAddr;
+        MACAddress nextHopMacAddr;  // unspecified until ARP has resolved it
+        simtime_t macExpiryTime;  // when the ARP cache entry of nextHopMacAddr times out
+    };
+    typedef std::vector<FlowCacheEntry> FlowCache;
+
   protected:
     IRoutingTable *rt;
     IInterfaceTable *ift;
+    NotificationBoard *nb;
+    ARP *arp;  // the ARP module at queueOut, or NULL
     ICMPAccess icmpAccess;
     cGate *queueOutGate; // the most frequently used output gate
     bool manetRouting;
@@ -61,8 +84,8 @@ class INET_API IPv4 : public QueueBase
     // working vars
     long curFragmentId; // counter, used to assign unique fragmentIds to datagrams
     IPv4FragBuf fragbuf;  // fragmentation reassembly buffer
-    simtime_t lastCheckTime; // when fragbuf was last checked for state fragments
     ProtocolMapping mapping; // where to send packets after decapsulation
+    FlowCache flowCache;  // direct-mapped; cleared on route, interface and ARP changes
 
     // statistics
     int numMulticast;
@@ -70,6 +93,8 @@ class INET_API IPv4 : public QueueBase
     int numDropped;  // forwarding off, no outgoing interface, too large but "don't fragment" is set, TTL exceeded, etc
     int numUnroutable;
     int numForwarded;
+    long numFlowCacheHits;
+    long numFlowCacheMisses;
 
 
   protected:
@@ -122,6 +147,25 @@ class INET_API IPv4 : public QueueBase
      */
     virtual void routeUnicastPacket(IPv4Datagram *datagram, InterfaceEntry *destIE, IPv4Address nextHopAddr);
 
+    /**
+     * Returns the output interface, next hop and (if already resolved by
+     * ARP) the next hop MAC address for the given datagram. They are taken
+     * from the flow cache if it has a valid decision for the destination
+     * and ToS of the datagram, otherwise from the routing table.
+     * Returns false if there is no route to the destination.
+     */
+    virtual bool lookupFlow(IPv4Datagram *datagram, InterfaceEntry *&destIE, IPv4Address& nextHopAddr, MACAddress& nextHopMacAddr);
+
+    /**
+     * Returns the flow cache entry for the given destination and ToS.
+     */
+    virtual FlowCacheEntry& getFlowCacheEntry(const IPv4Address& destAddr, unsigned char tos);
+
+    /**
+     * Empties the flow cache.
+     */
+    virtual void clearFlowCache();
+
     /**
      * Broadcasts the datagram on the specified interface.
      * When destIE is NULL, the datagram is broadcasted on each interface.
@@ -151,14 +195,17 @@ class INET_API IPv4 : public QueueBase
 
     /**
      * Fragment packet if needed, then send it to the selected interface using
-     * sendDatagramToOutput().
+     * sendDatagramToOutput(). If nextHopMacAddr is specified, ARP sends the
+     * datagram to it without looking up its cache.
      */
-    virtual void fragmentAndSend(IPv4Datagram *datagram, InterfaceEntry *ie, IPv4Address nextHopAddr);
+    virtual void fragmentAndSend(IPv4Datagram *datagram, InterfaceEntry *ie, IPv4Address nextHopAddr,
+            const MACAddress& nextHopMacAddr = MACAddress::UNSPECIFIED_ADDRESS);
 
     /**
      * Last TTL check, then send datagram on the given interface.
      */
-    virtual void sendDatagramToOutput(IPv4Datagram *datagram, InterfaceEntry *ie, IPv4Address nextHopAddr);
+    virtual void sendDatagramToOutput(IPv4Datagram *datagram, InterfaceEntry *ie, IPv4Address nextHopAddr,
+            const MACAddress& nextHopMacAddr = MACAddress::UNSPECIFIED_ADDRESS);
 
 #ifdef WITH_MANET
     /**
@@ -184,7 +231,7 @@ class INET_API IPv4 : public QueueBase
 #endif
 
   public:
-    IPv4() {}
+    IPv4() {rt = NULL; ift = NULL; nb = NULL; arp = NULL;}
 
   protected:
     /**
@@ -197,6 +244,11 @@ class INET_API IPv4 : public QueueBase
      * of the queue.
      */
     virtual void endService(cPacket *msg);
+
+    /**
+     * Called by the NotificationBoard whenever a change occurs we're interested in.
+     */
+    virtual void receiveChangeNotification(int category, const cObject *details);
 };
 
 #endif
@@ -23,6 +23,7 @@
 
 #include "ICMP.h"
 #include "IPv4Datagram.h"
+#include "ECN_m.h"
 
 
 IPv4FragBuf::IPv4FragBuf()
@@ -34,10 +35,8 @@ IPv4FragBuf::~IPv4FragBuf()
 {
     while (!bufs.empty())
     {
-        if (bufs.begin()->second.datagram)
-            delete bufs.begin()->second.datagram;
-
-        bufs.erase(bufs.begin());
+        delete bufs.getOldest()->buf.datagram;
+        bufs.remove(bufs.getOldest());
     }
 }
 
@@ -54,28 +53,28 @@ IPv4Datagram *IPv4FragBuf::addFragment(IPv4Datagram *datagram, simtime_t now)
     key.src = datagram->getSrcAddress();
     key.dest = datagram->getDestAddress();
 
-    Buffers::iterator i = bufs.find(key);
-
-    DatagramBuffer *buf = NULL;
+    Buffers::Entry *entry = bufs.find(key);
 
-    if (i == bufs.end())
+    if (!entry)
     {
         // this is the first fragment of that datagram, create reassembly buffer for it
-        buf = &bufs[key];
-        buf->datagram = NULL;
-    }
-    else
-    {
-        // use existing buffer
-        buf = &(i->second);
+        entry = bufs.insert(key, now);
     }
 
+    DatagramBuffer *buf = &entry->buf;
+
     // add fragment into reassembly buffer
     int bytes = datagram->getByteLength() - datagram->getHeaderLength();
     bool isComplete = buf->buf.addFragment(datagram->getFragmentOffset(),
                                            datagram->getFragmentOffset() + bytes,
                                            !datagram->getMoreFragments());
 
+    // RFC 3168, section 5.3: "if any of the fragments are received with
+    // the CE codepoint set, the reassembled packet MUST have the CE
+    // codepoint set"
+    if (datagram->getExplicitCongestionNotification() == IP_ECN_CE)
+        buf->ceMarked = true;
+
     // store datagram. Only one fragment carries the actual modelled
     // content (getEncapsulatedPacket()), other (empty) ones are only
     // preserved so that we can send them in ICMP if reassembly times out.
@@ -101,45 +100,35 @@ IPv4Datagram *IPv4FragBuf::addFragment(IPv4Datagram *datagram, simtime_t now)
         ret->setByteLength(ret->getHeaderLength()+buf->buf.getTotalLength());
         ret->setFragmentOffset(0);
         ret->setMoreFragments(false);
-        bufs.erase(i);
+        if (buf->ceMarked)
+            ret->setExplicitCongestionNotification(IP_ECN_CE);
+        bufs.remove(entry);
         return ret;
     }
     else
     {
         // there are still missing fragments
-        buf->lastupdate = now;
+        bufs.touch(entry, now);
         return NULL;
     }
 }
 
 void IPv4FragBuf::purgeStaleFragments(simtime_t lastupdate)
 {
-    // this method shouldn't be called too often because iteration on
-    // an std::map is *very* slow...
-
+    // the buffers are ordered by their last update, so the stale ones are at the front
     ASSERT(icmpModule);
 
-    for (Buffers::iterator i = bufs.begin(); i != bufs.end(); )
+    while (!bufs.empty() && bufs.getOldest()->timestamp < lastupdate)
     {
-        // if too old, remove it
-        DatagramBuffer& buf = i->second;
-        if (buf.lastupdate < lastupdate)
-        {
-            // send ICMP error.
-            // Note: receiver MUST NOT call decapsulate() on the datagram fragment,
-            // because its length (being a fragment) is smaller than the encapsulated
-            // packet, resulting in "length became negative" error. Use getEncapsulatedPacket().
-            EV << "datagram fragment timed out in reassembly buffer, sending ICMP_TIME_EXCEEDED\n";
-            icmpModule->sendErrorMessage(buf.datagram, ICMP_TIME_EXCEEDED, 0);
-
-            // delete
-            Buffers::iterator oldi = i++;
-            bufs.erase(oldi);
-        }
-        else
-        {
-            ++i;
-        }
+        // send ICMP error.
+        // Note: receiver MUST NOT call decapsulate() on the datagram fragment,
+        // because its length (being a fragment) is smaller than the encapsulated
+        // packet, resulting in "length became negative" error. Use getEncapsulatedPacket().
+        Buffers::Entry *entry = bufs.getOldest();
+        EV << "datagram fragment timed out in reassembly buffer, sending ICMP_TIME_EXCEEDED\n";
+        icmpModule->sendErrorMessage(entry->buf.datagram, ICMP_TIME_EXCEEDED, 0);
+
+        // delete
+        bufs.remove(entry);
     }
 }
-
@@ -19,12 +19,11 @@
 #define __INET_IPv4FRAGBUF_H
 
 
-#include <map>
-
 #include "INETDefs.h"
 
 #include "IPv4Address.h"
 #include "ReassemblyBuffer.h"
+#include "ReassemblyTable.h"
 
 
 class ICMP;
@@ -46,23 +45,29 @@ class INET_API IPv4FragBuf
         IPv4Address src;
         IPv4Address dest;
 
-        inline bool operator<(const Key& b) const {
-            return (id!=b.id) ? (id<b.id) : (src!=b.src) ? (src<b.src) : (dest<b.dest);
+        inline bool operator==(const Key& b) const {
+            return id==b.id && src==b.src && dest==b.dest;
+        }
+        inline uint32 hash() const {
+            return (src.getInt() * 31 + dest.getInt()) * 31 + id;
         }
     };
 
     //
-    // Reassembly buffer for the datagram
+    // Reassembly buffer for the datagram; the last time a new fragment
+    // arrived is the timestamp of its entry in the table
     //
     struct DatagramBuffer
     {
         ReassemblyBuffer buf;  // reassembly buffer
         IPv4Datagram *datagram;  // the actual datagram
-        simtime_t lastupdate;  // last time a new fragment arrived
+        bool ceMarked;  // set if any fragment carried the ECN CE codepoint
+
+        DatagramBuffer() : datagram(NULL), ceMarked(false) {}
     };
 
-    // we use std::map for fast lookup by datagram Id
-    typedef std::map<Key,DatagramBuffer> Buffers;
+    // hash table for fast lookup by datagram Id, with the buffers in the order of their last update
+    typedef ReassemblyTable<Key,DatagramBuffer> Buffers;
 
     // the reassembly buffers
     Buffers bufs;
@@ -100,8 +105,8 @@ class INET_API IPv4FragBuf
      * and sends ICMP TIME EXCEEDED message about them.
      *
      * Timeout should be between 60 seconds and 120 seconds (RFC1122).
-     * This method should be called more frequently, maybe every
-     * 10..30 seconds or so.
+     * This method only visits the buffers it throws out, so it may be
+     * called on every fragment arrival.
      */
     void purgeStaleFragments(simtime_t lastupdate);
 };
@@ -129,6 +129,23 @@ class INET_API IRoutingTable
     virtual IPv4Address getGatewayForDestAddr(const IPv4Address& dest) const = 0;
     //@}
 
+    /** @name Lookups for the forwarding path */
+    //@{
+    /**
+     * Same as isLocalAddress(), but without Enter_Method. To be called by
+     * the network layer for every datagram, where the context switch and
+     * formatting the method call for the animation would cost more than
+     * the (cached) lookup itself.
+     */
+    virtual bool isLocalAddressDirect(const IPv4Address& dest) const = 0;
+
+    /**
+     * Same as findBestMatchingRoute(), but without Enter_Method; see
+     * isLocalAddressDirect().
+     */
+    virtual IPv4Route *findBestMatchingRouteDirect(const IPv4Address& dest) const = 0;
+    //@}
+
     /** @name Multicast routing functions */
     //@{
 
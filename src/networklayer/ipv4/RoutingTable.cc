@@ -187,6 +187,8 @@ void RoutingTable::receiveChangeNotification(int category, const cObject *detail
         // remove all routes that point to that interface
         InterfaceEntry *entry = check_and_cast<InterfaceEntry*>(details);
         deleteInterfaceRoutes(entry);
+        // the caches may refer to the interface even if no route did
+        invalidateCache();
     }
     else if (category==NF_INTERFACE_STATE_CHANGED)
     {
@@ -378,6 +380,11 @@ bool RoutingTable::isLocalAddress(const IPv4Address& dest) const
 {
     Enter_Method("isLocalAddress(%u.%u.%u.%u)", dest.getDByte(0), dest.getDByte(1), dest.getDByte(2), dest.getDByte(3)); // note: str().c_str() too slow here
 
+    return isLocalAddressDirect(dest);
+}
+
+bool RoutingTable::isLocalAddressDirect(const IPv4Address& dest) const
+{
     if (localAddresses.empty())
     {
         // collect interface addresses if not yet done
@@ -397,35 +404,27 @@ bool RoutingTable::isLocalBroadcastAddress(const IPv4Address& dest) const
 {
     Enter_Method("isLocalBroadcastAddress(%u.%u.%u.%u)", dest.getDByte(0), dest.getDByte(1), dest.getDByte(2), dest.getDByte(3)); // note: str().c_str() too slow here
 
+    return findInterfaceByLocalBroadcastAddress(dest) != NULL;
+}
+
+InterfaceEntry *RoutingTable::findInterfaceByLocalBroadcastAddress(const IPv4Address& dest) const
+{
     if (localBroadcastAddresses.empty())
     {
-        // collect interface addresses if not yet done
+        // collect interface addresses if not yet done; if several interfaces
+        // have the same broadcast address, the first one is kept
         for (int i=0; i<ift->getNumInterfaces(); i++)
         {
-            IPv4Address interfaceAddr = ift->getInterface(i)->ipv4Data()->getIPAddress();
-            IPv4Address broadcastAddr = interfaceAddr.getBroadcastAddress(ift->getInterface(i)->ipv4Data()->getNetmask());
+            InterfaceEntry *ie = ift->getInterface(i);
+            IPv4Address interfaceAddr = ie->ipv4Data()->getIPAddress();
+            IPv4Address broadcastAddr = interfaceAddr.getBroadcastAddress(ie->ipv4Data()->getNetmask());
             if (!broadcastAddr.isUnspecified())
-            {
-                 localBroadcastAddresses.insert(broadcastAddr);
-            }
+                localBroadcastAddresses.insert(std::make_pair(broadcastAddr, ie));
         }
     }
 
-    AddressSet::iterator it = localBroadcastAddresses.find(dest);
-    return it!=localBroadcastAddresses.end();
-}
-
-InterfaceEntry *RoutingTable::findInterfaceByLocalBroadcastAddress(const IPv4Address& dest) const
-{
-    for (int i=0; i<ift->getNumInterfaces(); i++)
-    {
-        InterfaceEntry *ie = ift->getInterface(i);
-        IPv4Address interfaceAddr = ie->ipv4Data()->getIPAddress();
-        IPv4Address broadcastAddr = interfaceAddr.getBroadcastAddress(ie->ipv4Data()->getNetmask());
-        if (broadcastAddr == dest)
-            return ie;
-    }
-    return NULL;
+    AddressInterfaceMap::const_iterator it = localBroadcastAddresses.find(dest);
+    return it != localBroadcastAddresses.end() ? it->second : NULL;
 }
 
 bool RoutingTable::isLocalMulticastAddress(const IPv4Address& dest) const
@@ -488,6 +487,11 @@ IPv4Route *RoutingTable::findBestMatchingRoute(const IPv4Address& dest) const
 {
     Enter_Method("findBestMatchingRoute(%u.%u.%u.%u)", dest.getDByte(0), dest.getDByte(1), dest.getDByte(2), dest.getDByte(3)); // note: str().c_str() too slow here
 
+    return findBestMatchingRouteDirect(dest);
+}
+
+IPv4Route *RoutingTable::findBestMatchingRouteDirect(const IPv4Address& dest) const
+{
     RoutingCache::iterator it = routingCache.find(dest);
     if (it != routingCache.end())
     {
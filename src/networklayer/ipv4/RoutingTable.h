@@ -102,7 +102,9 @@ class INET_API RoutingTable: public cSimpleModule, public IRoutingTable, protect
     typedef std::set<IPv4Address> AddressSet;
     mutable AddressSet localAddresses;
     // JcM add: to handle the local broadcast address
-    mutable AddressSet localBroadcastAddresses;
+    // (maps the local broadcast addresses to their interfaces)
+    typedef std::map<IPv4Address, InterfaceEntry *> AddressInterfaceMap;
+    mutable AddressInterfaceMap localBroadcastAddresses;
 
   protected:
     // set IPv4 address etc on local loopback
@@ -246,6 +248,19 @@ class INET_API RoutingTable: public cSimpleModule, public IRoutingTable, protect
     virtual IPv4Address getGatewayForDestAddr(const IPv4Address& dest) const;
     //@}
 
+    /** @name Lookups for the forwarding path */
+    //@{
+    /**
+     * Same as isLocalAddress(), but without Enter_Method.
+     */
+    virtual bool isLocalAddressDirect(const IPv4Address& dest) const;
+
+    /**
+     * Same as findBestMatchingRoute(), but without Enter_Method.
+     */
+    virtual IPv4Route *findBestMatchingRouteDirect(const IPv4Address& dest) const;
+    //@}
+
     /** @name Multicast routing functions */
     //@{
 
@@ -58,7 +58,6 @@ void IPv6::initialize()
     mapping.parseProtocolMapping(par("protocolMapping"));
 
     curFragmentId = 0;
-    lastCheckTime = 0;
     fragbuf.init(icmp);
 
     numMulticast = numLocalDeliver = numDropped = numUnroutable = numForwarded = 0;
@@ -458,12 +457,8 @@ void IPv6::localDeliver(IPv6Datagram *datagram)
         EV << "Datagram fragment: offset=" << fh->getFragmentOffset()
            << ", MORE=" << (fh->getMoreFragments() ? "true" : "false") << ".\n";
 
-        // erase timed out fragments in fragmentation buffer; check every 10 seconds max
-        if (simTime() >= lastCheckTime + 10)
-        {
-            lastCheckTime = simTime();
-            fragbuf.purgeStaleFragments(simTime()-FRAGMENT_TIMEOUT);
-        }
+        // erase timed out fragments in fragmentation buffer (only visits the stale ones)
+        fragbuf.purgeStaleFragments(simTime()-FRAGMENT_TIMEOUT);
 
         datagram = fragbuf.addFragment(datagram, fh, simTime());
         if (!datagram)
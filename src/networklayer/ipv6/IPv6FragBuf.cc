@@ -26,6 +26,7 @@
 #include "ICMPv6Message_m.h"  // for TIME_EXCEEDED
 #include "IPv6Datagram.h"
 #include "IPv6ExtensionHeaders.h"
+#include "ECN_m.h"
 
 
 IPv6FragBuf::IPv6FragBuf()
@@ -35,6 +36,11 @@ IPv6FragBuf::IPv6FragBuf()
 
 IPv6FragBuf::~IPv6FragBuf()
 {
+    while (!bufs.empty())
+    {
+        delete bufs.getOldest()->buf.datagram;
+        bufs.remove(bufs.getOldest());
+    }
 }
 
 void IPv6FragBuf::init(ICMPv6 *icmp)
@@ -50,22 +56,15 @@ IPv6Datagram *IPv6FragBuf::addFragment(IPv6Datagram *datagram, IPv6FragmentHeade
     key.src = datagram->getSrcAddress();
     key.dest = datagram->getDestAddress();
 
-    Buffers::iterator i = bufs.find(key);
-
-    DatagramBuffer *buf = NULL;
-    if (i==bufs.end())
+    Buffers::Entry *entry = bufs.find(key);
+    if (!entry)
     {
         // this is the first fragment of that datagram, create reassembly buffer for it
-        buf = &bufs[key];
-        buf->datagram = NULL;
-        buf->createdAt = now;
-    }
-    else
-    {
-        // use existing buffer
-        buf = &(i->second);
+        entry = bufs.insert(key, now);
     }
 
+    DatagramBuffer *buf = &entry->buf;
+
     int fragmentLength = datagram->calculateFragmentLength();
     unsigned short offset = fh->getFragmentOffset();
     bool moreFragments = fh->getMoreFragments();
@@ -101,6 +100,10 @@ IPv6Datagram *IPv6FragBuf::addFragment(IPv6Datagram *datagram, IPv6FragmentHeade
                                            offset+fragmentLength,
                                            !moreFragments);
 
+    // RFC 3168, section 5.3: the reassembled packet carries CE if any fragment did
+    if (datagram->getExplicitCongestionNotification() == IP_ECN_CE)
+        buf->ceMarked = true;
+
     // Store the first fragment. The first fragment contains the whole
     // encapsulated payload, and extension headers of the
     // original datagram.
@@ -122,7 +125,9 @@ IPv6Datagram *IPv6FragBuf::addFragment(IPv6Datagram *datagram, IPv6FragmentHeade
         ASSERT(ret);
         ret->removeExtensionHeader(IP_PROT_IPv6EXT_FRAGMENT);
         ret->setByteLength(ret->calculateUnfragmentableHeaderByteLength()+buf->buf.getTotalLength());
-        bufs.erase(i);
+        if (buf->ceMarked)
+            ret->setExplicitCongestionNotification(IP_ECN_CE);
+        bufs.remove(entry);
         return ret;
     }
     else
@@ -145,32 +150,20 @@ IPv6Datagram *IPv6FragBuf::addFragment(IPv6Datagram *datagram, IPv6FragmentHeade
  */
 void IPv6FragBuf::purgeStaleFragments(simtime_t lastupdate)
 {
-    // this method shouldn't be called too often because iteration on
-    // an std::map is *very* slow...
-
+    // the buffers are ordered by their creation time, so the stale ones are at the front
     ASSERT(icmpModule);
 
-    for (Buffers::iterator i=bufs.begin(); i!=bufs.end(); )
+    while (!bufs.empty() && bufs.getOldest()->timestamp < lastupdate)
     {
-        // if too old, remove it
-        DatagramBuffer& buf = i->second;
-        if (buf.createdAt < lastupdate)
-        {
-            if (buf.datagram)
-            {
-                // send ICMP error
-                EV << "datagram fragment timed out in reassembly buffer, sending ICMP_TIME_EXCEEDED\n";
-                icmpModule->sendErrorMessage(buf.datagram, ICMPv6_TIME_EXCEEDED, 0);
-            }
-
-            // delete
-            Buffers::iterator oldi = i++;
-            bufs.erase(oldi);
-        }
-        else
+        Buffers::Entry *entry = bufs.getOldest();
+        if (entry->buf.datagram)
         {
-            ++i;
+            // send ICMP error
+            EV << "datagram fragment timed out in reassembly buffer, sending ICMP_TIME_EXCEEDED\n";
+            icmpModule->sendErrorMessage(entry->buf.datagram, ICMPv6_TIME_EXCEEDED, 0);
         }
+
+        // delete
+        bufs.remove(entry);
     }
 }
-
@@ -18,10 +18,9 @@
 #ifndef __IPv6FRAGBUF_H__
 #define __IPv6FRAGBUF_H__
 
-#include <map>
-#include <vector>
 #include "INETDefs.h"
 #include "ReassemblyBuffer.h"
+#include "ReassemblyTable.h"
 #include "IPv6Address.h"
 
 class ICMPv6;
@@ -43,23 +42,35 @@ class INET_API IPv6FragBuf
         IPv6Address src;
         IPv6Address dest;
 
-        inline bool operator<(const Key& b) const {
-            return (id!=b.id) ? (id<b.id) : (src!=b.src) ? (src<b.src) : (dest<b.dest);
+        inline bool operator==(const Key& b) const {
+            return id==b.id && src==b.src && dest==b.dest;
+        }
+        inline uint32 hash() const {
+            const uint32 *s = src.words();
+            const uint32 *d = dest.words();
+            uint32 h = id;
+            for (int i=0; i<4; i++)
+                h = (h * 31 + s[i]) * 31 + d[i];
+            return h;
         }
     };
 
     //
-    // Reassembly buffer for the datagram
+    // Reassembly buffer for the datagram; the time of the buffer creation
+    // (i.e. reception time of first-arriving fragment) is the timestamp of
+    // its entry in the table
     //
     struct DatagramBuffer
     {
         ReassemblyBuffer buf;  // reassembly buffer
         IPv6Datagram *datagram;  // the actual datagram
-        simtime_t createdAt;  // time of the buffer creation (i.e. reception time of first-arriving fragment)
+        bool ceMarked;  // set if any fragment carried the ECN CE codepoint
+
+        DatagramBuffer() : datagram(NULL), ceMarked(false) {}
     };
 
-    // we use std::map for fast lookup by datagram Id
-    typedef std::map<Key,DatagramBuffer> Buffers;
+    // hash table for fast lookup by datagram Id, with the buffers in the order of their creation
+    typedef ReassemblyTable<Key,DatagramBuffer> Buffers;
 
     // the reassembly buffers
     Buffers bufs;
@@ -93,12 +104,12 @@ class INET_API IPv6FragBuf
 
     /**
      * Throws out all fragments which are incomplete and their
-     * last update (last fragment arrival) was before "lastupdate",
+     * first fragment arrived before "lastupdate",
      * and sends ICMP TIME EXCEEDED message about them.
      *
-     * Timeout should be between 60 seconds and 120 seconds (RFC1122).
-     * This method should be called more frequently, maybe every
-     * 10..30 seconds or so.
+     * Timeout is 60 seconds (RFC 2460 4.5). This method only visits
+     * the buffers it throws out, so it may be called on every fragment
+     * arrival.
      */
     void purgeStaleFragments(simtime_t lastupdate);
 };
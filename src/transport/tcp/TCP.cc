@@ -20,6 +20,7 @@
 
 #include "IPv4ControlInfo.h"
 #include "IPv6ControlInfo.h"
+#include "ECN_m.h"
 #include "TCPConnection.h"
 #include "TCPSegment.h"
 #include "TCPCommand_m.h"
@@ -89,6 +90,12 @@ void TCP::initialize()
 
     recordStatistics = par("recordStats");
 
+    if (par("useTimerWheel").boolValue())
+    {
+        timerWheel = new TimerWheel(par("timerWheelGranularity").doubleValue());
+        timerWheelEvent = new cMessage("timerWheel");
+    }
+
     cModule *netw = simulation.getSystemModule();
     testing = netw->hasPar("testing") && netw->par("testing").boolValue();
     logverbose = !testing && netw->hasPar("logverbose") && netw->par("logverbose").boolValue();
@@ -102,16 +109,22 @@ TCP::~TCP()
         delete (*i).second;
         tcpAppConnMap.erase(i);
     }
+
+    // connections cancel their timers when deleted, so the wheel goes last
+    delete timerWheel;
+    cancelAndDelete(timerWheelEvent);
+    ObjectPool::removeUser();
 }
 
 void TCP::handleMessage(cMessage *msg)
 {
-    if (msg->isSelfMessage())
+    if (msg == timerWheelEvent)
     {
-        TCPConnection *conn = (TCPConnection *) msg->getContextPointer();
-        bool ret = conn->processTimer(msg);
-        if (!ret)
-            removeConnection(conn);
+        processTimerWheel();
+    }
+    else if (msg->isSelfMessage())
+    {
+        processTimer(msg);
     }
     else if (msg->arrivedOn("ipIn") || msg->arrivedOn("ipv6In"))
     {
@@ -140,6 +153,7 @@ void TCP::handleMessage(cMessage *msg)
                 IPv4ControlInfo *controlInfo = (IPv4ControlInfo *)tcpseg->removeControlInfo();
                 srcAddr = controlInfo->getSrcAddr();
                 destAddr = controlInfo->getDestAddr();
+                tcpseg->setCongestionExperienced(controlInfo->getExplicitCongestionNotification() == IP_ECN_CE);
                 delete controlInfo;
             }
             else if (dynamic_cast<IPv6ControlInfo *>(tcpseg->getControlInfo()) != NULL)
@@ -147,6 +161,7 @@ void TCP::handleMessage(cMessage *msg)
                 IPv6ControlInfo *controlInfo = (IPv6ControlInfo *)tcpseg->removeControlInfo();
                 srcAddr = controlInfo->getSrcAddr();
                 destAddr = controlInfo->getDestAddr();
+                tcpseg->setCongestionExperienced(controlInfo->getExplicitCongestionNotification() == IP_ECN_CE);
                 delete controlInfo;
             }
             else
@@ -445,9 +460,83 @@ void TCP::removeConnection(TCPConnection *conn)
     delete conn;
 }
 
+void TCP::processTimer(cMessage *timer)
+{
+    TCPConnection *conn = (TCPConnection *) timer->getContextPointer();
+    bool ret = conn->processTimer(timer);
+    if (!ret)
+        removeConnection(conn);
+}
+
+void TCP::processTimerWheel()
+{
+    // timers are popped one by one, as processing one may delete others
+    TimerWheel::Timer *timer;
+    while ((timer = timerWheel->popExpired()) != NULL)
+        processTimer(static_cast<TCPTimer *>(timer));
+
+    updateTimerWheelEvent();
+}
+
+void TCP::updateTimerWheelEvent()
+{
+    simtime_t nextEventTime = timerWheel->getNextEventTime();
+
+    // an event that comes too early is harmless (it finds no expired timer),
+    // so cancelled and postponed timers do not need to touch the FES
+    if (timerWheelEvent->isScheduled())
+    {
+        if (timerWheelEvent->getArrivalTime() <= nextEventTime)
+            return;
+        cancelEvent(timerWheelEvent);
+    }
+
+    if (nextEventTime != MAXTIME)
+        scheduleAt(nextEventTime, timerWheelEvent);
+}
+
+void TCP::scheduleTimer(cMessage *timer, simtime_t time)
+{
+    TCPTimer *tcpTimer = timerWheel ? dynamic_cast<TCPTimer *>(timer) : NULL;
+
+    if (tcpTimer)
+    {
+        timerWheel->schedule(tcpTimer, time);
+
+        if (!timerWheelEvent->isScheduled() || time < timerWheelEvent->getArrivalTime())
+            updateTimerWheelEvent();
+    }
+    else
+    {
+        if (timer->isScheduled())
+            cancelEvent(timer);
+
+        scheduleAt(time, timer);
+    }
+}
+
+cMessage *TCP::cancelTimer(cMessage *timer)
+{
+    TCPTimer *tcpTimer = timerWheel ? dynamic_cast<TCPTimer *>(timer) : NULL;
+
+    if (tcpTimer)
+        timerWheel->cancel(tcpTimer);
+    else
+        cancelEvent(timer);
+
+    return timer;
+}
+
+bool TCP::isTimerScheduled(cMessage *timer)
+{
+    TCPTimer *tcpTimer = timerWheel ? dynamic_cast<TCPTimer *>(timer) : NULL;
+    return tcpTimer ? tcpTimer->isPending() : timer->isScheduled();
+}
+
 void TCP::finish()
 {
     tcpEV << getFullPath() << ": finishing with " << tcpConnMap.size() << " connections open.\n";
+    ObjectPool::recordStatistics();
 }
 
 TCPSendQueue* TCP::createSendQueue(TCPDataTransferMode transferModeP)
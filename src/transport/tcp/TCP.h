@@ -25,7 +25,9 @@
 #include "INETDefs.h"
 
 #include "IPvXAddress.h"
+#include "ObjectPool.h"
 #include "TCPCommand_m.h"
+#include "TimerWheel.h"
 
 // Forward declarations:
 class TCPConnection;
@@ -43,6 +45,17 @@ class TCPReceiveQueue;
 #define testingEV (ev.isDisabled()||!TCP::testing)?ev:ev
 
 
+/**
+ * Timer of TCP connections and TCP algorithms. If the TCP module uses a
+ * timer wheel, these timers are kept there instead of the future event set;
+ * the context pointer must point to the TCPConnection.
+ */
+class INET_API TCPTimer : public cMessage, public TimerWheel::Timer
+{
+  public:
+    TCPTimer(const char *name = NULL, short kind = 0) : cMessage(name, kind) {}
+};
+
 
 
 
@@ -98,6 +111,12 @@ class TCPReceiveQueue;
  *
  * The concrete TCPAlgorithm class to use can be chosen per connection (in OPEN)
  * or in a module parameter.
+ *
+ * Connections and algorithms schedule their timers through scheduleTimer()
+ * and cancelTimer(). If the useTimerWheel parameter is set, TCPTimer
+ * timers are multiplexed onto a single self-message by a TimerWheel, which
+ * spares the future event set the cancel/reschedule churn of many
+ * connections.
  */
 class INET_API TCP : public cSimpleModule
 {
@@ -146,6 +165,9 @@ class INET_API TCP : public cSimpleModule
     ushort lastEphemeralPort;
     std::multiset<ushort> usedEphemeralPorts;
 
+    TimerWheel *timerWheel;         // NULL if timers are scheduled in the FES
+    cMessage *timerWheelEvent;      // fires when the next timer of the wheel is due
+
   protected:
     /** Factory method; may be overriden for customizing TCP */
     virtual TCPConnection *createConnection(int appGateIndex, int connId);
@@ -156,6 +178,9 @@ class INET_API TCP : public cSimpleModule
     virtual void segmentArrivalWhileClosed(TCPSegment *tcpseg, IPvXAddress src, IPvXAddress dest);
     virtual void removeConnection(TCPConnection *conn);
     virtual void updateDisplayString();
+    virtual void processTimer(cMessage *timer);
+    virtual void processTimerWheel();
+    virtual void updateTimerWheelEvent();
 
   public:
     static bool testing;    // switches between tcpEV and testingEV
@@ -164,7 +189,7 @@ class INET_API TCP : public cSimpleModule
     bool recordStatistics;  // output vectors on/off
 
   public:
-    TCP() {}
+    TCP() : timerWheel(NULL), timerWheelEvent(NULL) {ObjectPool::addUser();}
     virtual ~TCP();
 
   protected:
@@ -205,6 +230,24 @@ class INET_API TCP : public cSimpleModule
      * To be called from TCPConnection: create a new receive queue.
      */
     virtual TCPReceiveQueue* createReceiveQueue(TCPDataTransferMode transferModeP);
+
+    /**
+     * To be called from TCPConnection and TCPAlgorithm: schedules a timer
+     * to expire at the given time, or reschedules it if already scheduled.
+     * TCPTimer timers go to the timer wheel if it is enabled.
+     */
+    virtual void scheduleTimer(cMessage *timer, simtime_t time);
+
+    /**
+     * To be called from TCPConnection and TCPAlgorithm: cancels a timer
+     * if it is scheduled, and returns it.
+     */
+    virtual cMessage *cancelTimer(cMessage *timer);
+
+    /**
+     * Returns true if the timer is scheduled (in the timer wheel or in the FES).
+     */
+    virtual bool isTimerScheduled(cMessage *timer);
 };
 
 #endif
@@ -121,6 +121,7 @@ enum TCPEventCode
 
 #define MAX_SYN_REXMIT_COUNT        12  // will only be used with SYN+ACK: with SYN CONN_ESTAB occurs sooner
 #define TCP_MAX_WIN              65535  // 65535 bytes, largest value (16 bit) for (unscaled) window size
+#define TCP_MAX_WIN_SCALED       (TCP_MAX_WIN << 14)  // 1073725440 bytes, largest window size with the maximal shift count (14) of the Window Scale option
 #define DUPTHRESH                    3  // used for TCPTahoe, TCPReno and SACK (RFC 3517)
 #define MAX_SACK_BLOCKS             60  // will only be used with SACK
 #define TCP_OPTIONS_MAX_SIZE        40  // 40 bytes, 15 * 4 bytes (15 is the largest number in 4 bits length data offset field), TCP_MAX_HEADER_OCTETS - TCP_HEADER_OCTETS = 40
@@ -198,6 +199,8 @@ class INET_API TCPStateVariables : public cObject
     bool delayed_acks_enabled;  // set if delayed ACK algorithm (RFC 1122) is enabled
     bool limited_transmit_enabled; // set if Limited Transmit algorithm (RFC 3042) is enabled
     bool increased_IW_enabled;  // set if Increased Initial Window (RFC 3390) is enabled
+    uint32 offload_size;        // max. payload of super-segments if segmentation offload is enabled, 0 otherwise
+    bool pacing_enabled;        // set if new data is paced over the RTT instead of being sent in bursts
 
     uint32 full_sized_segment_counter; // this counter is needed for delayed ACK
     bool ack_now;               // send ACK immediately, needed if delayed_acks_enabled is set
@@ -225,6 +228,7 @@ class INET_API TCPStateVariables : public cObject
     bool snd_initial_ts;     // set if initial TIMESTAMP has been sent
     bool rcv_initial_ts;     // set if initial TIMESTAMP has been received
     uint32 ts_recent;        // RFC 1323, page 31: "Latest received Timestamp"
+    simtime_t time_ts_recent; // time at which ts_recent was updated (needed to compute the IDLE time for PAWS)
     uint32 last_ack_sent;    // RFC 1323, page 31: "Last ACK field sent"
     simtime_t time_last_data_sent; // time at which the last data segment was sent (needed to compute the IDLE time for PAWS)
 
@@ -249,6 +253,15 @@ class INET_API TCPStateVariables : public cObject
     uint32 sackedBytes_old;  // old number of sackedBytes - needed for RFC 3042 to check if last dupAck contained new sack information
     bool lossRecovery;       // indicates if algorithm is in loss recovery phase
 
+    // ECN related variables (RFC 3168)
+    bool ecn_support;        // set if the host supports ECN
+    bool ecn_enabled;        // set if the connection uses ECN (negotiated with ECE and CWR on SYN and SYN+ACK)
+    bool ecn_precise_echo;   // receiver: set ECE on an ACK iff the last data segment received carried CE (DCTCP, RFC 8257), instead of from CE until CWR
+    bool snd_ece;            // receiver: set if ECE should be sent on ACKs
+    bool snd_cwr;            // sender: set if CWR should be sent on the next segment of new data
+    bool ece_rcvd;           // sender: set if the ACK currently being processed carries ECE
+    uint32 ecn_recover;      // sender: cwnd is not reduced again for ECE until snd_una reaches this (one reduction per window of data)
+
     // those counters would logically belong to TCPAlgorithm, but it's a lot easier to manage them here
     uint32 dupacks;          // current number of received consecutive duplicate ACKs
     uint32 snd_sacks;        // number of sent sacks
@@ -412,6 +425,8 @@ class INET_API TCPConnection
     virtual TCPEventCode processSegment1stThru8th(TCPSegment *tcpseg);
     virtual TCPEventCode processRstInSynReceived(TCPSegment *tcpseg);
     virtual bool processAckInEstabEtc(TCPSegment *tcpseg);
+    /** Sets snd_ece (the ECE flag of our ACKs) from the CE mark and the CWR flag of a data segment */
+    virtual void updateEcnEcho(TCPSegment *tcpseg);
     //@}
 
     /** @name Processing of TCP options. Invoked from readHeaderOptions(). Return value indicates whether the option was valid. */
@@ -499,6 +514,8 @@ class INET_API TCPConnection
     /**
      * Utility: sends one segment of 'bytes' bytes from snd_nxt, and advances snd_nxt.
      * sendData(), sendProbe() and retransmitData() internally all rely on this one.
+     * With segmentation offload, 'bytes' may span several segments, which are
+     * then sent as one super-segment.
      */
     virtual void sendSegment(uint32 bytes);
 
@@ -517,13 +534,16 @@ class INET_API TCPConnection
     /** Utility: signal to user that connection timed out */
     virtual void signalConnectionTimeout();
 
-    /** Utility: start a timer */
+    /** Utility: start a timer, or restart it if already running */
     void scheduleTimeout(cMessage *msg, simtime_t timeout)
-        {tcpMain->scheduleAt(simTime()+timeout, msg);}
+        {tcpMain->scheduleTimer(msg, simTime()+timeout);}
+
+    /** Utility: returns true if the timer is running */
+    bool isTimerScheduled(cMessage *msg) {return tcpMain->isTimerScheduled(msg);}
 
   protected:
     /** Utility: cancel a timer */
-    cMessage *cancelEvent(cMessage *msg) {return tcpMain->cancelEvent(msg);}
+    cMessage *cancelEvent(cMessage *msg) {return tcpMain->cancelTimer(msg);}
 
     /** Utility: send IP packet */
     static void sendToIP(TCPSegment *tcpseg, IPvXAddress src, IPvXAddress dest);
@@ -64,6 +64,8 @@ TCPStateVariables::TCPStateVariables()
     delayed_acks_enabled = false; // will be set from configureStateVariables()
     limited_transmit_enabled = false; // will be set from configureStateVariables()
     increased_IW_enabled = false; // will be set from configureStateVariables()
+    offload_size = 0; // will be set from configureStateVariables()
+    pacing_enabled = false; // will be set from configureStateVariables()
     full_sized_segment_counter = 0;
     ack_now = false;
 
@@ -83,6 +85,7 @@ TCPStateVariables::TCPStateVariables()
     snd_initial_ts = false;
     rcv_initial_ts = false;
     ts_recent = 0;
+    time_ts_recent = 0;
     last_ack_sent = 0;
 
     sack_support = false;       // will be set from configureStateVariables()
@@ -101,6 +104,14 @@ TCPStateVariables::TCPStateVariables()
     sackedBytes_old = 0;
     lossRecovery = false;
 
+    ecn_support = false;      // will be set from configureStateVariables()
+    ecn_enabled = false;
+    ecn_precise_echo = false;
+    snd_ece = false;
+    snd_cwr = false;
+    ece_rcvd = false;
+    ecn_recover = 0;
+
     dupacks = 0;
     snd_sacks = 0;
     rcv_sacks = 0;
@@ -130,6 +141,8 @@ std::string TCPStateVariables::detailedInfo() const
     std::stringstream out;
     out << "active=" << active << "\n";
     out << "snd_mss=" << snd_mss << "\n";
+    out << "offload_size=" << offload_size << "\n";
+    out << "pacing_enabled=" << pacing_enabled << "\n";
     out << "snd_una=" << snd_una << "\n";
     out << "snd_nxt=" << snd_nxt << "\n";
     out << "snd_max=" << snd_max << "\n";
@@ -154,6 +167,8 @@ std::string TCPStateVariables::detailedInfo() const
     out << "ts_enabled=" << ts_enabled << "\n";
     out << "sack_support=" << sack_support << "\n";
     out << "sack_enabled=" << sack_enabled << "\n";
+    out << "ecn_support=" << ecn_support << "\n";
+    out << "ecn_enabled=" << ecn_enabled << "\n";
     out << "snd_sack_perm=" << snd_sack_perm << "\n";
     out << "snd_sacks=" << snd_sacks << "\n";
     out << "rcv_sacks=" << rcv_sacks << "\n";
@@ -204,10 +219,10 @@ TCPConnection::TCPConnection(TCP *_mod, int _appGateIndex, int _connId)
     tcpAlgorithm = NULL;
     state = NULL;
 
-    the2MSLTimer = new cMessage("2MSL");
-    connEstabTimer = new cMessage("CONN-ESTAB");
-    finWait2Timer = new cMessage("FIN-WAIT-2");
-    synRexmitTimer = new cMessage("SYN-REXMIT");
+    the2MSLTimer = new TCPTimer("2MSL");
+    connEstabTimer = new TCPTimer("CONN-ESTAB");
+    finWait2Timer = new TCPTimer("FIN-WAIT-2");
+    synRexmitTimer = new TCPTimer("SYN-REXMIT");
 
     the2MSLTimer->setContextPointer(this);
     connEstabTimer->setContextPointer(this);
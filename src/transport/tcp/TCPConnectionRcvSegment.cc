@@ -133,12 +133,13 @@ TCPEventCode TCPConnection::processSegment1stThru8th(TCPSegment *tcpseg)
 
     if (tcpseg->getHeaderLength() > TCP_HEADER_OCTETS) // Header options present? TCP_HEADER_OCTETS = 20
     {
-        // PAWS
-        if (state->ts_enabled)
+        // PAWS (RFC 7323, section 5.3): RST segments are not subject to the test, and
+        // ts_recent is only valid if it was updated within PAWS_IDLE_TIME_THRESH
+        if (state->ts_enabled && !tcpseg->getRstBit())
         {
             uint32 tsval = getTSval(tcpseg);
             if (tsval != 0 && seqLess(tsval, state->ts_recent) &&
-                    (simTime() - state->time_last_data_sent) > PAWS_IDLE_TIME_THRESH) // PAWS_IDLE_TIME_THRESH = 24 days
+                    (simTime() - state->time_ts_recent) <= PAWS_IDLE_TIME_THRESH) // PAWS_IDLE_TIME_THRESH = 24 days
             {
                 tcpEV << "PAWS: Segment is not acceptable, TSval=" << tsval << " in " <<
                         stateName(fsm.getState()) << " state received: dropping segment\n";
@@ -482,9 +483,14 @@ TCPEventCode TCPConnection::processSegment1stThru8th(TCPSegment *tcpseg)
 
         if (tcpseg->getPayloadLength() > 0)
         {
+            if (state->ecn_enabled)
+                updateEcnEcho(tcpseg);
+
             // check for full sized segment
             if (tcpseg->getPayloadLength() == state->snd_mss || tcpseg->getPayloadLength() + tcpseg->getHeaderLength() - TCP_HEADER_OCTETS == state->snd_mss)
                 state->full_sized_segment_counter++;
+            else if (tcpseg->getOffloadSegmentSize() != 0) // super-segment: count its segments
+                state->full_sized_segment_counter += tcpseg->getPayloadLength() / tcpseg->getOffloadSegmentSize();
 
             // check for persist probe
             if (tcpseg->getPayloadLength() == 1)
@@ -550,6 +556,15 @@ TCPEventCode TCPConnection::processSegment1stThru8th(TCPSegment *tcpseg)
                     }
 
                     tcpAlgorithm->receivedOutOfOrderSegment();
+
+                    // a super-segment stands for several segments, each of which would have
+                    // triggered a duplicate ACK; the sender needs them for fast retransmit
+                    if (tcpseg->getOffloadSegmentSize() != 0)
+                    {
+                        uint32 numSegments = (tcpseg->getPayloadLength() + tcpseg->getOffloadSegmentSize() - 1) / tcpseg->getOffloadSegmentSize();
+                        for (uint32 i = 1; i < numSegments; i++)
+                            tcpAlgorithm->receivedOutOfOrderSegment();
+                    }
                 }
                 else
                 {
@@ -855,11 +870,19 @@ TCPEventCode TCPConnection::processSegmentInListen(TCPSegment *tcpseg, IPvXAddre
         if (tcpseg->getHeaderLength() > TCP_HEADER_OCTETS) // Header options present? TCP_HEADER_OCTETS = 20
             readHeaderOptions(tcpseg);
 
+        // RFC 3168, section 6.1.1: "If a host has received an ECN-setup SYN
+        // packet, then it MAY send an ECN-setup SYN-ACK packet"
+        if (state->ecn_support && tcpseg->getEceBit() && tcpseg->getCwrBit())
+        {
+            tcpEV << "ECN-setup SYN received, ECN enabled\n";
+            state->ecn_enabled = true;
+        }
+
         state->ack_now = true;
         sendSynAck();
         startSynRexmitTimer();
 
-        if (!connEstabTimer->isScheduled())
+        if (!isTimerScheduled(connEstabTimer))
             scheduleTimeout(connEstabTimer, TCP_TIMEOUT_CONN_ESTAB);
 
         //"
@@ -1062,6 +1085,14 @@ TCPEventCode TCPConnection::processSegmentInSynSent(TCPSegment *tcpseg, IPvXAddr
             if (tcpseg->getHeaderLength() > TCP_HEADER_OCTETS) // Header options present? TCP_HEADER_OCTETS = 20
                 readHeaderOptions(tcpseg);
 
+            // RFC 3168, section 6.1.1: ECN is used if our ECN-setup SYN was
+            // answered with an ECN-setup SYN-ACK (ECE set, CWR cleared)
+            if (state->ecn_support && tcpseg->getEceBit() && !tcpseg->getCwrBit())
+            {
+                tcpEV << "ECN-setup SYN+ACK received, ECN enabled\n";
+                state->ecn_enabled = true;
+            }
+
             // notify tcpAlgorithm (it has to send ACK of SYN) and app layer
             state->ack_now = true;
             tcpAlgorithm->established(true);
@@ -1164,6 +1195,9 @@ bool TCPConnection::processAckInEstabEtc(TCPSegment *tcpseg)
 {
     tcpEV2 << "Processing ACK in a data transfer state\n";
 
+    // the congestion control reacts to ECN-Echo when processing the ACK
+    state->ece_rcvd = state->ecn_enabled && tcpseg->getEceBit();
+
     //
     //"
     //  If SND.UNA < SEG.ACK =< SND.NXT then, set SND.UNA <- SEG.ACK.
@@ -1308,6 +1342,43 @@ bool TCPConnection::processAckInEstabEtc(TCPSegment *tcpseg)
     return true;
 }
 
+void TCPConnection::updateEcnEcho(TCPSegment *tcpseg)
+{
+    bool ce = tcpseg->getCongestionExperienced();
+
+    if (state->ecn_precise_echo)
+    {
+        // RFC 8257, section 3.2: "If the CE codepoint is set and DCTCP.CE is
+        // false, set DCTCP.CE to true and send an immediate ACK. If the CE
+        // codepoint is not set and DCTCP.CE is true, set DCTCP.CE to false
+        // and send an immediate ACK." As in Linux, the data received before
+        // is acknowledged first, with the old ECE value, if its ACK was delayed.
+        if (ce != state->snd_ece)
+        {
+            if (state->last_ack_sent != state->rcv_nxt)
+                sendAck();
+
+            tcpEV << "CE codepoint " << (ce ? "set" : "cleared") << ", setting ECE to " << ce << "\n";
+            state->snd_ece = ce;
+            state->ack_now = true;
+        }
+    }
+    else
+    {
+        // RFC 3168, section 6.1.3: after a CE data packet, "the TCP receiver
+        // sets the ECN-Echo flag in the TCP header of the subsequent ACK
+        // packet", and keeps setting it "until it receives a CWR packet".
+        if (tcpseg->getCwrBit())
+            state->snd_ece = false;
+
+        if (ce)
+        {
+            tcpEV << "CE codepoint set, echoing it with ECE until CWR arrives\n";
+            state->snd_ece = true;
+        }
+    }
+}
+
 //----
 
 void TCPConnection::process_TIMEOUT_CONN_ESTAB()
@@ -1376,7 +1447,7 @@ void TCPConnection::startSynRexmitTimer()
     state->syn_rexmit_count = 0;
     state->syn_rexmit_timeout = TCP_TIMEOUT_SYN_REXMIT;
 
-    if (synRexmitTimer->isScheduled())
+    if (isTimerScheduled(synRexmitTimer))
         cancelEvent(synRexmitTimer);
 
     scheduleTimeout(synRexmitTimer, state->syn_rexmit_timeout);
@@ -27,6 +27,7 @@
 #include "TCPCommand_m.h"
 #include "IPv4ControlInfo.h"
 #include "IPv6ControlInfo.h"
+#include "ECN_m.h"
 #include "TCPSendQueue.h"
 #include "TCPSACKRexmitQueue.h"
 #include "TCPReceiveQueue.h"
@@ -145,6 +146,10 @@ void TCPConnection::printSegmentBrief(TCPSegment *tcpseg)
 
     if (tcpseg->getPshBit())  tcpEV << "PSH ";
 
+    if (tcpseg->getEceBit())  tcpEV << "ECE ";
+
+    if (tcpseg->getCwrBit())  tcpEV << "CWR ";
+
     if (tcpseg->getPayloadLength() > 0 || tcpseg->getSynBit())
     {
         tcpEV << "[" << tcpseg->getSequenceNo() << ".." << (tcpseg->getSequenceNo() + tcpseg->getPayloadLength()) << ") ";
@@ -224,6 +229,28 @@ void TCPConnection::sendToIP(TCPSegment *tcpseg)
     tcpseg->setByteLength(tcpseg->getHeaderLength() + tcpseg->getPayloadLength());
     state->sentBytes = tcpseg->getPayloadLength(); // resetting sentBytes to 0 if sending a segment without data (e.g. ACK)
 
+    // ECN (RFC 3168): ECE on ACKs, CWR and ECT on new data
+    int ecn = IP_ECN_NOT_ECT;
+
+    if (state->ecn_enabled)
+    {
+        if (tcpseg->getAckBit() && !tcpseg->getSynBit() && state->snd_ece)
+            tcpseg->setEceBit(true);
+
+        // RFC 3168, section 6.1.5: "the TCP data sender MUST NOT set either
+        // an ECT codepoint or the CWR bit on retransmitted data packets"
+        if (tcpseg->getPayloadLength() > 0 && seqGE(tcpseg->getSequenceNo(), state->snd_max))
+        {
+            ecn = IP_ECN_ECT_0;
+
+            if (state->snd_cwr)
+            {
+                tcpseg->setCwrBit(true);
+                state->snd_cwr = false;
+            }
+        }
+    }
+
     tcpEV << "Sending: ";
     printSegmentBrief(tcpseg);
 
@@ -236,6 +263,7 @@ void TCPConnection::sendToIP(TCPSegment *tcpseg)
         controlInfo->setProtocol(IP_PROT_TCP);
         controlInfo->setSrcAddr(localAddr.get4());
         controlInfo->setDestAddr(remoteAddr.get4());
+        controlInfo->setExplicitCongestionNotification(ecn);
         tcpseg->setControlInfo(controlInfo);
 
         tcpMain->send(tcpseg, "ipOut");
@@ -247,6 +275,7 @@ void TCPConnection::sendToIP(TCPSegment *tcpseg)
         controlInfo->setProtocol(IP_PROT_TCP);
         controlInfo->setSrcAddr(localAddr.get6());
         controlInfo->setDestAddr(remoteAddr.get6());
+        controlInfo->setExplicitCongestionNotification(ecn);
         tcpseg->setControlInfo(controlInfo);
 
         tcpMain->send(tcpseg, "ipv6Out");
@@ -363,6 +392,9 @@ void TCPConnection::configureStateVariables()
     if (!state->ws_support && (advertisedWindowPar > TCP_MAX_WIN || advertisedWindowPar <= 0))
         throw cRuntimeError("Invalid advertisedWindow parameter: %ld", advertisedWindowPar);
 
+    if (state->ws_support && (advertisedWindowPar > TCP_MAX_WIN_SCALED || advertisedWindowPar <= 0)) // RFC 7323, section 2.3: at most 2^30 bytes
+        throw cRuntimeError("Invalid advertisedWindow parameter: %ld", advertisedWindowPar);
+
     state->rcv_wnd = advertisedWindowPar;
     state->rcv_adv = advertisedWindowPar;
 
@@ -378,17 +410,27 @@ void TCPConnection::configureStateVariables()
     state->limited_transmit_enabled = tcpMain->par("limitedTransmitEnabled"); // Limited Transmit algorithm (RFC 3042) enabled/disabled
     state->increased_IW_enabled = tcpMain->par("increasedIWEnabled"); // Increased Initial Window (RFC 3390) enabled/disabled
     state->snd_mss = tcpMain->par("mss").longValue(); // Maximum Segment Size (RFC 793)
+    long segmentOffloadSizePar = tcpMain->par("segmentOffloadSize").longValue(); // segmentation offload (TSO) enabled if nonzero
+
+    // a super-segment must hold at least two segments to save anything
+    if (segmentOffloadSizePar < 0 || segmentOffloadSizePar > 65535 ||
+            (segmentOffloadSizePar != 0 && segmentOffloadSizePar < 2 * (long)state->snd_mss))
+        throw cRuntimeError("Invalid segmentOffloadSize parameter: %ld", segmentOffloadSizePar);
+
+    state->offload_size = segmentOffloadSizePar;
+    state->pacing_enabled = tcpMain->par("pacingEnabled"); // pacing of new data over the RTT enabled/disabled
     state->ts_support = tcpMain->par("timestampSupport"); // if set, this means that current host supports TS (RFC 1323)
     state->sack_support = tcpMain->par("sackSupport"); // if set, this means that current host supports SACK (RFC 2018, 2883, 3517)
+    state->ecn_support = tcpMain->par("ecnSupport"); // if set, this means that current host supports ECN (RFC 3168)
 
     if (state->sack_support)
     {
         std::string algorithmName1 = "TCPReno";
         std::string algorithmName2 = tcpMain->par("tcpAlgorithmClass");
 
-        if (algorithmName1 != algorithmName2) // TODO add additional checks for new SACK supporting algorithms here once they are implemented
+        if (algorithmName1 != algorithmName2 && algorithmName2 != "TCPCubic" && algorithmName2 != "TCPDCTCP") // TODO add additional checks for new SACK supporting algorithms here once they are implemented
         {
-            EV << "If you want to use TCP SACK please set tcpAlgorithmClass to TCPReno\n";
+            EV << "If you want to use TCP SACK please set tcpAlgorithmClass to TCPReno, TCPCubic or TCPDCTCP\n";
 
             ASSERT(false);
         }
@@ -401,6 +443,7 @@ void TCPConnection::selectInitialSeqNum()
     state->iss = (unsigned long)fmod(SIMTIME_DBL(simTime()) * 250000.0, 1.0 + (double)(unsigned)0xffffffffUL) & 0xffffffffUL;
 
     state->snd_una = state->snd_nxt = state->snd_max = state->iss;
+    state->ecn_recover = state->iss;
 
     sendQueue->init(state->iss + 1); // + 1 is for SYN
     rexmitQueue->init(state->iss + 1); // + 1 is for SYN
@@ -476,6 +519,13 @@ void TCPConnection::sendSyn()
     updateRcvWnd();
     tcpseg->setWindow(state->rcv_wnd);
 
+    // RFC 3168, section 6.1.1: an "ECN-setup SYN packet" has both ECE and CWR set
+    if (state->ecn_support)
+    {
+        tcpseg->setEceBit(true);
+        tcpseg->setCwrBit(true);
+    }
+
     state->snd_max = state->snd_nxt = state->iss + 1;
 
     // write header options
@@ -496,6 +546,10 @@ void TCPConnection::sendSynAck()
     updateRcvWnd();
     tcpseg->setWindow(state->rcv_wnd);
 
+    // RFC 3168, section 6.1.1: an "ECN-setup SYN-ACK packet" has ECE set and CWR cleared
+    if (state->ecn_enabled)
+        tcpseg->setEceBit(true);
+
     state->snd_max = state->snd_nxt = state->iss + 1;
 
     // write header options
@@ -616,8 +670,16 @@ void TCPConnection::sendSegment(uint32 bytes)
 
     ASSERT(options_len < state->snd_mss);
 
-    if (bytes + options_len > state->snd_mss)
-        bytes = state->snd_mss - options_len;
+    uint32 segmentSize = state->snd_mss - options_len;
+
+    if (bytes > segmentSize)
+    {
+        // with segmentation offload, send a super-segment of whole segments
+        if (state->offload_size && bytes >= 2 * segmentSize)
+            bytes -= bytes % segmentSize;
+        else
+            bytes = segmentSize;
+    }
 
     state->sentBytes = bytes;
 
@@ -632,6 +694,9 @@ void TCPConnection::sendSegment(uint32 bytes)
     tcpseg->setAckBit(true);
     tcpseg->setWindow(updateRcvWnd());
 
+    if (bytes > segmentSize)
+        tcpseg->setOffloadSegmentSize(segmentSize);
+
     // TBD when to set PSH bit?
     // TBD set URG bit if needed
     ASSERT(bytes == tcpseg->getPayloadLength());
@@ -740,7 +805,8 @@ bool TCPConnection::sendData(bool fullSegmentsOnly, uint32 congestionWindow)
     {
         while (bytesToSend >= effectiveMaxBytesSend)
         {
-            sendSegment(state->snd_mss);
+            // with segmentation offload, sendSegment() sends several segments at once
+            sendSegment(state->offload_size ? std::min(bytesToSend, (ulong)state->offload_size) : state->snd_mss);
             bytesToSend -= state->sentBytes;
         }
     }
@@ -1042,6 +1108,10 @@ bool TCPConnection::processTSOption(TCPSegment *tcpseg, const TCPOption& option)
         state->rcv_initial_ts = true;
         state->ts_enabled = state->ts_support && state->snd_initial_ts && state->rcv_initial_ts;
         tcpEV << "TCP Header Option TS(TSval=" << option.getValues(0) << ", TSecr=" << option.getValues(1) << ") received, TS (ts_enabled) is set to " << state->ts_enabled << "\n";
+
+        // RFC 7323, section 4.3: the <SYN,ACK> echoes the TSval of the <SYN>
+        state->ts_recent = option.getValues(0);
+        state->time_ts_recent = simTime();
     }
     else
         tcpEV << "TCP Header Option TS(TSval=" << option.getValues(0) << ", TSecr=" << option.getValues(1) << ") received\n";
@@ -1055,19 +1125,26 @@ bool TCPConnection::processTSOption(TCPSegment *tcpseg, const TCPOption& option)
     //   unacceptable segment.
     //   If SEG.SEQ is equal to Last.ACK.sent, then save SEG.[TSval] in
     //   variable TS.Recent."
+    // Note: segments failing the PAWS test have already been dropped in processSegment1stThru8th();
+    // RFC 7323, section 5.5: a TS.Recent older than 24 days is invalid and is replaced
     if (state->ts_enabled)
     {
         if (seqLess(option.getValues(0), state->ts_recent))
         {
-            if ((simTime() - state->time_last_data_sent) > PAWS_IDLE_TIME_THRESH) // PAWS_IDLE_TIME_THRESH = 24 days
+            if ((simTime() - state->time_ts_recent) <= PAWS_IDLE_TIME_THRESH) // PAWS_IDLE_TIME_THRESH = 24 days
             {
                 tcpEV << "PAWS: Segment is not acceptable, TSval=" << option.getValues(0) << " in " <<  stateName(fsm.getState()) << " state received: dropping segment\n";
                 return false;
             }
+
+            state->ts_recent = option.getValues(0);
+            state->time_ts_recent = simTime();
+            tcpEV << "ts_recent is older than 24 days, new ts_recent=" << state->ts_recent << "\n";
         }
         else if (seqLE(tcpseg->getSequenceNo(), state->last_ack_sent)) // Note: test is modified according to the latest proposal of the tcplw@cray.com list (Braden 1993/04/26)
         {
             state->ts_recent = option.getValues(0);
+            state->time_ts_recent = simTime();
             tcpEV << "Updating ts_recent from segment: new ts_recent=" << state->ts_recent << "\n";
         }
     }
@@ -1134,8 +1211,8 @@ TCPSegment TCPConnection::writeHeaderOptions(TCPSegment *tcpseg)
             option.setLength(3);
             option.setValuesArraySize(1);
 
-            // Update WS variables
-            ulong scaled_rcv_wnd = receiveQueue->getAmountOfFreeBytes(state->maxRcvBuffer);
+            // Update WS variables: the shift count must allow advertising the whole receive buffer
+            ulong scaled_rcv_wnd = state->maxRcvBuffer;
             state->rcv_wnd_scale = 0;
 
             while (scaled_rcv_wnd > TCP_MAX_WIN && state->rcv_wnd_scale < 14) // RFC 1323, page 11: "the shift count must be limited to 14"
@@ -1144,7 +1221,7 @@ TCPSegment TCPConnection::writeHeaderOptions(TCPSegment *tcpseg)
                 state->rcv_wnd_scale++;
             }
 
-            option.setValues(0, state->rcv_wnd_scale); // rcv_wnd_scale is also set in scaleRcvWnd()
+            option.setValues(0, state->rcv_wnd_scale); // rcv_wnd_scale is used in updateRcvWnd() if WS is enabled
             state->snd_ws = true;
             state->ws_enabled = state->ws_support && state->snd_ws && state->rcv_ws;
             tcpEV << "TCP Header Option WS(=" << option.getValues(0) << ") sent, WS (ws_enabled) is set to " << state->ws_enabled << "\n";
@@ -1365,11 +1442,25 @@ unsigned short TCPConnection::updateRcvWnd()
         win = state->rcv_adv - state->rcv_nxt;
 
     // Observe upper limit for advertised window on this connection
-    if (win > TCP_MAX_WIN && !state->ws_enabled) // TCP_MAX_WIN = 65535 (16 bit)
-        win = TCP_MAX_WIN; // Note: The window size is limited to a 16 bit value in the TCP header if WINDOW SCALE option (RFC 1323) is not used
+    // Note: The window size is limited to a 16 bit value in the TCP header, scaled by the shift count
+    // sent in the SYN if WINDOW SCALE option (RFC 7323) is used
+    uint32 rcv_wnd_scale = state->ws_enabled ? state->rcv_wnd_scale : 0;
+    uint32 maxWin = (uint32)TCP_MAX_WIN << rcv_wnd_scale; // TCP_MAX_WIN = 65535 (16 bit)
+    if (win > maxWin)
+        win = maxWin;
 
     // Note: The order of the "Do not shrink window" and "Observe upper limit" parts has been changed to the order used in FreeBSD Release 7.1
 
+    // RFC 7323, section 2.3: the scaled window loses its low-order bits; round up,
+    // so that the advertised right edge does not move to the left
+    if (rcv_wnd_scale > 0)
+    {
+        uint32 mask = ((uint32)1 << rcv_wnd_scale) - 1;
+        win = (win + mask) & ~mask;
+        if (win > maxWin)
+            win = maxWin;
+    }
+
     // update rcv_adv if needed
     if (win > 0 && seqGE(state->rcv_nxt + win, state->rcv_adv))
     {
@@ -1384,18 +1475,9 @@ unsigned short TCPConnection::updateRcvWnd()
     if (rcvWndVector)
         rcvWndVector->record(state->rcv_wnd);
 
-    // scale rcv_wnd:
-    uint32 scaled_rcv_wnd = state->rcv_wnd;
-    state->rcv_wnd_scale = 0;
-
-    if (state->ws_enabled)
-    {
-        while (scaled_rcv_wnd > TCP_MAX_WIN && state->rcv_wnd_scale < 14) // RFC 1323, page 11: "the shift count must be limited to 14"
-        {
-            scaled_rcv_wnd = scaled_rcv_wnd >> 1;
-            state->rcv_wnd_scale++;
-        }
-    }
+    // scale rcv_wnd: RFC 7323, section 2.2: the shift count is fixed in each direction
+    // when the connection is opened, so it is the one sent in the WS option
+    uint32 scaled_rcv_wnd = state->rcv_wnd >> rcv_wnd_scale;
 
     ASSERT(scaled_rcv_wnd == (unsigned short)scaled_rcv_wnd);
 
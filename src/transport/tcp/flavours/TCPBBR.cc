@@ -0,0 +1,567 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <algorithm>   // min,max
+
+#include "TCPBBR.h"
+#include "TCP.h"
+
+
+#define BBR_HIGH_GAIN           2.885   // 2/ln(2): doubles the sending rate every round in STARTUP
+#define BBR_CWND_GAIN           2.0     // cwnd is twice the bandwidth-delay product in PROBE_BW
+#define BBR_BTLBW_FILTER_LEN    10      // rounds
+#define BBR_MIN_RTT_FILTER_LEN  10      // 10s
+#define BBR_PROBE_RTT_DURATION  0.2     // 200ms
+#define BBR_MIN_PIPE_CWND       4       // segments
+#define BBR_FULL_BW_THRESH      1.25    // STARTUP ends when btl_bw grows less than 25%...
+#define BBR_FULL_BW_COUNT       3       // ...for 3 rounds
+#define BBR_GAIN_CYCLE_LEN      8
+
+static const double pacingGainCycle[BBR_GAIN_CYCLE_LEN] = { 1.25, 0.75, 1, 1, 1, 1, 1, 1 };
+
+Register_Class(TCPBBR);
+
+
+TCPBBRStateVariables::TCPBBRStateVariables() : btl_bw_filter(BBR_BTLBW_FILTER_LEN)
+{
+    mode = STARTUP;
+    pacing_gain = BBR_HIGH_GAIN;
+    cwnd_gain = BBR_HIGH_GAIN;
+
+    min_rtt = 0;
+    min_rtt_stamp = 0;
+
+    delivered = 0;
+    delivered_time = 0;
+    first_sent_time = 0;
+
+    round_count = 0;
+    next_round_delivered = 0;
+    round_start = false;
+
+    filled_pipe = false;
+    full_bw = 0;
+    full_bw_count = 0;
+
+    cycle_index = 0;
+    cycle_stamp = 0;
+
+    probe_rtt_done_stamp = 0;
+    probe_rtt_round_done = false;
+    prior_cwnd = 0;
+}
+
+static const char *getModeName(TCPBBRStateVariables::Mode mode)
+{
+    switch (mode)
+    {
+        case TCPBBRStateVariables::STARTUP:   return "STARTUP";
+        case TCPBBRStateVariables::DRAIN:     return "DRAIN";
+        case TCPBBRStateVariables::PROBE_BW:  return "PROBE_BW";
+        case TCPBBRStateVariables::PROBE_RTT: return "PROBE_RTT";
+        default: return "???";
+    }
+}
+
+std::string TCPBBRStateVariables::info() const
+{
+    std::stringstream out;
+    out << TCPBaseAlgStateVariables::info();
+    out << " mode=" << getModeName(mode);
+    out << " btl_bw=" << btl_bw_filter.get() * 8 << "bps";
+    out << " min_rtt=" << min_rtt;
+    return out.str();
+}
+
+std::string TCPBBRStateVariables::detailedInfo() const
+{
+    std::stringstream out;
+    out << TCPBaseAlgStateVariables::detailedInfo();
+    out << "mode=" << getModeName(mode) << "\n";
+    out << "pacing_gain=" << pacing_gain << "\n";
+    out << "cwnd_gain=" << cwnd_gain << "\n";
+    out << "btl_bw=" << btl_bw_filter.get() * 8 << "bps\n";
+    out << "min_rtt=" << min_rtt << "\n";
+    out << "min_rtt_stamp=" << min_rtt_stamp << "\n";
+    out << "delivered=" << delivered << "\n";
+    out << "round_count=" << round_count << "\n";
+    out << "filled_pipe=" << filled_pipe << "\n";
+    out << "cycle_index=" << cycle_index << "\n";
+    out << "prior_cwnd=" << prior_cwnd << "\n";
+    return out.str();
+}
+
+//---
+
+TCPBBR::TCPBBR() : TCPBaseAlg(),
+  state((TCPBBRStateVariables *&)TCPAlgorithm::state)
+{
+    btlBwVector = minRttVector = modeVector = NULL;
+}
+
+TCPBBR::~TCPBBR()
+{
+    delete btlBwVector;
+    delete minRttVector;
+    delete modeVector;
+}
+
+void TCPBBR::initialize()
+{
+    TCPBaseAlg::initialize();
+
+    // the sending rate is controlled by pacing, so it is always on
+    state->pacing_enabled = true;
+
+    if (conn->getTcpMain()->recordStatistics)
+    {
+        btlBwVector = new cOutVector("bottleneck bandwidth");
+        minRttVector = new cOutVector("min RTT");
+        modeVector = new cOutVector("BBR mode");
+    }
+}
+
+uint32 TCPBBR::getBDP()
+{
+    double btlBw = state->btl_bw_filter.get();
+
+    if (btlBw == 0 || state->min_rtt == 0)
+        return 0;
+
+    return (uint32)(btlBw * state->min_rtt.dbl());
+}
+
+double TCPBBR::getPacingRate()
+{
+    double btlBw = state->btl_bw_filter.get();
+
+    if (btlBw > 0)
+        return state->pacing_gain * btlBw;
+
+    // no delivery rate sample yet: estimate the bandwidth from cwnd
+    if (state->srtt == 0)
+        return 0;
+
+    return state->pacing_gain * state->snd_cwnd / state->srtt.dbl();
+}
+
+void TCPBBR::enterMode(TCPBBRStateVariables::Mode mode)
+{
+    tcpEV << "BBR: " << getModeName(state->mode) << " -> " << getModeName(mode) << "\n";
+    state->mode = mode;
+
+    switch (mode)
+    {
+        case TCPBBRStateVariables::STARTUP:
+            state->pacing_gain = BBR_HIGH_GAIN;
+            state->cwnd_gain = BBR_HIGH_GAIN;
+            break;
+
+        case TCPBBRStateVariables::DRAIN:
+            // drain the queue created in STARTUP
+            state->pacing_gain = 1.0 / BBR_HIGH_GAIN;
+            state->cwnd_gain = BBR_HIGH_GAIN;
+            break;
+
+        case TCPBBRStateVariables::PROBE_BW:
+            // start at a random phase other than the draining one, so that
+            // flows do not probe at the same time
+            state->cycle_index = intrand(BBR_GAIN_CYCLE_LEN - 1);
+            if (state->cycle_index >= 1)
+                state->cycle_index++;
+            state->cycle_stamp = simTime();
+            state->pacing_gain = pacingGainCycle[state->cycle_index];
+            state->cwnd_gain = BBR_CWND_GAIN;
+            break;
+
+        case TCPBBRStateVariables::PROBE_RTT:
+            state->pacing_gain = 1.0;
+            state->cwnd_gain = 1.0;
+            state->probe_rtt_done_stamp = 0;
+            break;
+    }
+
+    if (modeVector)
+        modeVector->record(mode);
+}
+
+void TCPBBR::saveCongestionWindow()
+{
+    if (!state->lossRecovery && state->mode != TCPBBRStateVariables::PROBE_RTT)
+        state->prior_cwnd = state->snd_cwnd;
+    else
+        state->prior_cwnd = std::max(state->prior_cwnd, state->snd_cwnd);
+}
+
+void TCPBBR::markRetransmitted(uint32 fromSeq, uint32 toSeq)
+{
+    uint32 startSeq = state->snd_una;
+
+    for (SentRecords::iterator it = sentRecords.begin(); it != sentRecords.end(); ++it)
+    {
+        if (seqLess(startSeq, toSeq) && seqGreater(it->endSeq, fromSeq))
+            it->retransmitted = true;
+
+        startSeq = it->endSeq;
+    }
+}
+
+void TCPBBR::dataSent(uint32 fromseq)
+{
+    TCPBaseAlg::dataSent(fromseq);
+
+    simtime_t now = simTime();
+
+    // after an RTO, data already recorded is sent again
+    uint32 lastSeq = sentRecords.empty() ? fromseq : sentRecords.back().endSeq;
+    if (seqLess(fromseq, lastSeq))
+        markRetransmitted(fromseq, state->snd_nxt);
+
+    if (!seqGreater(state->snd_nxt, lastSeq))
+        return;
+
+    // delivery rate estimation: when nothing was in flight, the sending
+    // (and acknowledging) starts anew
+    if (sentRecords.empty() && fromseq == state->snd_una)
+        state->first_sent_time = state->delivered_time = now;
+
+    SentRecord record;
+    record.endSeq = state->snd_nxt;
+    record.delivered = state->delivered;
+    record.deliveredTime = state->delivered_time;
+    record.firstSentTime = state->first_sent_time;
+    record.sentTime = now;
+    record.retransmitted = false;
+    sentRecords.push_back(record);
+}
+
+void TCPBBR::updateModel(uint32 firstSeqAcked)
+{
+    simtime_t now = simTime();
+    bool minRttExpired = state->min_rtt != 0 && now > state->min_rtt_stamp + BBR_MIN_RTT_FILTER_LEN;
+
+    state->delivered += state->snd_una - firstSeqAcked;
+    state->delivered_time = now;
+    state->round_start = false;
+
+    // take the samples from the most recently sent of the transmissions
+    // acknowledged now
+    bool acked = false;
+    SentRecord record;
+    while (!sentRecords.empty() && seqLE(sentRecords.front().endSeq, state->snd_una))
+    {
+        record = sentRecords.front();
+        sentRecords.pop_front();
+        acked = true;
+    }
+
+    if (acked)
+    {
+        updateRound(record);
+        state->first_sent_time = record.sentTime;
+
+        if (!record.retransmitted)
+        {
+            updateMinRtt(now - record.sentTime, minRttExpired);
+
+            // the delivery rate is limited by both the sending and the
+            // acknowledging rate; intervals shorter than min_rtt are due to
+            // ACK compression and would overestimate it
+            simtime_t sendElapsed = record.sentTime - record.firstSentTime;
+            simtime_t ackElapsed = state->delivered_time - record.deliveredTime;
+            simtime_t interval = std::max(sendElapsed, ackElapsed);
+
+            if (interval > 0 && interval >= state->min_rtt)
+                updateBtlBw((state->delivered - record.delivered) / interval.dbl());
+        }
+    }
+
+    checkCyclePhase();
+    checkFullPipe();
+    checkDrain();
+    checkProbeRtt(minRttExpired);
+}
+
+void TCPBBR::updateRound(const SentRecord& record)
+{
+    if (record.delivered >= state->next_round_delivered)
+    {
+        state->next_round_delivered = state->delivered;
+        state->round_count++;
+        state->round_start = true;
+    }
+}
+
+void TCPBBR::updateBtlBw(double deliveryRate)
+{
+    double oldBtlBw = state->btl_bw_filter.get();
+    state->btl_bw_filter.update(deliveryRate, state->round_count);
+
+    if (btlBwVector && state->btl_bw_filter.get() != oldBtlBw)
+        btlBwVector->record(state->btl_bw_filter.get() * 8);
+}
+
+void TCPBBR::updateMinRtt(simtime_t rtt, bool minRttExpired)
+{
+    if (state->min_rtt == 0 || rtt <= state->min_rtt || minRttExpired)
+    {
+        state->min_rtt = rtt;
+        state->min_rtt_stamp = simTime();
+
+        if (minRttVector)
+            minRttVector->record(state->min_rtt);
+    }
+}
+
+void TCPBBR::checkCyclePhase()
+{
+    if (state->mode != TCPBBRStateVariables::PROBE_BW)
+        return;
+
+    simtime_t now = simTime();
+    uint32 inFlight = state->snd_max - state->snd_una;
+    bool isFullLength = now - state->cycle_stamp > state->min_rtt;
+    bool nextPhase;
+
+    if (state->pacing_gain > 1)
+        // probe for more bandwidth until the queue has built up or a loss occurs
+        nextPhase = isFullLength && (state->lossRecovery || inFlight >= state->pacing_gain * getBDP());
+    else if (state->pacing_gain < 1)
+        // drain the queue built up while probing
+        nextPhase = isFullLength || inFlight <= getBDP();
+    else
+        nextPhase = isFullLength;
+
+    if (nextPhase)
+    {
+        state->cycle_index = (state->cycle_index + 1) % BBR_GAIN_CYCLE_LEN;
+        state->cycle_stamp = now;
+        state->pacing_gain = pacingGainCycle[state->cycle_index];
+        tcpEV << "BBR: PROBE_BW phase " << state->cycle_index << ", pacing_gain=" << state->pacing_gain << "\n";
+    }
+}
+
+void TCPBBR::checkFullPipe()
+{
+    if (state->filled_pipe || !state->round_start)
+        return;
+
+    double btlBw = state->btl_bw_filter.get();
+
+    if (btlBw >= state->full_bw * BBR_FULL_BW_THRESH)
+    {
+        // still growing
+        state->full_bw = btlBw;
+        state->full_bw_count = 0;
+        return;
+    }
+
+    if (++state->full_bw_count >= BBR_FULL_BW_COUNT)
+    {
+        tcpEV << "BBR: bottleneck bandwidth has stopped growing at " << btlBw * 8 << "bps, the pipe is full\n";
+        state->filled_pipe = true;
+    }
+}
+
+void TCPBBR::checkDrain()
+{
+    if (state->mode == TCPBBRStateVariables::STARTUP && state->filled_pipe)
+        enterMode(TCPBBRStateVariables::DRAIN);
+
+    if (state->mode == TCPBBRStateVariables::DRAIN && state->snd_max - state->snd_una <= getBDP())
+        enterMode(TCPBBRStateVariables::PROBE_BW);
+}
+
+void TCPBBR::checkProbeRtt(bool minRttExpired)
+{
+    simtime_t now = simTime();
+
+    if (state->mode != TCPBBRStateVariables::PROBE_RTT && minRttExpired)
+    {
+        saveCongestionWindow();
+        enterMode(TCPBBRStateVariables::PROBE_RTT);
+    }
+
+    if (state->mode != TCPBBRStateVariables::PROBE_RTT)
+        return;
+
+    // stay for at least 200ms and one round with at most 4 segments in flight
+    if (state->probe_rtt_done_stamp == 0)
+    {
+        if (state->snd_max - state->snd_una <= BBR_MIN_PIPE_CWND * state->snd_mss)
+        {
+            state->probe_rtt_done_stamp = now + BBR_PROBE_RTT_DURATION;
+            state->probe_rtt_round_done = false;
+            state->next_round_delivered = state->delivered;
+        }
+    }
+    else
+    {
+        if (state->round_start)
+            state->probe_rtt_round_done = true;
+
+        if (state->probe_rtt_round_done && now > state->probe_rtt_done_stamp)
+        {
+            state->min_rtt_stamp = now;
+            state->snd_cwnd = std::max(state->snd_cwnd, state->prior_cwnd);
+            enterMode(state->filled_pipe ? TCPBBRStateVariables::PROBE_BW : TCPBBRStateVariables::STARTUP);
+        }
+    }
+}
+
+void TCPBBR::setCongestionWindow(uint32 bytesAcked)
+{
+    // allow for some ACK aggregation and for the segments held back by
+    // delayed ACKs and segmentation offload
+    uint32 quantum = state->offload_size ? state->offload_size : state->snd_mss;
+    uint32 bdp = getBDP();
+    uint32 targetCwnd = bdp ? (uint32)(state->cwnd_gain * bdp) + 3 * quantum : 0;
+
+    if (state->filled_pipe && targetCwnd)
+        state->snd_cwnd = std::min(state->snd_cwnd + bytesAcked, targetCwnd);
+    else if (!targetCwnd || state->snd_cwnd < targetCwnd)
+        state->snd_cwnd += bytesAcked;
+
+    state->snd_cwnd = std::max(state->snd_cwnd, BBR_MIN_PIPE_CWND * state->snd_mss);
+
+    if (state->mode == TCPBBRStateVariables::PROBE_RTT)
+        state->snd_cwnd = std::min(state->snd_cwnd, BBR_MIN_PIPE_CWND * state->snd_mss);
+
+    if (cwndVector)
+        cwndVector->record(state->snd_cwnd);
+}
+
+void TCPBBR::processRexmitTimer(TCPEventCode& event)
+{
+    TCPBaseAlg::processRexmitTimer(event);
+
+    if (event == TCP_E_ABORT)
+        return;
+
+    saveCongestionWindow();
+
+    // RFC 3782, page 6: "After a retransmit timeout, record the highest
+    // sequence number transmitted in the variable "recover" and exit the
+    // Fast Recovery procedure if applicable."
+    state->recover = (state->snd_max - 1);
+    state->lossRecovery = false;
+    state->firstPartialACK = false;
+
+    // everything outstanding will be sent again, so no samples can be taken
+    // from it; cwnd grows back by the acked bytes (see setCongestionWindow())
+    markRetransmitted(state->snd_una, state->snd_max);
+    state->snd_cwnd = state->snd_mss;
+
+    if (cwndVector)
+        cwndVector->record(state->snd_cwnd);
+
+    tcpEV << "BBR: RTO, resetting cwnd to " << state->snd_cwnd << "\n";
+
+    state->afterRto = true;
+    conn->retransmitOneSegment(true);
+}
+
+void TCPBBR::receivedDataAck(uint32 firstSeqAcked)
+{
+    TCPBaseAlg::receivedDataAck(firstSeqAcked);
+
+    uint32 bytesAcked = state->snd_una - firstSeqAcked;
+
+    updateModel(firstSeqAcked);
+
+    if (state->lossRecovery)
+    {
+        if (seqGE(state->snd_una - 1, state->recover))
+        {
+            // full ACK: the model takes over again
+            state->lossRecovery = false;
+            state->firstPartialACK = false;
+            state->snd_cwnd = state->prior_cwnd;
+            tcpEV << "Loss Recovery terminated, restoring cwnd to " << state->snd_cwnd << "\n";
+            setCongestionWindow(bytesAcked);
+        }
+        else
+        {
+            // RFC 3782 partial ACK: retransmit the first unacknowledged
+            // segment; what has been acked (minus the retransmission) has
+            // left the network and may be replaced
+            tcpEV << "Loss Recovery - Partial ACK received: retransmitting the first unacknowledged segment\n";
+            conn->retransmitOneSegment(false);
+            markRetransmitted(state->snd_una, state->snd_una + state->snd_mss);
+
+            state->snd_cwnd = state->snd_cwnd > bytesAcked ? state->snd_cwnd - bytesAcked : 0;
+            if (bytesAcked >= state->snd_mss)
+                state->snd_cwnd += state->snd_mss;
+
+            if (cwndVector)
+                cwndVector->record(state->snd_cwnd);
+
+            if (!state->firstPartialACK)
+            {
+                state->firstPartialACK = true;
+                tcpEV << "First partial ACK arrived during recovery, restarting REXMIT timer.\n";
+                restartRexmitTimer();
+            }
+        }
+    }
+    else
+    {
+        setCongestionWindow(bytesAcked);
+
+        // RFC 3782, page 13: pull "recover" along with snd_una
+        state->recover = (state->snd_una - 2);
+    }
+
+    sendData(false);
+}
+
+void TCPBBR::receivedDuplicateAck()
+{
+    TCPBaseAlg::receivedDuplicateAck();
+
+    if (state->dupacks == DUPTHRESH && !state->lossRecovery && state->snd_una - 1 > state->recover)
+    {
+        // Fast Retransmit (RFC 3782, step 1A and 2), but the model is kept:
+        // cwnd is only limited to the data in flight during the recovery
+        // (packet conservation), and restored afterwards
+        saveCongestionWindow();
+        state->recover = (state->snd_max - 1);
+        state->firstPartialACK = false;
+        state->lossRecovery = true;
+
+        state->snd_cwnd = state->snd_max - state->snd_una;
+
+        if (cwndVector)
+            cwndVector->record(state->snd_cwnd);
+
+        tcpEV << "BBR on dupAcks == DUPTHRESH(=3): perform Fast Retransmit, and enter Loss Recovery, recover=" << state->recover
+              << ", cwnd=" << state->snd_cwnd << "\n";
+
+        conn->retransmitOneSegment(false);
+        markRetransmitted(state->snd_una, state->snd_una + state->snd_mss);
+    }
+    else if (state->dupacks > DUPTHRESH && state->lossRecovery)
+    {
+        // each further duplicate ACK means a segment has left the network
+        state->snd_cwnd += state->snd_mss;
+
+        if (cwndVector)
+            cwndVector->record(state->snd_cwnd);
+
+        tcpEV << "BBR on dupAcks > DUPTHRESH(=3): Loss Recovery: inflating cwnd by SMSS, new cwnd=" << state->snd_cwnd << "\n";
+
+        sendData(false);
+    }
+}
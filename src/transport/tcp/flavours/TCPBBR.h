@@ -0,0 +1,193 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __INET_TCPBBR_H
+#define __INET_TCPBBR_H
+
+#include <deque>
+
+#include "INETDefs.h"
+
+#include "TCPBaseAlg.h"
+#include "WindowedFilter.h"
+
+
+/**
+ * State variables for TCPBBR.
+ */
+class INET_API TCPBBRStateVariables : public TCPBaseAlgStateVariables
+{
+  public:
+    enum Mode { STARTUP, DRAIN, PROBE_BW, PROBE_RTT };
+
+    TCPBBRStateVariables();
+    virtual std::string info() const;
+    virtual std::string detailedInfo() const;
+
+    Mode mode;               ///< state of the BBR state machine
+    double pacing_gain;      ///< pacing rate = pacing_gain * btl_bw
+    double cwnd_gain;        ///< cwnd = cwnd_gain * BDP (plus some allowance for ACK aggregation)
+
+    /// bottleneck bandwidth (bytes per second): windowed max of the delivery rate over 10 rounds
+    WindowedFilter<double, uint32> btl_bw_filter;
+
+    /// round-trip propagation delay: windowed min of the RTT over 10 seconds
+    //@{
+    simtime_t min_rtt;       ///< minimum RTT, 0 if none yet
+    simtime_t min_rtt_stamp; ///< when min_rtt was measured
+    //@}
+
+    /// delivery rate estimation
+    //@{
+    uint64 delivered;            ///< total bytes acknowledged
+    simtime_t delivered_time;    ///< when delivered was last updated
+    simtime_t first_sent_time;   ///< send time of the newest segment acknowledged
+    //@}
+
+    /// round counting: a round ends when data sent at its start is acknowledged
+    //@{
+    uint32 round_count;          ///< number of rounds so far
+    uint64 next_round_delivered; ///< delivered at the end of the current round
+    bool round_start;            ///< the current ACK started a new round
+    //@}
+
+    /// STARTUP: the pipe is full when btl_bw has not grown by 25% for 3 rounds
+    //@{
+    bool filled_pipe;
+    double full_bw;
+    int full_bw_count;
+    //@}
+
+    /// PROBE_BW gain cycling
+    //@{
+    int cycle_index;
+    simtime_t cycle_stamp;
+    //@}
+
+    /// PROBE_RTT
+    //@{
+    simtime_t probe_rtt_done_stamp; ///< when PROBE_RTT may end, 0 if not yet known
+    bool probe_rtt_round_done;
+    uint32 prior_cwnd;              ///< cwnd before PROBE_RTT or loss recovery
+    //@}
+};
+
+
+/**
+ * Implements a model-based congestion control in the style of BBR
+ * (Cardwell et al.: "BBR: Congestion-Based Congestion Control", 2016, and
+ * draft-cardwell-iccrg-bbr-congestion-control). Instead of reacting to
+ * losses, it keeps a model of the path: the bottleneck bandwidth
+ * (windowed max of the delivery rate samples over 10 rounds) and the
+ * round-trip propagation delay (min RTT over 10 seconds), both fed from
+ * the ACKs. Data are always paced at pacing_gain * btl_bw (see
+ * TCPBaseAlg::sendPacedData()), and cwnd is limited to cwnd_gain times the
+ * bandwidth-delay product. The state machine consists of STARTUP
+ * (exponential growth until the bandwidth stops growing), DRAIN, PROBE_BW
+ * (gain cycling 1.25, 0.75, 1, ... per min RTT) and PROBE_RTT (cwnd of
+ * 4 segments for 200ms when min RTT has not been refreshed for 10s).
+ *
+ * Delivery rate samples are taken as in draft-cheng-iccrg-delivery-rate-
+ * estimation, from a record of each transmission (one record per
+ * sendData() call, which is one segment or super-segment when paced).
+ * RTT samples are taken from the same records, so min RTT is updated on
+ * every ACK also without timestamps.
+ *
+ * Loss recovery is NewReno-like (RFC 3782) with packet conservation: on
+ * the third duplicate ACK the lost segment is retransmitted, and only as
+ * much data is sent as has left the network, until the recovery ends.
+ * After an RTO, cwnd restarts from one segment and grows by the acked
+ * bytes. SACK and app-limited detection are not implemented.
+ */
+class INET_API TCPBBR : public TCPBaseAlg
+{
+  protected:
+    /** A transmission, for delivery rate and RTT sampling. */
+    struct SentRecord
+    {
+        uint32 endSeq;             // sequence number after the data sent
+        uint64 delivered;          // delivered at the time of sending
+        simtime_t deliveredTime;   // delivered_time at the time of sending
+        simtime_t firstSentTime;   // first_sent_time at the time of sending
+        simtime_t sentTime;
+        bool retransmitted;        // (partly) retransmitted: no RTT or rate sample
+    };
+    typedef std::deque<SentRecord> SentRecords;
+
+    TCPBBRStateVariables *&state; // alias to TCPAlgorithm's 'state'
+
+    SentRecords sentRecords;  // transmissions not yet acknowledged, in sending order
+
+    cOutVector *btlBwVector;  // will record changes to the bottleneck bandwidth estimate
+    cOutVector *minRttVector; // will record changes to min RTT
+    cOutVector *modeVector;   // will record changes to the mode
+
+  protected:
+    /** Create and return a TCPBBRStateVariables object. */
+    virtual TCPStateVariables *createStateVariables() {
+        return new TCPBBRStateVariables();
+    }
+
+    /** Returns btl_bw * min_rtt in bytes, or 0 if either is unknown */
+    virtual uint32 getBDP();
+
+    /** Redefined to pace at pacing_gain * btl_bw */
+    virtual double getPacingRate();
+
+    /** @name Model update on each ACK */
+    //@{
+    virtual void updateModel(uint32 firstSeqAcked);
+    virtual void updateRound(const SentRecord& record);
+    virtual void updateBtlBw(double deliveryRate);
+    virtual void updateMinRtt(simtime_t rtt, bool minRttExpired);
+    virtual void checkFullPipe();
+    virtual void checkDrain();
+    virtual void checkCyclePhase();
+    virtual void checkProbeRtt(bool minRttExpired);
+    virtual void setCongestionWindow(uint32 bytesAcked);
+    //@}
+
+    /** Switches the state machine to the given mode, and sets the gains */
+    virtual void enterMode(TCPBBRStateVariables::Mode mode);
+
+    /** Saves cwnd before PROBE_RTT or loss recovery, to restore it afterwards */
+    virtual void saveCongestionWindow();
+
+    /** Marks the records of the transmissions overlapping [fromSeq, toSeq) as retransmitted */
+    virtual void markRetransmitted(uint32 fromSeq, uint32 toSeq);
+
+    /** Redefine what should happen on retransmission */
+    virtual void processRexmitTimer(TCPEventCode& event);
+
+  public:
+    /** Ctor */
+    TCPBBR();
+
+    virtual ~TCPBBR();
+
+    /** Redefined to enable pacing, and to create the output vectors */
+    virtual void initialize();
+
+    /** Redefined to update the model and the congestion window */
+    virtual void receivedDataAck(uint32 firstSeqAcked);
+
+    /** Redefined for fast retransmit and loss recovery */
+    virtual void receivedDuplicateAck();
+
+    /** Redefined to record the transmission */
+    virtual void dataSent(uint32 fromseq);
+};
+
+#endif
@@ -44,6 +44,7 @@
 #define MAX_REXMIT_TIMEOUT    240   // 2 * MSL (RFC 1122)
 #define MIN_PERSIST_TIMEOUT     5   //  5s
 #define MAX_PERSIST_TIMEOUT    60   // 60s
+#define PACING_CA_RATIO       1.2   // pacing rate is 120% of cwnd / srtt (as tcp_pacing_ca_ratio in Linux)
 
 TCPBaseAlgStateVariables::TCPBaseAlgStateVariables()
 {
@@ -95,7 +96,7 @@ std::string TCPBaseAlgStateVariables::detailedInfo() const
 TCPBaseAlg::TCPBaseAlg() : TCPAlgorithm(),
   state((TCPBaseAlgStateVariables *&)TCPAlgorithm::state)
 {
-    rexmitTimer = persistTimer = delayedAckTimer = keepAliveTimer = NULL;
+    rexmitTimer = persistTimer = delayedAckTimer = keepAliveTimer = pacingTimer = NULL;
     cwndVector = ssthreshVector = rttVector = srttVector = rttvarVector = rtoVector = numRtosVector = NULL;
 }
 
@@ -108,6 +109,7 @@ TCPBaseAlg::~TCPBaseAlg()
     if (persistTimer)    delete cancelEvent(persistTimer);
     if (delayedAckTimer) delete cancelEvent(delayedAckTimer);
     if (keepAliveTimer)  delete cancelEvent(keepAliveTimer);
+    if (pacingTimer)     delete cancelEvent(pacingTimer);
 
     // delete statistics objects
     delete cwndVector;
@@ -123,15 +125,17 @@ void TCPBaseAlg::initialize()
 {
     TCPAlgorithm::initialize();
 
-    rexmitTimer = new cMessage("REXMIT");
-    persistTimer = new cMessage("PERSIST");
-    delayedAckTimer = new cMessage("DELAYEDACK");
-    keepAliveTimer = new cMessage("KEEPALIVE");
+    rexmitTimer = new TCPTimer("REXMIT");
+    persistTimer = new TCPTimer("PERSIST");
+    delayedAckTimer = new TCPTimer("DELAYEDACK");
+    keepAliveTimer = new TCPTimer("KEEPALIVE");
+    pacingTimer = new TCPTimer("PACING");
 
     rexmitTimer->setContextPointer(conn);
     persistTimer->setContextPointer(conn);
     delayedAckTimer->setContextPointer(conn);
     keepAliveTimer->setContextPointer(conn);
+    pacingTimer->setContextPointer(conn);
 
     if (conn->getTcpMain()->recordStatistics)
     {
@@ -208,6 +212,7 @@ void TCPBaseAlg::connectionClosed()
     cancelEvent(persistTimer);
     cancelEvent(delayedAckTimer);
     cancelEvent(keepAliveTimer);
+    cancelEvent(pacingTimer);
 }
 
 void TCPBaseAlg::processTimer(cMessage *timer, TCPEventCode& event)
@@ -220,6 +225,8 @@ void TCPBaseAlg::processTimer(cMessage *timer, TCPEventCode& event)
         processDelayedAckTimer(event);
     else if (timer == keepAliveTimer)
         processKeepAliveTimer(event);
+    else if (timer == pacingTimer)
+        processPacingTimer(event);
     else
         throw cRuntimeError(timer, "unrecognized timer");
 }
@@ -365,6 +372,12 @@ void TCPBaseAlg::startRexmitTimer()
     conn->scheduleTimeout(rexmitTimer, state->rexmit_timeout);
 }
 
+void TCPBaseAlg::processPacingTimer(TCPEventCode& event)
+{
+    // send the next segment, if the windows allow
+    sendData(false);
+}
+
 void TCPBaseAlg::rttMeasurementComplete(simtime_t tSent, simtime_t tAcked)
 {
     //
@@ -468,6 +481,9 @@ bool TCPBaseAlg::sendData(bool sendCommandInvoked)
         }
     }
 
+    if (state->pacing_enabled)
+        return sendPacedData(fullSegmentsOnly);
+
     //
     // Send window is effectively the minimum of the congestion window (cwnd)
     // and the advertised window (snd_wnd).
@@ -475,6 +491,40 @@ bool TCPBaseAlg::sendData(bool sendCommandInvoked)
     return conn->sendData(fullSegmentsOnly, state->snd_cwnd);
 }
 
+bool TCPBaseAlg::sendPacedData(bool fullSegmentsOnly)
+{
+    // the PACING timer will send the next segment when it expires
+    if (conn->isTimerScheduled(pacingTimer))
+        return false;
+
+    double pacingRate = getPacingRate();
+
+    if (pacingRate <= 0)
+        return conn->sendData(fullSegmentsOnly, state->snd_cwnd);
+
+    // allow one segment (or super-segment) on top of the data in flight;
+    // sending starts from snd_max, if not after RTO (see TCPConnection::sendData())
+    uint32 old_snd_nxt = state->afterRto ? state->snd_nxt : state->snd_max;
+    uint32 quantum = state->offload_size ? state->offload_size : state->snd_mss;
+    uint32 window = std::min(state->snd_cwnd, (old_snd_nxt - state->snd_una) + quantum);
+
+    if (!conn->sendData(fullSegmentsOnly, window))
+        return false;
+
+    simtime_t interval = (state->snd_nxt - old_snd_nxt) / pacingRate;
+    tcpEV << "Pacing at " << pacingRate * 8 << " bps, next segment in " << interval << "s\n";
+    conn->scheduleTimeout(pacingTimer, interval);
+    return true;
+}
+
+double TCPBaseAlg::getPacingRate()
+{
+    if (state->srtt == 0)
+        return 0;
+
+    return PACING_CA_RATIO * state->snd_cwnd / state->srtt.dbl();
+}
+
 void TCPBaseAlg::sendCommandInvoked()
 {
     // try sending
@@ -491,7 +541,7 @@ void TCPBaseAlg::receivedOutOfOrderSegment()
 void TCPBaseAlg::receiveSeqChanged()
 {
     // If we send a data segment already (with the updated seqNo) there is no need to send an additional ACK
-    if (state->full_sized_segment_counter == 0 && !state->ack_now && state->last_ack_sent == state->rcv_nxt && !delayedAckTimer->isScheduled()) // ackSent?
+    if (state->full_sized_segment_counter == 0 && !state->ack_now && state->last_ack_sent == state->rcv_nxt && !conn->isTimerScheduled(delayedAckTimer)) // ackSent?
     {
         // tcpEV << "ACK has already been sent (possibly piggybacked on data)\n";
     }
@@ -527,7 +577,7 @@ void TCPBaseAlg::receiveSeqChanged()
             else
             {
                 tcpEV << "rcv_nxt changed to " << state->rcv_nxt << ", (delayed ACK enabled and full_sized_segment_counter=" << state->full_sized_segment_counter << ") scheduling ACK\n";
-                if (!delayedAckTimer->isScheduled()) // schedule delayed ACK timer if not already running
+                if (!conn->isTimerScheduled(delayedAckTimer)) // schedule delayed ACK timer if not already running
                     conn->scheduleTimeout(delayedAckTimer, DELAYED_ACK_TIMEOUT);
             }
         }
@@ -559,7 +609,7 @@ void TCPBaseAlg::receivedDataAck(uint32 firstSeqAcked)
     //
     if (state->snd_una == state->snd_max)
     {
-        if (rexmitTimer->isScheduled())
+        if (conn->isTimerScheduled(rexmitTimer))
         {
             tcpEV << "ACK acks all outstanding segments, cancel REXMIT timer\n";
             cancelEvent(rexmitTimer);
@@ -572,7 +622,6 @@ void TCPBaseAlg::receivedDataAck(uint32 firstSeqAcked)
         tcpEV << "ACK acks some but not all outstanding segments ("
               << (state->snd_max - state->snd_una) << " bytes outstanding), "
               << "restarting REXMIT timer\n";
-        cancelEvent(rexmitTimer);
         startRexmitTimer();
     }
 
@@ -587,9 +636,9 @@ void TCPBaseAlg::receivedDataAck(uint32 firstSeqAcked)
     //
     if (state->snd_wnd == 0) // received zero-sized window?
     {
-        if (rexmitTimer->isScheduled())
+        if (conn->isTimerScheduled(rexmitTimer))
         {
-            if (persistTimer->isScheduled())
+            if (conn->isTimerScheduled(persistTimer))
             {
                 tcpEV << "Received zero-sized window and REXMIT timer is running therefore PERSIST timer is canceled.\n";
                 cancelEvent(persistTimer);
@@ -600,7 +649,7 @@ void TCPBaseAlg::receivedDataAck(uint32 firstSeqAcked)
         }
         else
         {
-            if (!persistTimer->isScheduled())
+            if (!conn->isTimerScheduled(persistTimer))
             {
                 tcpEV << "Received zero-sized window therefore PERSIST timer is started.\n";
                 conn->scheduleTimeout(persistTimer, state->persist_timeout);
@@ -611,7 +660,7 @@ void TCPBaseAlg::receivedDataAck(uint32 firstSeqAcked)
     }
     else // received non zero-sized window?
     {
-        if (persistTimer->isScheduled())
+        if (conn->isTimerScheduled(persistTimer))
         {
             tcpEV << "Received non zero-sized window therefore PERSIST timer is canceled.\n";
             cancelEvent(persistTimer);
@@ -628,6 +677,19 @@ void TCPBaseAlg::receivedDataAck(uint32 firstSeqAcked)
     //
 }
 
+uint32 TCPBaseAlg::getNumAcks(uint32 firstSeqAcked)
+{
+    if (!state->offload_size)
+        return 1;
+
+    uint32 numSegments = (state->snd_una - firstSeqAcked + state->snd_mss - 1) / state->snd_mss;
+
+    if (state->delayed_acks_enabled)
+        numSegments = (numSegments + 1) / 2;
+
+    return std::max(numSegments, (uint32)1);
+}
+
 void TCPBaseAlg::receivedDuplicateAck()
 {
     tcpEV << "Duplicate ACK #" << state->dupacks << "\n";
@@ -662,14 +724,14 @@ void TCPBaseAlg::ackSent()
     state->ack_now = false; // reset flag
     state->last_ack_sent = state->rcv_nxt; // update last_ack_sent, needed for TS option
     // if delayed ACK timer is running, cancel it
-    if (delayedAckTimer->isScheduled())
+    if (conn->isTimerScheduled(delayedAckTimer))
         cancelEvent(delayedAckTimer);
 }
 
 void TCPBaseAlg::dataSent(uint32 fromseq)
 {
     // if retransmission timer not running, schedule it
-    if (!rexmitTimer->isScheduled())
+    if (!conn->isTimerScheduled(rexmitTimer))
     {
         tcpEV << "Starting REXMIT timer\n";
         startRexmitTimer();
@@ -692,8 +754,6 @@ void TCPBaseAlg::dataSent(uint32 fromseq)
 
 void TCPBaseAlg::restartRexmitTimer()
 {
-    if (rexmitTimer->isScheduled())
-        cancelEvent(rexmitTimer);
-
+    // scheduleTimeout() restarts a running timer
     startRexmitTimer();
 }
@@ -87,6 +87,7 @@ class INET_API TCPBaseAlgStateVariables : public TCPStateVariables
  *   - Nagle's algorithm (RFC 896) to prevent silly window syndrome
  *   - Increased Initial Window (RFC 3390)
  *   - PERSIST timer
+ *   - pacing of new data (optional)
  *
  * To be done:
  *   - KEEP-ALIVE timer
@@ -109,6 +110,7 @@ class INET_API TCPBaseAlg : public TCPAlgorithm
     cMessage *persistTimer;
     cMessage *delayedAckTimer;
     cMessage *keepAliveTimer;
+    cMessage *pacingTimer;
 
     cOutVector *cwndVector;  // will record changes to snd_cwnd
     cOutVector *ssthreshVector; // will record changes to ssthresh
@@ -119,12 +121,13 @@ class INET_API TCPBaseAlg : public TCPAlgorithm
     cOutVector *numRtosVector; // will record total number of RTOs
 
   protected:
-    /** @name Process REXMIT, PERSIST, DELAYED-ACK and KEEP-ALIVE timers */
+    /** @name Process REXMIT, PERSIST, DELAYED-ACK, KEEP-ALIVE and PACING timers */
     //@{
     virtual void processRexmitTimer(TCPEventCode& event);
     virtual void processPersistTimer(TCPEventCode& event);
     virtual void processDelayedAckTimer(TCPEventCode& event);
     virtual void processKeepAliveTimer(TCPEventCode& event);
+    virtual void processPacingTimer(TCPEventCode& event);
     //@}
 
     /**
@@ -150,8 +153,33 @@ class INET_API TCPBaseAlg : public TCPAlgorithm
      */
     virtual bool sendData(bool sendCommandInvoked);
 
+    /**
+     * Sends one segment (or super-segment) of new data if the PACING timer
+     * is not running, and starts the timer for the time it takes to send
+     * that data at getPacingRate(). Called from sendData() if pacing is
+     * enabled.
+     */
+    virtual bool sendPacedData(bool fullSegmentsOnly);
+
+    /**
+     * Returns the pacing rate in bytes per second, or 0 if it is unknown
+     * (no RTT measurement yet). This implementation returns
+     * 1.2 * cwnd / srtt; subclasses that know about slow start may redefine
+     * it to pace faster during slow start.
+     */
+    virtual double getPacingRate();
+
+    /**
+     * Returns the number of ACKs that the ACK of the data from firstSeqAcked
+     * up to snd_una stands for. This is 1, except with segmentation offload:
+     * the receiver acknowledges a super-segment with one ACK, where it would
+     * have acknowledged every segment (or every second segment with delayed
+     * ACKs, assumed to be configured alike at both ends) otherwise.
+     */
+    virtual uint32 getNumAcks(uint32 firstSeqAcked);
+
     /** Utility function */
-    cMessage *cancelEvent(cMessage *msg) {return conn->getTcpMain()->cancelEvent(msg);}
+    cMessage *cancelEvent(cMessage *msg) {return conn->getTcpMain()->cancelTimer(msg);}
 
   public:
     /**
@@ -174,7 +202,7 @@ class INET_API TCPBaseAlg : public TCPAlgorithm
     virtual void connectionClosed();
 
     /**
-     * Process REXMIT, PERSIST, DELAYED-ACK and KEEP-ALIVE timers.
+     * Process REXMIT, PERSIST, DELAYED-ACK, KEEP-ALIVE and PACING timers.
      */
     virtual void processTimer(cMessage *timer, TCPEventCode& event);
 
@@ -0,0 +1,279 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <algorithm>   // min,max
+#include <math.h>
+
+#include "TCPCubic.h"
+#include "TCP.h"
+
+
+#define CUBIC_C                 0.4     // scaling constant (RFC 8312)
+#define CUBIC_BETA              0.7     // multiplicative decrease factor (RFC 8312)
+#define CUBIC_MAX_INCREASE      1.5     // target window is at most 1.5 * cwnd per RTT (as in Linux)
+#define CUBIC_MIN_INCREASE      0.01    // increase per RTT near the plateau, in segments (as in Linux)
+
+#define HYSTART_LOW_WINDOW      16      // HyStart is only active above 16 segments
+#define HYSTART_MIN_SAMPLES     8       // RTT samples per round needed for delay detection
+#define HYSTART_ACK_DELTA       0.002   // 2ms: ACKs closer than this belong to the same ACK train
+#define HYSTART_DELAY_MIN       0.004   // 4ms: lower bound of the delay increase threshold
+#define HYSTART_DELAY_MAX       0.016   // 16ms: upper bound of the delay increase threshold
+
+Register_Class(TCPCubic);
+
+
+TCPCubicStateVariables::TCPCubicStateVariables()
+{
+    w_max = 0;
+    epoch_start = 0;
+    origin_point = 0;
+    k = 0;
+    w_est = 0;
+    cwnd_fraction = 0;
+    min_rtt = 0;
+
+    round_end = 0;
+    round_start = 0;
+    last_ack_time = 0;
+    curr_round_min_rtt = 0;
+    num_rtt_samples = 0;
+}
+
+std::string TCPCubicStateVariables::info() const
+{
+    std::stringstream out;
+    out << TCPRenoStateVariables::info();
+    out << " w_max=" << w_max;
+    return out.str();
+}
+
+std::string TCPCubicStateVariables::detailedInfo() const
+{
+    std::stringstream out;
+    out << TCPRenoStateVariables::detailedInfo();
+    out << "w_max=" << w_max << "\n";
+    out << "epoch_start=" << epoch_start << "\n";
+    out << "origin_point=" << origin_point << "\n";
+    out << "k=" << k << "\n";
+    out << "w_est=" << w_est << "\n";
+    out << "min_rtt=" << min_rtt << "\n";
+    out << "round_end=" << round_end << "\n";
+    out << "curr_round_min_rtt=" << curr_round_min_rtt << "\n";
+    return out.str();
+}
+
+//---
+
+TCPCubic::TCPCubic() : TCPReno(),
+  state((TCPCubicStateVariables *&)TCPAlgorithm::state)
+{
+}
+
+double TCPCubic::computeK(double wMax, double cwnd)
+{
+    if (wMax <= cwnd)
+        return 0;
+
+    return pow((wMax - cwnd) / CUBIC_C, 1.0 / 3.0);
+}
+
+double TCPCubic::computeWindow(double t, double k, double wMax)
+{
+    double d = t - k;
+    return CUBIC_C * d * d * d + wMax;
+}
+
+void TCPCubic::established(bool active)
+{
+    TCPReno::established(active);
+
+    // the first HyStart round ends when the initial window is acknowledged
+    state->round_end = state->snd_max;
+    state->round_start = state->last_ack_time = simTime();
+}
+
+void TCPCubic::recalculateSlowStartThreshold()
+{
+    // RFC 8312, page 7: "When a packet loss is detected by duplicate ACKs or
+    // a network congestion is detected by ECN-Echo ACKs, CUBIC updates its
+    // W_max, cwnd, and ssthresh as follows. Parameter beta_cubic SHOULD be
+    // set to 0.7.
+    //
+    //   W_max = cwnd;                 // save window size before reduction
+    //   ssthresh = cwnd * beta_cubic; // new slow-start threshold
+    //   ssthresh = max(ssthresh, 2);  // threshold is at least 2 MSS
+    //   cwnd = cwnd * beta_cubic;     // window reduction"
+    //
+    // As in TCPReno, the window is not allowed to exceed the advertised window.
+    double cwnd = (double)std::min(state->snd_cwnd, state->snd_wnd) / state->snd_mss;
+
+    // RFC 8312, page 9: fast convergence. "With fast convergence, when a
+    // congestion event occurs, before the window reduction of the congestion
+    // window, a flow remembers the last value of W_max before it updates
+    // W_max for the current congestion event. (...)
+    //
+    //   if (W_max < W_last_max) {                   // should we make room for others
+    //       W_last_max = W_max;                     // remember the last W_max
+    //       W_max = W_max*(1.0+beta_cubic)/2.0;     // further reduce W_max
+    //   } else {
+    //       W_last_max = W_max                      // remember the last W_max
+    //   }"
+    //
+    // As in Linux, the window at the congestion event is compared to the
+    // last W_max directly, so W_last_max is not needed.
+    if (cwnd < state->w_max)
+        state->w_max = cwnd * (1.0 + CUBIC_BETA) / 2.0;
+    else
+        state->w_max = cwnd;
+
+    // a new epoch starts with the next increase of the window
+    state->epoch_start = 0;
+
+    state->ssthresh = std::max((uint32)(cwnd * CUBIC_BETA * state->snd_mss), 2 * state->snd_mss);
+
+    if (ssthreshVector)
+        ssthreshVector->record(state->ssthresh);
+
+    tcpEV << "CUBIC: w_max=" << state->w_max << " segments, ssthresh=" << state->ssthresh << "\n";
+}
+
+void TCPCubic::exitSlowStart(const char *reason)
+{
+    tcpEV << "HyStart: " << reason << ", leaving Slow Start at cwnd=" << state->snd_cwnd << "\n";
+    state->ssthresh = state->snd_cwnd;
+
+    if (ssthreshVector)
+        ssthreshVector->record(state->ssthresh);
+}
+
+void TCPCubic::increaseCongestionWindow(uint32 firstSeqAcked)
+{
+    simtime_t now = simTime();
+
+    if (state->snd_cwnd < state->ssthresh)
+    {
+        // HyStart: a round ends when the data sent at its start is acknowledged
+        if (seqGE(state->snd_una, state->round_end))
+        {
+            state->round_end = state->snd_max;
+            state->round_start = state->last_ack_time = now;
+            state->curr_round_min_rtt = 0;
+            state->num_rtt_samples = 0;
+        }
+        // HyStart ACK train detection: the ACKs of a round arrive back to back
+        // at the bottleneck rate; if this train is as long as half of the
+        // minimum RTT, the window has reached the bandwidth-delay product
+        else if (state->snd_cwnd >= HYSTART_LOW_WINDOW * state->snd_mss
+                 && now - state->last_ack_time <= HYSTART_ACK_DELTA)
+        {
+            state->last_ack_time = now;
+
+            if (state->min_rtt != 0 && now - state->round_start > state->min_rtt / 2)
+            {
+                exitSlowStart("ACK train is longer than min_rtt/2");
+                return;
+            }
+        }
+
+        TCPReno::increaseCongestionWindow(firstSeqAcked);
+        return;
+    }
+
+    //
+    // Congestion avoidance (RFC 8312, sections 4.1 to 4.4)
+    //
+    uint32 numAcks = getNumAcks(firstSeqAcked);
+    double cwnd = (double)state->snd_cwnd / state->snd_mss;
+
+    if (state->epoch_start == 0)
+    {
+        state->epoch_start = now;
+        state->k = computeK(state->w_max, cwnd);
+        state->origin_point = std::max(state->w_max, cwnd);
+        state->w_est = cwnd;
+    }
+
+    // the window the cubic function will reach one RTT from now
+    simtime_t rtt = state->min_rtt != 0 ? state->min_rtt : state->srtt;
+    double t = (now - state->epoch_start + rtt).dbl();
+    double target = computeWindow(t, state->k, state->origin_point);
+
+    // RFC 8312, page 8: "W_est(t) = W_max*beta_cubic +
+    // [3*(1-beta_cubic)/(1+beta_cubic)] * (t/RTT) (...)
+    // If W_cubic(t) is less than W_est(t), then the protocol is in the TCP
+    // friendly region and cwnd SHOULD be set to W_est(t) at each reception
+    // of an ACK." W_est is maintained per ACK, as in Linux.
+    state->w_est += numAcks * 3.0 * (1.0 - CUBIC_BETA) / (1.0 + CUBIC_BETA) / cwnd;
+
+    double increase; // in segments
+    if (target < state->w_est)
+    {
+        tcpEV << "CUBIC: TCP friendly region, ";
+        increase = state->w_est - cwnd;
+    }
+    else
+    {
+        // concave or convex region: "cwnd MUST be incremented by
+        // (W_cubic(t+RTT) - cwnd)/cwnd for each received ACK"
+        tcpEV << "CUBIC: " << (t < state->k ? "concave" : "convex") << " region, ";
+        target = std::min(target, CUBIC_MAX_INCREASE * cwnd);
+        increase = target > cwnd ? numAcks * (target - cwnd) / cwnd : numAcks * CUBIC_MIN_INCREASE / cwnd;
+    }
+
+    if (increase > 0)
+    {
+        // cwnd is in bytes: carry over the fraction of a byte to the next ACK
+        state->cwnd_fraction += increase * state->snd_mss;
+        uint32 bytes = (uint32)state->cwnd_fraction;
+        state->cwnd_fraction -= bytes;
+        state->snd_cwnd += bytes;
+    }
+
+    if (cwndVector)
+        cwndVector->record(state->snd_cwnd);
+
+    tcpEV << "target=" << target << " segments, w_est=" << state->w_est << " segments, cwnd=" << state->snd_cwnd << "\n";
+}
+
+void TCPCubic::rttMeasurementComplete(simtime_t tSent, simtime_t tAcked)
+{
+    TCPReno::rttMeasurementComplete(tSent, tAcked);
+
+    simtime_t rtt = tAcked - tSent;
+
+    if (state->min_rtt == 0 || rtt < state->min_rtt)
+        state->min_rtt = rtt;
+
+    // HyStart delay increase detection: the RTT grows once the bottleneck
+    // queue starts to fill
+    if (state->snd_cwnd < state->ssthresh && state->snd_cwnd >= HYSTART_LOW_WINDOW * state->snd_mss)
+    {
+        if (state->curr_round_min_rtt == 0 || rtt < state->curr_round_min_rtt)
+            state->curr_round_min_rtt = rtt;
+
+        if (++state->num_rtt_samples >= HYSTART_MIN_SAMPLES)
+        {
+            simtime_t threshold = state->min_rtt / 8;
+
+            if (threshold < HYSTART_DELAY_MIN)
+                threshold = HYSTART_DELAY_MIN;
+            else if (threshold > HYSTART_DELAY_MAX)
+                threshold = HYSTART_DELAY_MAX;
+
+            if (state->curr_round_min_rtt > state->min_rtt + threshold)
+                exitSlowStart("RTT increased above min_rtt + delay threshold");
+        }
+    }
+}
@@ -0,0 +1,106 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __INET_TCPCUBIC_H
+#define __INET_TCPCUBIC_H
+
+#include "INETDefs.h"
+
+#include "TCPReno.h"
+
+
+/**
+ * State variables for TCPCubic. Windows are in segments (of snd_mss bytes).
+ */
+class INET_API TCPCubicStateVariables : public TCPRenoStateVariables
+{
+  public:
+    TCPCubicStateVariables();
+    virtual std::string info() const;
+    virtual std::string detailedInfo() const;
+
+    double w_max;           ///< window before the last reduction (W_max in RFC 8312)
+    simtime_t epoch_start;  ///< start of the current congestion avoidance epoch, 0 if none
+    double origin_point;    ///< window at the plateau of the cubic function
+    double k;               ///< time from epoch_start to the plateau (K in RFC 8312)
+    double w_est;           ///< window of the standard TCP with the same beta (W_est in RFC 8312)
+    double cwnd_fraction;   ///< fractional bytes of cwnd increases not yet applied
+    simtime_t min_rtt;      ///< minimum of the RTT samples, 0 if none yet
+
+    // HyStart
+    uint32 round_end;             ///< snd_max at the start of the current round
+    simtime_t round_start;        ///< start of the current round
+    simtime_t last_ack_time;      ///< arrival of the last ACK of the current ACK train
+    simtime_t curr_round_min_rtt; ///< minimum RTT in the current round, 0 if none yet
+    uint32 num_rtt_samples;       ///< number of RTT samples in the current round
+};
+
+
+/**
+ * Implements CUBIC (RFC 8312): TCPReno with a window growth in congestion
+ * avoidance that is a cubic function of the time since the last reduction,
+ * with the plateau at the window before the reduction, and a multiplicative
+ * decrease factor of 0.7. Fast convergence and the TCP-friendly region are
+ * included.
+ *
+ * Slow start is left before losses occur with HyStart (Ha and Rhee, 2011),
+ * when either the ACK train of a round lasts for half of the minimum RTT,
+ * or the RTT of the round has increased above the minimum RTT by 1/8 of it
+ * (clamped to 4..16ms). The latter needs several RTT samples per round,
+ * i.e. the timestamps option.
+ */
+class INET_API TCPCubic : public TCPReno
+{
+  protected:
+    TCPCubicStateVariables *&state; // alias to TCPAlgorithm's 'state'
+
+    /** Create and return a TCPCubicStateVariables object. */
+    virtual TCPStateVariables *createStateVariables() {
+        return new TCPCubicStateVariables();
+    }
+
+    /** Redefined to reduce the window to 0.7 of its size and remember W_max */
+    virtual void recalculateSlowStartThreshold();
+
+    /** Redefined for HyStart and the cubic growth in congestion avoidance */
+    virtual void increaseCongestionWindow(uint32 firstSeqAcked);
+
+    /** Redefined to keep track of the minimum RTT, and for HyStart */
+    virtual void rttMeasurementComplete(simtime_t tSent, simtime_t tAcked);
+
+    /** Ends slow start by setting ssthresh to cwnd */
+    virtual void exitSlowStart(const char *reason);
+
+  public:
+    /** Ctor */
+    TCPCubic();
+
+    /** Redefined to start the first HyStart round */
+    virtual void established(bool active);
+
+    /**
+     * Returns the time the window needs to grow from cwnd to wMax (both
+     * in segments) after a reduction: K = cubic_root((wMax - cwnd) / C).
+     */
+    static double computeK(double wMax, double cwnd);
+
+    /**
+     * Returns the window (in segments) at time t (in seconds) since the
+     * start of the epoch: W_cubic(t) = C * (t - K)^3 + wMax.
+     */
+    static double computeWindow(double t, double k, double wMax);
+};
+
+#endif
@@ -0,0 +1,130 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <algorithm>   // min,max
+
+#include "TCPDCTCP.h"
+#include "TCP.h"
+
+
+#define DCTCP_G     0.0625  // estimation gain g = 1/16 (RFC 8257)
+
+Register_Class(TCPDCTCP);
+
+
+TCPDCTCPStateVariables::TCPDCTCPStateVariables()
+{
+    // RFC 8257, section 3.3: "DCTCP.Alpha [...] is initialized to 1"
+    dctcp_alpha = 1.0;
+    window_end = 0;
+    bytes_acked = 0;
+    bytes_marked = 0;
+}
+
+std::string TCPDCTCPStateVariables::info() const
+{
+    std::stringstream out;
+    out << TCPRenoStateVariables::info();
+    out << " alpha=" << dctcp_alpha;
+    return out.str();
+}
+
+std::string TCPDCTCPStateVariables::detailedInfo() const
+{
+    std::stringstream out;
+    out << TCPRenoStateVariables::detailedInfo();
+    out << "dctcp_alpha=" << dctcp_alpha << "\n";
+    out << "window_end=" << window_end << "\n";
+    out << "bytes_acked=" << bytes_acked << "\n";
+    out << "bytes_marked=" << bytes_marked << "\n";
+    return out.str();
+}
+
+//---
+
+TCPDCTCP::TCPDCTCP() : TCPReno(),
+  state((TCPDCTCPStateVariables *&)TCPAlgorithm::state)
+{
+    alphaVector = NULL;
+}
+
+TCPDCTCP::~TCPDCTCP()
+{
+    delete alphaVector;
+}
+
+void TCPDCTCP::initialize()
+{
+    TCPReno::initialize();
+
+    // RFC 8257, section 3.2: the receiver sets ECN-Echo on exactly the
+    // ACKs of CE-marked segments, instead of latching it until CWR
+    state->ecn_support = true;
+    state->ecn_precise_echo = true;
+
+    if (conn->getTcpMain()->recordStatistics)
+        alphaVector = new cOutVector("DCTCP alpha");
+}
+
+void TCPDCTCP::established(bool active)
+{
+    TCPReno::established(active);
+
+    state->window_end = state->snd_max;
+}
+
+void TCPDCTCP::receivedDataAck(uint32 firstSeqAcked)
+{
+    // RFC 8257, section 3.3: count the acknowledged and the marked bytes,
+    // and update alpha at the end of each observation window:
+    //
+    //   F = DCTCP.BytesMarked / DCTCP.BytesAcked
+    //   DCTCP.Alpha = DCTCP.Alpha * (1 - g) + g * F
+    uint32 bytesAcked = state->snd_una - firstSeqAcked;
+    state->bytes_acked += bytesAcked;
+    if (state->ece_rcvd)
+        state->bytes_marked += bytesAcked;
+
+    if (state->ecn_enabled && seqGE(state->snd_una, state->window_end))
+    {
+        double f = state->bytes_acked > 0 ? (double)state->bytes_marked / state->bytes_acked : 0;
+        state->dctcp_alpha = state->dctcp_alpha * (1 - DCTCP_G) + DCTCP_G * f;
+
+        if (alphaVector)
+            alphaVector->record(state->dctcp_alpha);
+
+        state->window_end = state->snd_max;
+        state->bytes_acked = state->bytes_marked = 0;
+    }
+
+    TCPReno::receivedDataAck(firstSeqAcked);
+}
+
+void TCPDCTCP::reduceCongestionWindowOnEcn()
+{
+    // RFC 8257, section 3.3: "cwnd = cwnd * (1 - DCTCP.Alpha / 2)"
+    // As in TCPReno, ssthresh is set to the reduced window, and it is kept
+    // at 2*SMSS at least.
+    uint32 cwnd = std::min(state->snd_cwnd, state->snd_wnd);
+    state->ssthresh = std::max((uint32)(cwnd * (1 - state->dctcp_alpha / 2)), 2 * state->snd_mss);
+    state->snd_cwnd = state->ssthresh;
+
+    if (cwndVector)
+        cwndVector->record(state->snd_cwnd);
+    if (ssthreshVector)
+        ssthreshVector->record(state->ssthresh);
+
+    tcpEV << "ECN-Echo received: alpha=" << state->dctcp_alpha << ", setting cwnd to ssthresh=" << state->ssthresh << "\n";
+}
@@ -0,0 +1,88 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __INET_TCPDCTCP_H
+#define __INET_TCPDCTCP_H
+
+#include "INETDefs.h"
+
+#include "TCPReno.h"
+
+
+/**
+ * State variables for TCPDCTCP.
+ */
+class INET_API TCPDCTCPStateVariables : public TCPRenoStateVariables
+{
+  public:
+    TCPDCTCPStateVariables();
+    virtual std::string info() const;
+    virtual std::string detailedInfo() const;
+
+    double dctcp_alpha;     ///< estimated fraction of marked bytes (DCTCP.Alpha in RFC 8257)
+    uint32 window_end;      ///< end of the current observation window (DCTCP.WindowEnd)
+    uint32 bytes_acked;     ///< bytes acked in the current observation window (DCTCP.BytesAcked)
+    uint32 bytes_marked;    ///< bytes acked with ECN-Echo in the current observation window (DCTCP.BytesMarked)
+};
+
+
+/**
+ * Implements Data Center TCP (RFC 8257): TCPReno which, instead of halving
+ * the window once per window of data when ECN-Echo is received, reduces
+ * it in proportion to the extent of congestion:
+ * cwnd = cwnd * (1 - alpha / 2), where alpha is a moving average (with
+ * gain g = 1/16) of the fraction of bytes acknowledged with ECN-Echo per
+ * window of data. Reaction to loss is the same as in TCPReno.
+ *
+ * DCTCP turns on ECN (see the ecnSupport parameter of TCP) and the precise
+ * ECN-Echo feedback of RFC 8257, section 3.2 on both sides of the
+ * connection, so the receiver should also use TCPDCTCP. It needs a queue
+ * that marks packets above a threshold of the instantaneous queue length,
+ * e.g. ~REDQueue with useEcn=true, wq=1 and minth=maxth=K. If the peer does
+ * not negotiate ECN, it behaves like TCPReno.
+ */
+class INET_API TCPDCTCP : public TCPReno
+{
+  protected:
+    TCPDCTCPStateVariables *&state; // alias to TCPAlgorithm's 'state'
+
+    cOutVector *alphaVector;  // will record changes to dctcp_alpha
+
+    /** Create and return a TCPDCTCPStateVariables object. */
+    virtual TCPStateVariables *createStateVariables() {
+        return new TCPDCTCPStateVariables();
+    }
+
+    /** Redefined to reduce the window in proportion to alpha */
+    virtual void reduceCongestionWindowOnEcn();
+
+  public:
+    /** Ctor */
+    TCPDCTCP();
+
+    /** Dtor */
+    virtual ~TCPDCTCP();
+
+    /** Redefined to enable ECN and create the alpha vector */
+    virtual void initialize();
+
+    /** Redefined to start the first observation window */
+    virtual void established(bool active);
+
+    /** Redefined to update alpha once per window of data */
+    virtual void receivedDataAck(uint32 firstSeqAcked);
+};
+
+#endif
@@ -207,15 +207,21 @@ void TCPNewReno::receivedDataAck(uint32 firstSeqAcked)
     else
     {
         //
-        // Perform slow start and congestion avoidance.
+        // Perform slow start and congestion avoidance, unless the ACK carries ECN-Echo
+        // (then cwnd has been reduced at most once per window, and is not increased).
         //
-        if (state->snd_cwnd < state->ssthresh)
+        if (processEcnEcho())
+        {
+            tcpEV << "ACK with ECN-Echo: not increasing cwnd\n";
+        }
+        else if (state->snd_cwnd < state->ssthresh)
         {
             tcpEV << "cwnd <= ssthresh: Slow Start: increasing cwnd by SMSS bytes to ";
 
             // perform Slow Start. RFC 2581: "During slow start, a TCP increments cwnd
             // by at most SMSS bytes for each ACK received that acknowledges new data."
-            state->snd_cwnd += state->snd_mss;
+            // (With segmentation offload, one ACK may stand for several.)
+            state->snd_cwnd += getNumAcks(firstSeqAcked) * state->snd_mss;
 
             // Note: we could increase cwnd based on the number of bytes being
             // acknowledged by each arriving ACK, rather than by the number of ACKs
@@ -235,13 +241,18 @@ void TCPNewReno::receivedDataAck(uint32 firstSeqAcked)
         }
         else
         {
-            // perform Congestion Avoidance (RFC 2581)
-            uint32 incr = state->snd_mss * state->snd_mss / state->snd_cwnd;
+            // perform Congestion Avoidance (RFC 2581) for each ACK this ACK stands for
+            uint32 numAcks = getNumAcks(firstSeqAcked);
 
-            if (incr == 0)
-                incr = 1;
+            for (uint32 i = 0; i < numAcks; i++)
+            {
+                uint32 incr = state->snd_mss * state->snd_mss / state->snd_cwnd;
+
+                if (incr == 0)
+                    incr = 1;
 
-            state->snd_cwnd += incr;
+                state->snd_cwnd += incr;
+            }
 
             if (cwndVector)
                 cwndVector->record(state->snd_cwnd);
@@ -101,58 +101,17 @@ void TCPReno::receivedDataAck(uint32 firstSeqAcked)
         if (cwndVector)
             cwndVector->record(state->snd_cwnd);
     }
+    else if (processEcnEcho())
+    {
+        // cwnd has been reduced (at most once per window), and is not increased
+        tcpEV << "ACK with ECN-Echo: not increasing cwnd\n";
+    }
     else
     {
         //
         // Perform slow start and congestion avoidance.
         //
-        if (state->snd_cwnd < state->ssthresh)
-        {
-            tcpEV << "cwnd <= ssthresh: Slow Start: increasing cwnd by one SMSS bytes to ";
-
-            // perform Slow Start. RFC 2581: "During slow start, a TCP increments cwnd
-            // by at most SMSS bytes for each ACK received that acknowledges new data."
-            state->snd_cwnd += state->snd_mss;
-
-            // Note: we could increase cwnd based on the number of bytes being
-            // acknowledged by each arriving ACK, rather than by the number of ACKs
-            // that arrive. This is called "Appropriate Byte Counting" (ABC) and is
-            // described in RFC 3465. This RFC is experimental and probably not
-            // implemented in real-life TCPs, hence it's commented out. Also, the ABC
-            // RFC would require other modifications as well in addition to the
-            // two lines below.
-            //
-            // int bytesAcked = state->snd_una - firstSeqAcked;
-            // state->snd_cwnd += bytesAcked * state->snd_mss;
-
-            if (cwndVector)
-                cwndVector->record(state->snd_cwnd);
-
-            tcpEV << "cwnd=" << state->snd_cwnd << "\n";
-        }
-        else
-        {
-            // perform Congestion Avoidance (RFC 2581)
-            uint32 incr = state->snd_mss * state->snd_mss / state->snd_cwnd;
-
-            if (incr == 0)
-                incr = 1;
-
-            state->snd_cwnd += incr;
-
-            if (cwndVector)
-                cwndVector->record(state->snd_cwnd);
-
-            //
-            // Note: some implementations use extra additive constant mss / 8 here
-            // which is known to be incorrect (RFC 2581 p5)
-            //
-            // Note 2: RFC 3465 (experimental) "Appropriate Byte Counting" (ABC)
-            // would require maintaining a bytes_acked variable here which we don't do
-            //
-
-            tcpEV << "cwnd > ssthresh: Congestion Avoidance: increasing cwnd linearly, to " << state->snd_cwnd << "\n";
-        }
+        increaseCongestionWindow(firstSeqAcked);
     }
 
     if (state->sack_enabled && state->lossRecovery)
@@ -205,6 +164,63 @@ void TCPReno::receivedDataAck(uint32 firstSeqAcked)
     sendData(false);
 }
 
+void TCPReno::increaseCongestionWindow(uint32 firstSeqAcked)
+{
+    if (state->snd_cwnd < state->ssthresh)
+    {
+        tcpEV << "cwnd <= ssthresh: Slow Start: increasing cwnd by one SMSS bytes to ";
+
+        // perform Slow Start. RFC 2581: "During slow start, a TCP increments cwnd
+        // by at most SMSS bytes for each ACK received that acknowledges new data."
+        // (With segmentation offload, one ACK may stand for several.)
+        state->snd_cwnd += getNumAcks(firstSeqAcked) * state->snd_mss;
+
+        // Note: we could increase cwnd based on the number of bytes being
+        // acknowledged by each arriving ACK, rather than by the number of ACKs
+        // that arrive. This is called "Appropriate Byte Counting" (ABC) and is
+        // described in RFC 3465. This RFC is experimental and probably not
+        // implemented in real-life TCPs, hence it's commented out. Also, the ABC
+        // RFC would require other modifications as well in addition to the
+        // two lines below.
+        //
+        // int bytesAcked = state->snd_una - firstSeqAcked;
+        // state->snd_cwnd += bytesAcked * state->snd_mss;
+
+        if (cwndVector)
+            cwndVector->record(state->snd_cwnd);
+
+        tcpEV << "cwnd=" << state->snd_cwnd << "\n";
+    }
+    else
+    {
+        // perform Congestion Avoidance (RFC 2581) for each ACK this ACK stands for
+        uint32 numAcks = getNumAcks(firstSeqAcked);
+
+        for (uint32 i = 0; i < numAcks; i++)
+        {
+            uint32 incr = state->snd_mss * state->snd_mss / state->snd_cwnd;
+
+            if (incr == 0)
+                incr = 1;
+
+            state->snd_cwnd += incr;
+        }
+
+        if (cwndVector)
+            cwndVector->record(state->snd_cwnd);
+
+        //
+        // Note: some implementations use extra additive constant mss / 8 here
+        // which is known to be incorrect (RFC 2581 p5)
+        //
+        // Note 2: RFC 3465 (experimental) "Appropriate Byte Counting" (ABC)
+        // would require maintaining a bytes_acked variable here which we don't do
+        //
+
+        tcpEV << "cwnd > ssthresh: Congestion Avoidance: increasing cwnd linearly, to " << state->snd_cwnd << "\n";
+    }
+}
+
 void TCPReno::receivedDuplicateAck()
 {
     TCPTahoeRenoFamily::receivedDuplicateAck();
@@ -48,6 +48,12 @@ class INET_API TCPReno : public TCPTahoeRenoFamily
     /** Redefine what should happen on retransmission */
     virtual void processRexmitTimer(TCPEventCode& event);
 
+    /**
+     * Increases cwnd on an ACK of new data outside fast recovery: performs
+     * slow start or congestion avoidance. Redefined in TCPCubic.
+     */
+    virtual void increaseCongestionWindow(uint32 firstSeqAcked);
+
   public:
     /** Ctor */
     TCPReno();
@@ -47,3 +47,65 @@ TCPTahoeRenoFamily::TCPTahoeRenoFamily() : TCPBaseAlg(),
   state((TCPTahoeRenoFamilyStateVariables *&)TCPAlgorithm::state)
 {
 }
+
+void TCPTahoeRenoFamily::established(bool active)
+{
+    // RFC 5681, page 5:
+    // "The initial value of ssthresh SHOULD be set arbitrarily high (e.g.,
+    // to the size of the largest possible advertised window)"
+    // Without window scaling this is the 65535 set in the constructor;
+    // with it, slow start would otherwise end far below the bandwidth-delay
+    // product of high-speed long-delay paths.
+    if (state->ws_enabled)
+    {
+        state->ssthresh = (uint32)TCP_MAX_WIN << state->snd_wnd_scale;
+        tcpEV << "Window scaling is enabled, ssthresh is set to " << state->ssthresh << "\n";
+    }
+
+    TCPBaseAlg::established(active);
+}
+
+double TCPTahoeRenoFamily::getPacingRate()
+{
+    // as in Linux: slow start ratio (200%) while cwnd is below half of
+    // ssthresh, congestion avoidance ratio (120%) otherwise
+    if (state->srtt == 0)
+        return 0;
+    else if (state->snd_cwnd < state->ssthresh / 2)
+        return 2.0 * state->snd_cwnd / state->srtt.dbl();
+    else
+        return TCPBaseAlg::getPacingRate();
+}
+
+bool TCPTahoeRenoFamily::processEcnEcho()
+{
+    if (!state->ece_rcvd)
+        return false;
+
+    // RFC 3168, section 6.1.2: "TCP should not react to congestion
+    // indications more than once every window of data (or more loosely,
+    // more than once every round-trip time)."
+    if (seqGE(state->snd_una, state->ecn_recover))
+    {
+        reduceCongestionWindowOnEcn();
+        state->ecn_recover = state->snd_max;
+        state->snd_cwr = true;
+    }
+
+    return true;
+}
+
+void TCPTahoeRenoFamily::reduceCongestionWindowOnEcn()
+{
+    // RFC 3168, section 6.1.2: "The indication of congestion should be
+    // treated just as a congestion loss in non-ECN-Capable TCP. That is,
+    // the TCP source halves the congestion window "cwnd" and reduces the
+    // slow start threshold "ssthresh"."
+    recalculateSlowStartThreshold();
+    state->snd_cwnd = state->ssthresh;
+
+    if (cwndVector)
+        cwndVector->record(state->snd_cwnd);
+
+    tcpEV << "ECN-Echo received: setting cwnd to ssthresh=" << state->ssthresh << "\n";
+}
@@ -46,9 +46,34 @@ class INET_API TCPTahoeRenoFamily : public TCPBaseAlg
   protected:
     TCPTahoeRenoFamilyStateVariables *&state; // alias to TCPAlgorithm's 'state'
 
+    /** Redefined to pace at twice the rate in slow start, as cwnd doubles every RTT */
+    virtual double getPacingRate();
+
+    /** Utility function to recalculate ssthresh */
+    virtual void recalculateSlowStartThreshold() = 0;
+
+    /**
+     * To be called on ACKs of new data outside loss recovery. Returns true
+     * if ECN is in use and the ACK carries ECN-Echo; cwnd must not be
+     * increased on such ACKs (RFC 3168, section 6.1.2). The first of them
+     * in a window of data also reduces cwnd by reduceCongestionWindowOnEcn()
+     * and makes the next segment of new data carry CWR.
+     */
+    virtual bool processEcnEcho();
+
+    /**
+     * Reduces cwnd in response to ECN-Echo. This implementation treats it
+     * as a loss detected by fast retransmit: ssthresh is recalculated, and
+     * cwnd is set to ssthresh.
+     */
+    virtual void reduceCongestionWindowOnEcn();
+
   public:
     /** Ctor */
     TCPTahoeRenoFamily();
+
+    /** Raises the initial ssthresh to the largest window of window scaling connections */
+    virtual void established(bool active);
 };
 
 #endif
@@ -66,19 +66,21 @@ uint32 TCPMsgBasedRcvQueue::insertBytesFromSegment(TCPSegment *tcpseg)
 {
     TCPVirtualDataRcvQueue::insertBytesFromSegment(tcpseg);
 
-    cPacket *msg;
     uint32 endSeqNo;
     PayloadList::iterator i = payloadList.begin();
-    while (NULL != (msg = tcpseg->removeFirstPayloadMessage(endSeqNo)))
+    while (tcpseg->getPayloadArraySize() > 0)
     {
+        endSeqNo = tcpseg->getPayload(0).endSequenceNo;
         while (i != payloadList.end() && seqLess(i->seqNo, endSeqNo))
             ++i;
 
-        // insert, avoiding duplicates
+        // insert, avoiding duplicates; messages shared with the sender are
+        // only copied if they are inserted
         if (i != payloadList.end() && i->seqNo == endSeqNo)
-            delete msg;
+            tcpseg->discardFirstPayloadMessage();
         else
         {
+            cPacket *msg = tcpseg->removeFirstPayloadMessage(endSeqNo);
             i = payloadList.insert(i,PayloadItem(endSeqNo, msg));
             ASSERT(seqLE(payloadList.front().seqNo, payloadList.back().seqNo));
         }
@@ -30,7 +30,7 @@ TCPMsgBasedSendQueue::TCPMsgBasedSendQueue() : TCPSendQueue()
 TCPMsgBasedSendQueue::~TCPMsgBasedSendQueue()
 {
     for (PayloadQueue::iterator it = payloadQueue.begin(); it != payloadQueue.end(); ++it)
-        delete it->msg;
+        it->msg->release();
 }
 
 void TCPMsgBasedSendQueue::init(uint32 startSeq)
@@ -55,7 +55,7 @@ void TCPMsgBasedSendQueue::enqueueAppData(cPacket *msg)
 
     Payload payload;
     payload.endSequenceNo = end;
-    payload.msg = msg;
+    payload.msg = new TCPSharedPayload(msg);
     payloadQueue.push_back(payload);
 }
 
@@ -91,9 +91,9 @@ TCPSegment *TCPMsgBasedSendQueue::createSegmentWithBytes(uint32 fromSeq, ulong n
     while (i != payloadQueue.end() && seqLE(i->endSequenceNo, toSeq))
     {
         if (!payloadName)
-            payloadName = i->msg->getName();
+            payloadName = i->msg->getMsg()->getName();
 
-        tcpseg->addPayloadMessage(i->msg->dup(), i->endSequenceNo);
+        tcpseg->addSharedPayloadMessage(i->msg, i->endSequenceNo);
         ++i;
     }
 
@@ -119,7 +119,7 @@ void TCPMsgBasedSendQueue::discardUpTo(uint32 seqNum)
     // remove payload messages whose endSequenceNo is below seqNum
     while (!payloadQueue.empty() && seqLE(payloadQueue.front().endSequenceNo, seqNum))
     {
-        delete payloadQueue.front().msg;
+        payloadQueue.front().msg->release();
         payloadQueue.pop_front();
     }
 }
@@ -21,9 +21,14 @@
 #include <list>
 #include "TCPSendQueue.h"
 
+class TCPSharedPayload;
+
 /**
  * Send queue that manages messages.
  *
+ * Messages are kept as TCPSharedPayload references, which are shared with
+ * the segments created from the queue: (re)transmissions do not copy them.
+ *
  * @see TCPMsgBasedRcvQueue
  */
 class INET_API TCPMsgBasedSendQueue : public TCPSendQueue
@@ -32,7 +37,7 @@ class INET_API TCPMsgBasedSendQueue : public TCPSendQueue
     struct Payload
     {
         unsigned int endSequenceNo;
-        cPacket *msg;
+        TCPSharedPayload *msg;
     };
     typedef std::list<Payload> PayloadQueue;
     PayloadQueue payloadQueue;
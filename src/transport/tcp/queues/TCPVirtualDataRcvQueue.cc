@@ -76,6 +76,7 @@ ulong TCPVirtualDataRcvQueue::Region::getLengthTo(uint32 seq) const
 
 TCPVirtualDataRcvQueue::TCPVirtualDataRcvQueue() : TCPReceiveQueue()
 {
+    bufferedBytes = 0;
 }
 
 TCPVirtualDataRcvQueue::~TCPVirtualDataRcvQueue()
@@ -90,6 +91,7 @@ TCPVirtualDataRcvQueue::~TCPVirtualDataRcvQueue()
 void TCPVirtualDataRcvQueue::init(uint32 startSeq)
 {
     rcv_nxt = startSeq;
+    bufferedBytes = 0;
 
     while (!regionList.empty())
     {
@@ -162,6 +164,7 @@ void TCPVirtualDataRcvQueue::merge(TCPVirtualDataRcvQueue::Region *seg)
         {
             if (seg->merge(*i))
             {
+                bufferedBytes -= (*i)->getLength();
                 delete *i;
                 i = (RegionList::reverse_iterator)(regionList.erase((++i).base()));
                 continue;
@@ -173,6 +176,7 @@ void TCPVirtualDataRcvQueue::merge(TCPVirtualDataRcvQueue::Region *seg)
     }
 
     regionList.insert(i.base(), seg);
+    bufferedBytes += seg->getLength();
 }
 
 cPacket *TCPVirtualDataRcvQueue::extractBytesUpTo(uint32 seq)
@@ -205,20 +209,20 @@ TCPVirtualDataRcvQueue::Region* TCPVirtualDataRcvQueue::extractTo(uint32 seq)
     if (seqGE(seq, reg->getEnd()))
     {
         regionList.pop_front();
+        bufferedBytes -= reg->getLength();
         return reg;
     }
 
-    return reg->split(seq);
+    reg = reg->split(seq);
+    bufferedBytes -= reg->getLength();
+    return reg;
 }
 
 uint32 TCPVirtualDataRcvQueue::getAmountOfBufferedBytes()
 {
-    uint32 bytes = 0;
-
-    for (RegionList::iterator i = regionList.begin(); i != regionList.end(); i++)
-        bytes += (*i)->getLength();
-
-    return bytes;
+    // kept up to date on insertion and extraction, as it is needed for every
+    // advertised window, and large windows may hold many out-of-order regions
+    return bufferedBytes;
 }
 
 uint32 TCPVirtualDataRcvQueue::getAmountOfFreeBytes(uint32 maxRcvBuffer)
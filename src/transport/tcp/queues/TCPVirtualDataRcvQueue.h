@@ -37,6 +37,7 @@ class INET_API TCPVirtualDataRcvQueue : public TCPReceiveQueue
 {
   protected:
     uint32 rcv_nxt;
+    uint32 bufferedBytes;   // total length of the regions, maintained by merge() and extractTo()
 
     class Region
     {
@@ -110,7 +110,12 @@ TCPSegment& TCPSegment::operator=(const TCPSegment& other)
 void TCPSegment::copy(const TCPSegment& other)
 {
     for (PayloadList::const_iterator i = other.payloadList.begin(); i != other.payloadList.end(); ++i)
-        addPayloadMessage(i->msg->dup(), i->endSequenceNo);
+    {
+        if (i->shared)
+            addSharedPayloadMessage(i->shared, i->endSequenceNo);
+        else
+            addPayloadMessage(i->msg->dup(), i->endSequenceNo);
+    }
 }
 
 TCPSegment::~TCPSegment()
@@ -122,12 +127,19 @@ void TCPSegment::clean()
 {
     while (!payloadList.empty())
     {
-        cPacket *msg = payloadList.front().msg;
+        deletePayload(payloadList.front());
         payloadList.pop_front();
-        dropAndDelete(msg);
     }
 }
 
+void TCPSegment::deletePayload(PayloadItem& payload)
+{
+    if (payload.shared)
+        payload.shared->release();
+    else
+        dropAndDelete(payload.msg);
+}
+
 void TCPSegment::truncateData(unsigned int truncleft, unsigned int truncright)
 {
     ASSERT(payloadLength_var >= truncleft + truncright);
@@ -137,9 +149,8 @@ void TCPSegment::truncateData(unsigned int truncleft, unsigned int truncright)
 
     while (!payloadList.empty() && (payloadList.front().endSequenceNo - sequenceNo_var) <= truncleft)
     {
-        cPacket *msg = payloadList.front().msg;
+        deletePayload(payloadList.front());
         payloadList.pop_front();
-        dropAndDelete(msg);
     }
 
 
@@ -150,22 +161,33 @@ void TCPSegment::truncateData(unsigned int truncleft, unsigned int truncright)
     // truncate payload data correctly
     while (!payloadList.empty() && (payloadList.back().endSequenceNo - sequenceNo_var) > payloadLength_var)
     {
-        cPacket *msg = payloadList.back().msg;
+        deletePayload(payloadList.back());
         payloadList.pop_back();
-        dropAndDelete(msg);
     }
 }
 
 void TCPSegment::parsimPack(cCommBuffer *b)
 {
     TCPSegment_Base::parsimPack(b);
-    doPacking(b, payloadList);
+    b->pack((unsigned int)payloadList.size());
+    for (PayloadList::iterator i = payloadList.begin(); i != payloadList.end(); ++i)
+    {
+        b->pack(i->endSequenceNo);
+        b->packObject(i->msg);
+    }
 }
 
 void TCPSegment::parsimUnpack(cCommBuffer *b)
 {
     TCPSegment_Base::parsimUnpack(b);
-    doUnpacking(b, payloadList);
+    unsigned int n;
+    b->unpack(n);
+    for (unsigned int k = 0; k < n; k++)
+    {
+        unsigned int endSequenceNo;
+        b->unpack(endSequenceNo);
+        addPayloadMessage(check_and_cast<cPacket *>(b->unpackObject()), endSequenceNo);
+    }
 }
 
 void TCPSegment::setPayloadArraySize(unsigned int size)
@@ -195,9 +217,19 @@ void TCPSegment::addPayloadMessage(cPacket *msg, uint32 endSequenceNo)
 {
     take(msg);
 
-    TCPPayloadMessage payload;
+    PayloadItem payload;
     payload.endSequenceNo = endSequenceNo;
     payload.msg = msg;
+    payload.shared = NULL;
+    payloadList.push_back(payload);
+}
+
+void TCPSegment::addSharedPayloadMessage(TCPSharedPayload *shared, uint32 endSequenceNo)
+{
+    PayloadItem payload;
+    payload.endSequenceNo = endSequenceNo;
+    payload.msg = shared->getMsg();
+    payload.shared = shared->addRef();
     payloadList.push_back(payload);
 }
 
@@ -206,10 +238,30 @@ cPacket *TCPSegment::removeFirstPayloadMessage(uint32& endSequenceNo)
     if (payloadList.empty())
         return NULL;
 
-    cPacket *msg = payloadList.front().msg;
-    endSequenceNo = payloadList.front().endSequenceNo;
+    PayloadItem& payload = payloadList.front();
+    cPacket *msg;
+    if (payload.shared)
+    {
+        // the receiver gets its own copy
+        msg = payload.msg->dup();
+        payload.shared->release();
+    }
+    else
+    {
+        msg = payload.msg;
+        drop(msg);
+    }
+    endSequenceNo = payload.endSequenceNo;
     payloadList.pop_front();
-    drop(msg);
     return msg;
 }
 
+void TCPSegment::discardFirstPayloadMessage()
+{
+    if (payloadList.empty())
+        return;
+
+    deletePayload(payloadList.front());
+    payloadList.pop_front();
+}
+
@@ -51,22 +51,65 @@ class Sack : public Sack_Base
     virtual std::string str() const;
 };
 
+/**
+ * Reference counted payload message of the TCP_TRANSFER_OBJECT mode. The
+ * send queue and the segments it creates (and their copies) share one
+ * message object, so sending or retransmitting a segment does not copy
+ * the payload. The message is deleted with the last reference; it is not
+ * owned by any module meanwhile, as the references travel between modules.
+ *
+ * @see TCPMsgBasedSendQueue, TCPSegment::addSharedPayloadMessage()
+ */
+class INET_API TCPSharedPayload
+{
+  protected:
+    cPacket *msg;
+    int refCount;
+
+  private:
+    ~TCPSharedPayload() {}
+
+  public:
+    /** Takes the message over from its owner, with a reference count of one. */
+    TCPSharedPayload(cPacket *msg) : msg(msg), refCount(1) { msg->removeFromOwnershipTree(); }
+
+    /** Returns the shared message; it must not be modified. */
+    cPacket *getMsg() const {return msg;}
+
+    /** Returns the number of references */
+    int getRefCount() const {return refCount;}
+
+    /** Adds a reference, and returns this object */
+    TCPSharedPayload *addRef() {refCount++; return this;}
+
+    /** Removes a reference; deletes the message and this object with the last one */
+    void release() {if (--refCount == 0) {delete msg; delete this;}}
+};
+
 /**
  * Represents a TCP segment. More info in the TCPSegment.msg file
  * (and the documentation generated from it).
+ *
+ * Segment names are pooled (see cNamedObject::setNamePooling()), as TCP
+ * gives the same few names to most of its segments.
  */
 class INET_API TCPSegment : public TCPSegment_Base
 {
   protected:
-    typedef std::list<TCPPayloadMessage> PayloadList;
+    struct PayloadItem : public TCPPayloadMessage
+    {
+        TCPSharedPayload *shared;  // NULL if msg is owned by the segment
+    };
+    typedef std::list<PayloadItem> PayloadList;
     PayloadList payloadList;
 
   private:
     void copy(const TCPSegment& other);
     void clean();
+    void deletePayload(PayloadItem& payload);
 
   public:
-    TCPSegment(const char *name = NULL, int kind = 0) : TCPSegment_Base(name, kind) {}
+    TCPSegment(const char *name = NULL, int kind = 0) : TCPSegment_Base(NULL, kind) {setNamePooling(true); setName(name);}
     TCPSegment(const TCPSegment& other) : TCPSegment_Base(other) { copy(other); }
     ~TCPSegment();
     TCPSegment& operator=(const TCPSegment& other);
@@ -96,12 +139,27 @@ class INET_API TCPSegment : public TCPSegment_Base
      */
     virtual void addPayloadMessage(cPacket *msg, uint32 endSequenceNo);
 
+    /**
+     * Adds a reference to a shared message object to the TCP segment. The
+     * sequence number + 1 of the last byte of the message should be passed
+     * as 2nd argument
+     */
+    virtual void addSharedPayloadMessage(TCPSharedPayload *payload, uint32 endSequenceNo);
+
     /**
      * Removes and returns the first message object in this TCP segment.
      * It also returns the sequence number + 1 of its last octet in outEndSequenceNo.
+     * A shared message object is copied.
      */
     virtual cPacket *removeFirstPayloadMessage(uint32& outEndSequenceNo);
 
+    /**
+     * Removes and deletes the first message object in this TCP segment
+     * (e.g. if it has already been received), without copying it if it is
+     * shared.
+     */
+    virtual void discardFirstPayloadMessage();
+
     /**
      * Returns RFC 793 specified SEG.LEN:
      *     SEG.LEN = the number of octets occupied by the data in the segment
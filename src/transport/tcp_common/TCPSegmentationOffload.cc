@@ -0,0 +1,65 @@
+//
+// Copyright (C) 2013 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#include <algorithm>
+
+#include "TCPSegmentationOffload.h"
+
+#include "TCPSegment.h"
+
+// link layer frame, network datagram, TCP segment
+#define MAX_ENCAPSULATION_DEPTH  3
+
+TCPSegment *TCPSegmentationOffload::findSuperSegment(cPacket *packet)
+{
+    for (int i = 0; packet && i < MAX_ENCAPSULATION_DEPTH; i++)
+    {
+        TCPSegment *tcpseg = dynamic_cast<TCPSegment *>(packet);
+        if (tcpseg)
+            return tcpseg->getOffloadSegmentSize() != 0 ? tcpseg : NULL;
+        packet = packet->getEncapsulatedPacket();
+    }
+    return NULL;
+}
+
+int TCPSegmentationOffload::getNumSegments(cPacket *packet)
+{
+    TCPSegment *tcpseg = findSuperSegment(packet);
+    if (!tcpseg)
+        return 1;
+    unsigned int segmentSize = tcpseg->getOffloadSegmentSize();
+    return (int)std::max(1UL, (tcpseg->getPayloadLength() + segmentSize - 1) / segmentSize);
+}
+
+int64 TCPSegmentationOffload::getSegmentByteLength(cPacket *packet)
+{
+    TCPSegment *tcpseg = findSuperSegment(packet);
+    if (!tcpseg || tcpseg->getPayloadLength() <= tcpseg->getOffloadSegmentSize())
+        return packet->getByteLength();
+    return packet->getByteLength() - tcpseg->getPayloadLength() + tcpseg->getOffloadSegmentSize();
+}
+
+int64 TCPSegmentationOffload::getSegmentedByteLength(cPacket *packet, int extraBytesPerSegment)
+{
+    TCPSegment *tcpseg = findSuperSegment(packet);
+    if (!tcpseg)
+        return packet->getByteLength();
+    int64 headerBytes = packet->getByteLength() - tcpseg->getPayloadLength();
+    return packet->getByteLength() + (getNumSegments(packet) - 1) * (headerBytes + extraBytesPerSegment);
+}
+
@@ -0,0 +1,71 @@
+//
+// Copyright (C) 2013 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef __INET_TCPSEGMENTATIONOFFLOAD_H
+#define __INET_TCPSEGMENTATIONOFFLOAD_H
+
+#include "INETDefs.h"
+
+class TCPSegment;
+
+/**
+ * Utility functions for link layers and network layers that support
+ * TCP segmentation offload (TSO).
+ *
+ * A TCP with offload enabled sends super-segments of up to 64KiB
+ * (see TCPSegment's offloadSegmentSize field), which travel through
+ * the network as one packet. IPv4 does not fragment them as long as the
+ * individual segments fit into the MTU, and link layers transmit them
+ * with the duration of the back-to-back frames of the individual segments.
+ * This trades per-segment queueing and loss granularity for an order of
+ * magnitude fewer events in bulk transfers.
+ */
+class INET_API TCPSegmentationOffload
+{
+  public:
+    /**
+     * Returns the TCP super-segment carried by the packet, directly or
+     * encapsulated in it (e.g. in an IP datagram in an Ethernet frame),
+     * or NULL if the packet does not carry one.
+     */
+    static TCPSegment *findSuperSegment(cPacket *packet);
+
+    /**
+     * Returns the number of segments the packet stands for: the number
+     * of segments of the super-segment it carries, or 1.
+     */
+    static int getNumSegments(cPacket *packet);
+
+    /**
+     * Returns the length of the longest packet the link layer would send
+     * if it cut the super-segment into segments: the headers of the packet
+     * plus one full segment. For other packets, returns their length.
+     */
+    static int64 getSegmentByteLength(cPacket *packet);
+
+    /**
+     * Returns the number of bytes transmitted for the packet when the
+     * super-segment is cut into segments: the length of the packet plus
+     * the headers of the packet and extraBytesPerSegment (e.g. the Ethernet
+     * preamble and interframe gap) for each additional segment.
+     */
+    static int64 getSegmentedByteLength(cPacket *packet, int extraBytesPerSegment);
+};
+
+#endif
+
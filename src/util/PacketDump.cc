@@ -632,6 +632,8 @@ void PacketDump::tcpDump(bool l2r, const char *label, TCPSegment *tcpseg,
     if (tcpseg->getRstBit()) {flags = true; out << "R ";}
     if (tcpseg->getSynBit()) {flags = true; out << "S ";}
     if (tcpseg->getFinBit()) {flags = true; out << "F ";}
+    if (tcpseg->getEceBit()) {flags = true; out << "E ";}
+    if (tcpseg->getCwrBit()) {flags = true; out << "W ";}
     if (!flags) {out << ". ";}
 
     // data-seqno
@@ -21,10 +21,18 @@
 
 
 #include <errno.h>
+#include <algorithm>
+#include <sstream>
+
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#include <unistd.h>
+#endif
 
 #include "PcapDump.h"
 
 #include "IPProtocolId_m.h"
+#include "MACAddress.h"
 
 #ifdef WITH_UDP
 #include "UDPPacket_m.h"
@@ -40,6 +48,26 @@
 
 #define PCAP_MAGIC           0xa1b2c3d4
 
+/* pcapng block types and the byte-order magic of the section header */
+#define PCAPNG_SHB_TYPE      0x0A0D0D0A
+#define PCAPNG_IDB_TYPE      0x00000001
+#define PCAPNG_EPB_TYPE      0x00000006
+#define PCAPNG_BYTE_ORDER_MAGIC  0x1A2B3C4D
+
+#define PCAPNG_SHB_LENGTH    28
+#define PCAPNG_IDB_LENGTH    32
+#define PCAPNG_EPB_HEADER_LENGTH  28  // without the data and the trailing block length
+
+#define ETHERNET_HEADER_LENGTH  14
+#define IEEE80211_HEADER_LENGTH 24  // data frame header without QoS control and FCS
+#define LLC_SNAP_HEADER_LENGTH  8
+
+// room reserved in the write buffer for one record: record header,
+// link-layer header, the serialized datagram, padding and block trailer
+#define MAX_RECORD_LENGTH    (PCAPNG_EPB_HEADER_LENGTH + IEEE80211_HEADER_LENGTH + LLC_SNAP_HEADER_LENGTH + MAXBUFLENGTH + 8)
+
+#define DEFAULT_BUFFER_SIZE  (1024 * 1024)
+
 /* "libpcap" file header (minus magic number). */
 struct pcap_hdr {
      uint32 magic;      /* magic */
@@ -59,75 +87,528 @@ struct pcaprec_hdr {
      uint32 orig_len;   /* actual length of packet */
 };
 
+// both formats store numbers in the byte order of the writer
+static inline unsigned char *put16(unsigned char *p, uint16 value)
+{
+    memcpy(p, &value, sizeof(value));
+    return p + sizeof(value);
+}
+
+static inline unsigned char *put32(unsigned char *p, uint32 value)
+{
+    memcpy(p, &value, sizeof(value));
+    return p + sizeof(value);
+}
+
+
+#ifdef HAVE_PTHREAD
+
+#define PCAP_WRITER_SLOTS        4      // buffers that can wait for the writer thread
+#define PCAP_WRITER_IDLE_USEC    1000   // polling interval of the writer thread when idle
+#define PCAP_WRITER_FULL_USEC    100    // polling interval of the simulation when all slots are full
+
+/**
+ * Writes buffers handed over by PcapDump from a background thread.
+ *
+ * The buffers are passed through a single-producer single-consumer ring of
+ * PCAP_WRITER_SLOTS slots: the simulation only advances head, the writer
+ * only advances tail, so no lock is needed. The counters are only accessed
+ * with the __sync builtins of GCC and Clang, which are full memory barriers,
+ * so a slot is completely filled in (or written out) before the other side
+ * sees the counter that hands it over. Each slot owns a buffer; submitting
+ * swaps the full buffer of the caller with the already written buffer of
+ * the slot, so no data is copied and no memory is allocated while the
+ * simulation runs. Both sides poll with a short sleep when they have to wait.
+ */
+class PcapWriterThread
+{
+    protected:
+        struct Slot
+        {
+            unsigned char *data;
+            size_t length;
+            FILE *file;
+        };
+
+        pthread_t thread;
+        Slot slots[PCAP_WRITER_SLOTS];
+        volatile unsigned int head;     // number of submitted buffers; written by the simulation only
+        volatile unsigned int tail;     // number of written buffers; written by the writer thread only
+        volatile int stopping;
+        volatile int error;             // errno of the first failed write, or 0
+
+    public:
+        PcapWriterThread(size_t bufferCapacity);
+        ~PcapWriterThread();
+
+        /**
+         * Hands over the buffer to be written into the given file. The buffer
+         * is replaced by an empty one of the same capacity. Waits if all slots
+         * are waiting to be written.
+         */
+        void submit(FILE *file, unsigned char *& buffer, size_t& length);
+
+        /**
+         * Waits until all submitted data has been written.
+         */
+        void drain();
+
+    protected:
+        static void *run(void *arg);
+        void writeLoop();
+        void checkError();
+
+        static unsigned int load(volatile unsigned int *counter) { return __sync_fetch_and_add(counter, 0); }
+};
+
+PcapWriterThread::PcapWriterThread(size_t bufferCapacity)
+{
+    for (int i = 0; i < PCAP_WRITER_SLOTS; i++)
+    {
+        slots[i].data = new unsigned char[bufferCapacity];
+        slots[i].length = 0;
+        slots[i].file = NULL;
+    }
+    head = tail = 0;
+    stopping = 0;
+    error = 0;
+    if (pthread_create(&thread, NULL, run, this) != 0)
+    {
+        for (int i = 0; i < PCAP_WRITER_SLOTS; i++)
+            delete [] slots[i].data;
+        throw cRuntimeError("Cannot start pcap writer thread");
+    }
+}
+
+PcapWriterThread::~PcapWriterThread()
+{
+    __sync_lock_test_and_set(&stopping, 1);
+    pthread_join(thread, NULL);
+    for (int i = 0; i < PCAP_WRITER_SLOTS; i++)
+        delete [] slots[i].data;
+}
+
+void *PcapWriterThread::run(void *arg)
+{
+    ((PcapWriterThread *)arg)->writeLoop();
+    return NULL;
+}
+
+void PcapWriterThread::writeLoop()
+{
+    while (true)
+    {
+        // read stopping before head, so that a buffer submitted before stopping is not lost
+        bool stop = __sync_fetch_and_add(&stopping, 0);
+        unsigned int t = load(&tail);
+        if (t == load(&head))
+        {
+            if (stop)
+                break;  // everything has been written
+            usleep(PCAP_WRITER_IDLE_USEC);
+            continue;
+        }
+
+        Slot& slot = slots[t % PCAP_WRITER_SLOTS];
+        size_t written = fwrite(slot.data, 1, slot.length, slot.file);
+        if (written != slot.length)
+            __sync_bool_compare_and_swap(&error, 0, errno ? errno : EIO);
+
+        // give the slot back to the simulation
+        __sync_fetch_and_add(&tail, 1);
+    }
+}
+
+void PcapWriterThread::submit(FILE *file, unsigned char *& buffer, size_t& length)
+{
+    unsigned int h = load(&head);
+    while (h - load(&tail) == PCAP_WRITER_SLOTS)
+        usleep(PCAP_WRITER_FULL_USEC);
+
+    Slot& slot = slots[h % PCAP_WRITER_SLOTS];
+    unsigned char *empty = slot.data;
+    slot.data = buffer;
+    slot.length = length;
+    slot.file = file;
+    buffer = empty;
+    length = 0;
+
+    // publish the slot
+    __sync_fetch_and_add(&head, 1);
+    checkError();
+}
+
+void PcapWriterThread::drain()
+{
+    while (load(&tail) != load(&head))
+        usleep(PCAP_WRITER_FULL_USEC);
+    checkError();
+}
+
+void PcapWriterThread::checkError()
+{
+    // error is set once by the writer thread and never reset
+    int err = __sync_fetch_and_add(&error, 0);
+    if (err)
+        throw cRuntimeError("Cannot write pcap file: %s", strerror(err));
+}
+
+#else
+
+// placeholder, so that PcapDump can be compiled without pthreads
+class PcapWriterThread
+{
+    public:
+        void submit(FILE *file, unsigned char *& buffer, size_t& length) {}
+        void drain() {}
+};
+
+#endif // HAVE_PTHREAD
 
 
 PcapDump::PcapDump()
 {
-     dumpfile = NULL;
+    dumpfile = NULL;
+    snaplen = 0;
+    format = PCAP_CLASSIC;
+    linkType = LINKTYPE_NULL;
+    fileIndex = 0;
+    maxFileSize = 0;
+    maxFileDuration = 0;
+    fileSize = 0;
+    fileHasRecords = false;
+    buffer = NULL;
+    bufferLength = 0;
+    bufferCapacity = DEFAULT_BUFFER_SIZE;
+    async = false;
+    writer = NULL;
 }
 
 PcapDump::~PcapDump()
 {
-    closePcap();
+    // the owner closes the file in finish(), where write errors can be
+    // reported; a destructor must not throw, so errors are only logged here
+    try
+    {
+        closePcap();
+    }
+    catch (std::exception& e)
+    {
+        EV << "Error while closing pcap file: " << e.what() << endl;
+        closePcap();    // the file is closed by now, this only releases the buffers
+    }
 }
 
-void PcapDump::openPcap(const char* filename, unsigned int snaplen_par)
+void PcapDump::setBufferSize(size_t size)
+{
+    if (dumpfile)
+        throw cRuntimeError("PcapDump: cannot change the buffer size while the file is open");
+    bufferCapacity = std::max(size, (size_t)MAX_RECORD_LENGTH);
+}
+
+void PcapDump::setRotation(uint64 maxFileSize, simtime_t maxFileDuration)
+{
+    this->maxFileSize = maxFileSize;
+    this->maxFileDuration = maxFileDuration;
+}
+
+PcapDump::FileFormat PcapDump::parseFileFormat(const char *name)
 {
-    struct pcap_hdr fh;
+    if (!strcmp(name, "pcap"))
+        return PCAP_CLASSIC;
+    else if (!strcmp(name, "pcapng"))
+        return PCAP_NG;
+    else
+        throw cRuntimeError("Unknown pcap file format '%s', must be 'pcap' or 'pcapng'", name);
+}
 
+PcapDump::LinkType PcapDump::parseLinkType(const char *name)
+{
+    if (!strcmp(name, "null"))
+        return LINKTYPE_NULL;
+    else if (!strcmp(name, "ethernet"))
+        return LINKTYPE_ETHERNET;
+    else if (!strcmp(name, "raw"))
+        return LINKTYPE_RAW;
+    else if (!strcmp(name, "ieee80211"))
+        return LINKTYPE_IEEE802_11;
+    else
+        throw cRuntimeError("Unknown pcap link type '%s', must be 'null', 'ethernet', 'raw' or 'ieee80211'", name);
+}
+
+void PcapDump::openPcap(const char* filename, unsigned int snaplen_par)
+{
     if (!filename || !filename[0])
         throw cRuntimeError("Cannot open pcap file: file name is empty");
 
-    dumpfile = fopen(filename, "wb");
+    closePcap();
+
+    fileName = filename;
+    fileIndex = 0;
+    snaplen = snaplen_par;
+
+    buffer = new unsigned char[bufferCapacity];
+    bufferLength = 0;
+
+#ifdef HAVE_PTHREAD
+    if (async)
+        writer = new PcapWriterThread(bufferCapacity);
+#endif
+
+    openFile();
+}
+
+std::string PcapDump::getFileName(int index) const
+{
+    if (index == 0)
+        return fileName;
+
+    // insert the index before the extension: "dir/name.pcap" -> "dir/name-1.pcap"
+    std::string::size_type dot = fileName.rfind('.');
+    std::string::size_type slash = fileName.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+        dot = fileName.length();
+
+    std::ostringstream os;
+    os << fileName.substr(0, dot) << "-" << index << fileName.substr(dot);
+    return os.str();
+}
+
+void PcapDump::openFile()
+{
+    std::string name = getFileName(fileIndex);
+    dumpfile = fopen(name.c_str(), "wb");
 
     if (!dumpfile)
-        throw cRuntimeError("Cannot open pcap file [%s] for writing: %s", filename, strerror(errno));
+        throw cRuntimeError("Cannot open pcap file [%s] for writing: %s", name.c_str(), strerror(errno));
 
-    snaplen = snaplen_par;
+    fileSize = 0;
+    fileHasRecords = false;
+    writeFileHeader();
+}
+
+void PcapDump::writeFileHeader()
+{
+    if (format == PCAP_CLASSIC)
+    {
+        struct pcap_hdr fh;
+        fh.magic = PCAP_MAGIC;
+        fh.version_major = 2;
+        fh.version_minor = 4;
+        fh.thiszone = 0;
+        fh.sigfigs = 0;
+        fh.snaplen = snaplen;
+        fh.network = linkType;
+
+        memcpy(reserve(sizeof(fh)), &fh, sizeof(fh));
+        bufferLength += sizeof(fh);
+        fileSize += sizeof(fh);
+    }
+    else
+    {
+        // Section Header Block, without options
+        unsigned char *p = reserve(PCAPNG_SHB_LENGTH + PCAPNG_IDB_LENGTH);
+        p = put32(p, PCAPNG_SHB_TYPE);
+        p = put32(p, PCAPNG_SHB_LENGTH);
+        p = put32(p, PCAPNG_BYTE_ORDER_MAGIC);
+        p = put16(p, 1);    // major version
+        p = put16(p, 0);    // minor version
+        p = put32(p, 0xffffffff);   // section length (64 bits): unspecified
+        p = put32(p, 0xffffffff);
+        p = put32(p, PCAPNG_SHB_LENGTH);
+
+        // Interface Description Block, with nanosecond timestamp resolution
+        p = put32(p, PCAPNG_IDB_TYPE);
+        p = put32(p, PCAPNG_IDB_LENGTH);
+        p = put16(p, linkType);
+        p = put16(p, 0);    // reserved
+        p = put32(p, snaplen);
+        p = put16(p, 9);    // if_tsresol option
+        p = put16(p, 1);
+        p[0] = 9;           // 10^-9 seconds, followed by 3 bytes of padding
+        p[1] = p[2] = p[3] = 0;
+        p += 4;
+        p = put16(p, 0);    // opt_endofopt
+        p = put16(p, 0);
+        p = put32(p, PCAPNG_IDB_LENGTH);
 
-    fh.magic = PCAP_MAGIC;
-    fh.version_major = 2;
-    fh.version_minor = 4;
-    fh.thiszone = 0;
-    fh.sigfigs = 0;
-    fh.snaplen = snaplen;
-    fh.network = 0;
-    fwrite(&fh, sizeof(fh), 1, dumpfile);
+        bufferLength += PCAPNG_SHB_LENGTH + PCAPNG_IDB_LENGTH;
+        fileSize += PCAPNG_SHB_LENGTH + PCAPNG_IDB_LENGTH;
+    }
 }
 
-void PcapDump::writeFrame(simtime_t stime, const IPv4Datagram *ipPacket)
+unsigned char *PcapDump::reserve(size_t length)
+{
+    if (bufferCapacity - bufferLength < length)
+        flush();
+    return buffer + bufferLength;
+}
+
+void PcapDump::writeFrame(simtime_t stime, const IPv4Datagram *ipPacket, const MACAddress *srcAddr, const MACAddress *destAddr)
 {
     if (!dumpfile)
         throw cRuntimeError("Cannot write frame: pcap output file is not open");
 
 #ifdef WITH_IPv4
-    uint8 buf[MAXBUFLENGTH];
-    memset((void*)&buf, 0, sizeof(buf));
-
-    struct pcaprec_hdr ph;
-    ph.ts_sec = (int32)stime.dbl();
-    ph.ts_usec = (uint32)((stime.dbl() - ph.ts_sec) * 1000000);
-     // Write Ethernet header
-    uint32 hdr = 2; //AF_INET
-
-    int32 serialized_ip = IPv4Serializer().serialize(ipPacket, buf, sizeof(buf), true);
-    ph.orig_len = serialized_ip + sizeof(uint32);
-
-    ph.incl_len = ph.orig_len > snaplen ? snaplen : ph.orig_len;
-    fwrite(&ph, sizeof(ph), 1, dumpfile);
-    fwrite(&hdr, sizeof(uint32), 1, dumpfile);
-    fwrite(buf, ph.incl_len - sizeof(uint32), 1, dumpfile);
+    if (fileHasRecords && ((maxFileSize != 0 && fileSize >= maxFileSize)
+            || (maxFileDuration != 0 && stime - fileStartTime >= maxFileDuration)))
+        rotateFile();
+
+    unsigned int recordHeaderLength = (format == PCAP_NG) ? PCAPNG_EPB_HEADER_LENGTH : sizeof(struct pcaprec_hdr);
+    unsigned int linkHeaderLength = (linkType == LINKTYPE_NULL) ? sizeof(uint32) :
+            (linkType == LINKTYPE_ETHERNET) ? ETHERNET_HEADER_LENGTH :
+            (linkType == LINKTYPE_IEEE802_11) ? IEEE80211_HEADER_LENGTH + LLC_SNAP_HEADER_LENGTH : 0;
+
+    // the record is assembled in place in the write buffer
+    unsigned char *record = reserve(MAX_RECORD_LENGTH);
+    unsigned char *data = record + recordHeaderLength;
+    unsigned char *ipData = data + linkHeaderLength;
+
+    // the serializers do not fill in payload bytes, so they must be cleared;
+    // only this datagram's length, not the whole MAXBUFLENGTH
+    unsigned int ipLength = std::min((unsigned int)ipPacket->getByteLength(), (unsigned int)MAXBUFLENGTH);
+    memset(ipData, 0, ipLength);
+    int32 serialized_ip = IPv4Serializer().serialize(ipPacket, ipData, MAXBUFLENGTH, true);
+
+    if (linkType == LINKTYPE_NULL)
+    {
+        put32(data, 2); // AF_INET
+    }
+    else if (linkType == LINKTYPE_ETHERNET)
+    {
+        if (destAddr)
+            destAddr->getAddressBytes(data);
+        else
+            memset(data, 0, MAC_ADDRESS_SIZE);
+        if (srcAddr)
+            srcAddr->getAddressBytes(data + MAC_ADDRESS_SIZE);
+        else
+            memset(data + MAC_ADDRESS_SIZE, 0, MAC_ADDRESS_SIZE);
+        data[12] = 0x08;    // ETHERTYPE_IP
+        data[13] = 0x00;
+    }
+    else if (linkType == LINKTYPE_IEEE802_11)
+    {
+        // data frame between two stations of an IBSS (ToDS=FromDS=0):
+        // address 1 is the destination, address 2 the source, address 3
+        // the BSSID (not known here, left zero)
+        memset(data, 0, IEEE80211_HEADER_LENGTH);
+        data[0] = 0x08;     // frame control: version 0, type data, subtype 0
+        if (destAddr)
+            destAddr->getAddressBytes(data + 4);
+        if (srcAddr)
+            srcAddr->getAddressBytes(data + 4 + MAC_ADDRESS_SIZE);
+
+        // LLC/SNAP header of an IPv4 payload
+        unsigned char *llc = data + IEEE80211_HEADER_LENGTH;
+        llc[0] = llc[1] = 0xAA; // DSAP, SSAP: SNAP
+        llc[2] = 0x03;      // control: UI
+        llc[3] = llc[4] = llc[5] = 0x00;    // OUI: encapsulated Ethernet
+        llc[6] = 0x08;      // ETHERTYPE_IP
+        llc[7] = 0x00;
+    }
+
+    // truncation to snaplen only shortens the record, the data stays in place
+    uint32 orig_len = linkHeaderLength + serialized_ip;
+    uint32 incl_len = orig_len > snaplen ? snaplen : orig_len;
+    size_t recordLength;
+
+    if (format == PCAP_CLASSIC)
+    {
+        struct pcaprec_hdr ph;
+        ph.ts_sec = (int32)stime.dbl();
+        ph.ts_usec = (uint32)((stime.dbl() - ph.ts_sec) * 1000000);
+        ph.incl_len = incl_len;
+        ph.orig_len = orig_len;
+        memcpy(record, &ph, sizeof(ph));
+        recordLength = sizeof(ph) + incl_len;
+    }
+    else
+    {
+        // Enhanced Packet Block; data is padded to 32 bits
+        uint32 paddedLength = (incl_len + 3) & ~3u;
+        uint32 blockLength = PCAPNG_EPB_HEADER_LENGTH + paddedLength + sizeof(uint32);
+        int64 seconds = (int64)floor(stime.dbl());
+        uint64 timestamp = (uint64)seconds * 1000000000 + (uint64)((stime - (double)seconds).dbl() * 1e9);
+
+        unsigned char *p = record;
+        p = put32(p, PCAPNG_EPB_TYPE);
+        p = put32(p, blockLength);
+        p = put32(p, 0);    // interface id
+        p = put32(p, (uint32)(timestamp >> 32));
+        p = put32(p, (uint32)timestamp);
+        p = put32(p, incl_len);
+        p = put32(p, orig_len);
+        memset(data + incl_len, 0, paddedLength - incl_len);
+        put32(data + paddedLength, blockLength);
+        recordLength = blockLength;
+    }
+
+    bufferLength += recordLength;
+    fileSize += recordLength;
+    if (!fileHasRecords)
+    {
+        fileStartTime = stime;
+        fileHasRecords = true;
+    }
 #else
     throw cRuntimeError("Cannot write frame: INET compiled without IPv4 feature");
 #endif
 }
 
-void PcapDump::closePcap()
+void PcapDump::flush()
 {
-    if (dumpfile)
+    if (bufferLength == 0 || !dumpfile)
+        return;
+
+    if (writer)
+        writer->submit(dumpfile, buffer, bufferLength);
+    else
+    {
+        size_t written = fwrite(buffer, 1, bufferLength, dumpfile);
+        if (written != bufferLength)
+            throw cRuntimeError("Cannot write pcap file: %s", strerror(errno));
+        bufferLength = 0;
+    }
+}
+
+void PcapDump::closeFile()
+{
+    // the file is closed even if writing out the buffered records fails
+    try
+    {
+        flush();
+        if (writer)
+            writer->drain();
+    }
+    catch (...)
     {
         fclose(dumpfile);
         dumpfile = NULL;
+        bufferLength = 0;
+        throw;
     }
+    fclose(dumpfile);
+    dumpfile = NULL;
 }
 
+void PcapDump::rotateFile()
+{
+    closeFile();
+    fileIndex++;
+    openFile();
+}
+
+void PcapDump::closePcap()
+{
+    if (dumpfile)
+        closeFile();
+
+#ifdef HAVE_PTHREAD
+    delete writer;
+#endif
+    writer = NULL;
+    delete [] buffer;
+    buffer = NULL;
+    bufferLength = 0;
+}
@@ -22,23 +22,66 @@
 #define __INET_PCAPDUMP_H
 
 
+#include <string>
+
 #include "INETDefs.h"
 
-// Foreign declarations:
 class IPv4Datagram;
+class MACAddress;
+class PcapWriterThread;
 
 
 /**
  * Dumps packets into a PCAP file; see the "pcap-savefile" man page or
- * http://www.tcpdump.org/ for details on the file format.
- * Note: The file is currently recorded in the "classic" format,
- * not in the "Next Generation" file format also on tcpdump.org.
+ * http://www.tcpdump.org/ for details on the file format. The file can be
+ * recorded either in the "classic" format or in the "Next Generation"
+ * (pcapng) format, with nanosecond timestamps in the latter case.
+ *
+ * Records are collected in a large in-memory buffer which is written to
+ * the file with a single fwrite() when it fills up. If INET was compiled
+ * with HAVE_PTHREAD and asynchronous writing is enabled, full buffers are
+ * handed over to a background thread through a lock-free ring of a few
+ * buffers, so the simulation only waits for disk I/O when the writer falls
+ * behind by all of them.
+ *
+ * The output can be split into several files by size and/or simulation
+ * time; the files are named by inserting a running index before the
+ * extension (e.g. "results/host.pcap", "results/host-1.pcap", ...).
  */
 class PcapDump
 {
+    public:
+        enum FileFormat { PCAP_CLASSIC, PCAP_NG };
+
+        /** Link-layer header types, values as in the LINKTYPE_* registry of tcpdump.org */
+        enum LinkType {
+            LINKTYPE_NULL = 0,       // 4-byte address family in host byte order
+            LINKTYPE_ETHERNET = 1,   // Ethernet II header
+            LINKTYPE_RAW = 101,      // no link-layer header, starts with the IP header
+            LINKTYPE_IEEE802_11 = 105   // 802.11 data frame header and LLC/SNAP header
+        };
+
     protected:
         FILE *dumpfile;         // pcap file
         unsigned int snaplen;   // max. length of packets in pcap file
+        FileFormat format;
+        LinkType linkType;
+
+        // rotation
+        std::string fileName;   // file name as given to openPcap()
+        int fileIndex;          // running index of the current file
+        uint64 maxFileSize;     // 0 means no limit
+        simtime_t maxFileDuration;  // 0 means no limit
+        uint64 fileSize;        // bytes written into the current file so far
+        simtime_t fileStartTime;    // time of the first record in the current file
+        bool fileHasRecords;
+
+        // buffering
+        unsigned char *buffer;
+        size_t bufferLength;    // number of bytes used
+        size_t bufferCapacity;
+        bool async;
+        PcapWriterThread *writer;   // NULL if writing synchronously
 
     public:
         /**
@@ -47,10 +90,46 @@ class PcapDump
         PcapDump();
 
         /**
-         * Destructor. It closes the output file if it is open.
+         * Destructor. It closes the output file if it is open. Errors are
+         * only logged; call closePcap() first to get them as exceptions.
          */
         ~PcapDump();
 
+        /** @name Settings; they must be set before openPcap() */
+        //@{
+        void setFileFormat(FileFormat format) { this->format = format; }
+        void setLinkType(LinkType linkType) { this->linkType = linkType; }
+
+        /**
+         * Sets the size of the in-memory write buffer. Values smaller than
+         * the largest possible record are rounded up.
+         */
+        void setBufferSize(size_t size);
+
+        /**
+         * Enables writing the buffers from a background thread. Ignored
+         * (i.e. writing stays synchronous) if INET was built without HAVE_PTHREAD.
+         */
+        void setAsync(bool async) { this->async = async; }
+
+        /**
+         * Starts a new file when the current one reaches maxFileSize bytes
+         * or spans maxFileDuration of simulation time; zero disables the
+         * respective limit.
+         */
+        void setRotation(uint64 maxFileSize, simtime_t maxFileDuration);
+        //@}
+
+        /**
+         * Parses a file format name ("pcap" or "pcapng"); throws an exception for unknown names.
+         */
+        static FileFormat parseFileFormat(const char *name);
+
+        /**
+         * Parses a link type name ("null", "ethernet", "raw" or "ieee80211"); throws an exception for unknown names.
+         */
+        static LinkType parseLinkType(const char *name);
+
         /**
          * Opens a PCAP file with the given file name. The snaplen parameter
          * is the length that packets will be truncated to. Throws an exception
@@ -63,18 +142,38 @@ class PcapDump
          */
         bool isOpen() const { return dumpfile != NULL; }
 
+        /**
+         * Returns the link-layer header type of the records.
+         */
+        LinkType getLinkType() const { return linkType; }
+
         /**
          * Records the given packet into the output file if it is open,
-         * and throws an exception otherwise.
+         * and throws an exception otherwise. The MAC addresses are used
+         * for the Ethernet and 802.11 link types; they default to all zeros.
+         */
+        void writeFrame(simtime_t time, const IPv4Datagram *ipPacket,
+                const MACAddress *srcAddr = NULL, const MACAddress *destAddr = NULL);
+
+        /**
+         * Writes out the buffered records. With asynchronous writing, this
+         * returns after the data has been handed over to the writer thread.
          */
-        void writeFrame(simtime_t time, const IPv4Datagram *ipPacket);
+        void flush();
 
         /**
          * Closes the output file if it is open.
          */
         void closePcap();
+
+    protected:
+        void openFile();
+        void closeFile();
+        void rotateFile();
+        void writeFileHeader();
+        std::string getFileName(int index) const;
+        unsigned char *reserve(size_t length);
 };
 
 
 #endif // __INET_PCAPDUMP_H
-
@@ -26,6 +26,14 @@
 #include "IPv4Datagram.h"
 #endif
 
+#ifdef WITH_ETHERNET
+#include "EtherFrame_m.h"
+#endif
+
+#ifdef WITH_IEEE80211
+#include "Ieee80211Frame_m.h"
+#endif
+
 
 //----
 
@@ -101,7 +109,14 @@ void PcapRecorder::initialize()
     }
 
     if (*file)
+    {
+        pcapDumper.setFileFormat(PcapDump::parseFileFormat(par("fileFormat")));
+        pcapDumper.setLinkType(PcapDump::parseLinkType(par("linkType")));
+        pcapDumper.setBufferSize(par("bufferSize").longValue());
+        pcapDumper.setAsync(par("asyncWrite").boolValue());
+        pcapDumper.setRotation(par("maxFileSize").longValue(), par("maxFileDuration").doubleValue());
         pcapDumper.openPcap(file, snaplen);
+    }
 }
 
 void PcapRecorder::handleMessage(cMessage *msg)
@@ -136,6 +151,9 @@ void PcapRecorder::recordPacket(cPacket *msg, bool l2r)
 
     bool hasBitError = false;
     IPv4Datagram *ipPacket = NULL;
+    bool needAddresses = pcapDumper.getLinkType() == PcapDump::LINKTYPE_ETHERNET || pcapDumper.getLinkType() == PcapDump::LINKTYPE_IEEE802_11;
+    const MACAddress *srcAddr = NULL;
+    const MACAddress *destAddr = NULL;
 
     while (msg)
     {
@@ -145,13 +163,37 @@ void PcapRecorder::recordPacket(cPacket *msg, bool l2r)
         if (NULL != (ipPacket = dynamic_cast<IPv4Datagram *>(msg)))
             break;
 
+        if (needAddresses && !srcAddr)
+            findMACAddresses(msg, srcAddr, destAddr);
+
         msg = msg->getEncapsulatedPacket();
     }
 
     if (ipPacket && (dumpBadFrames || !hasBitError))
     {
         const simtime_t stime = simulation.getSimTime();
-        pcapDumper.writeFrame(stime, ipPacket);
+        pcapDumper.writeFrame(stime, ipPacket, srcAddr, destAddr);
+    }
+#endif
+}
+
+void PcapRecorder::findMACAddresses(cPacket *msg, const MACAddress *& srcAddr, const MACAddress *& destAddr)
+{
+#ifdef WITH_ETHERNET
+    if (EtherFrame *etherFrame = dynamic_cast<EtherFrame *>(msg))
+    {
+        srcAddr = &etherFrame->getSrc();
+        destAddr = &etherFrame->getDest();
+        return;
+    }
+#endif
+
+#ifdef WITH_IEEE80211
+    // the addresses the frame would have if it were bridged to Ethernet
+    if (Ieee80211DataOrMgmtFrame *wifiFrame = dynamic_cast<Ieee80211DataOrMgmtFrame *>(msg))
+    {
+        srcAddr = wifiFrame->getFromDS() ? &wifiFrame->getAddress3() : &wifiFrame->getTransmitterAddress();
+        destAddr = wifiFrame->getToDS() ? &wifiFrame->getAddress3() : &wifiFrame->getReceiverAddress();
     }
 #endif
 }
@@ -27,6 +27,8 @@
 #include "PacketDump.h"
 #include "PcapDump.h"
 
+class MACAddress;
+
 
 /**
  * Dumps every packet using the PcapDump and PacketDump classes
@@ -50,6 +52,7 @@ class INET_API PcapRecorder : public cSimpleModule, protected cListener
         virtual void finish();
         virtual void receiveSignal(cComponent *source, simsignal_t signalID, cObject *obj);
         virtual void recordPacket(cPacket *msg, bool l2r);
+        virtual void findMACAddresses(cPacket *msg, const MACAddress *& srcAddr, const MACAddress *& destAddr);
 };
 
 #endif
@@ -0,0 +1,263 @@
+//
+// Copyright (C) 2013 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <algorithm>
+#include <stdio.h>
+
+#ifdef _WIN32
+#define WANT_WINSOCK2
+#include <platdep/sockets.h>
+#include <platdep/timeutil.h>
+#else
+#include <sys/time.h>
+#include <time.h>
+#endif
+
+#include "Profiler.h"
+
+
+Register_Class(ProfilingScheduler);
+
+cMessage *ProfilingScheduler::getNextEvent()
+{
+    cMessage *msg = cSequentialScheduler::getNextEvent();
+    if (profiler)
+        profiler->eventStarting(msg);
+    return msg;
+}
+
+
+Define_Module(Profiler);
+
+void Profiler::Counters::add(const Counters& other)
+{
+    numEvents += other.numEvents;
+    wallTime += other.wallTime;
+    numObjects += other.numObjects;
+    numMessages += other.numMessages;
+}
+
+Profiler::Profiler()
+{
+    scheduler = NULL;
+    currentCounters = NULL;
+    lastTime = 0;
+    lastObjectCount = lastMessageCount = 0;
+}
+
+Profiler::~Profiler()
+{
+    if (scheduler)
+        scheduler->setProfiler(NULL);
+    for (int i = 0; i < (int)moduleRecords.size(); i++)
+        delete moduleRecords[i];
+}
+
+void Profiler::initialize()
+{
+    reportFile = par("reportFile").stdstringValue();
+    flameGraphFile = par("flameGraphFile").stdstringValue();
+    numTopEntries = par("numTopEntries");
+
+    scheduler = dynamic_cast<ProfilingScheduler *>(simulation.getScheduler());
+    if (scheduler)
+    {
+        scheduler->setProfiler(this);
+        getDisplayString().setTagArg("t", 0, "profiling");
+    }
+    else
+    {
+        EV << "Profiler: scheduler-class is not ProfilingScheduler, profiling is disabled\n";
+        getDisplayString().setTagArg("t", 0, "disabled");
+    }
+}
+
+void Profiler::handleMessage(cMessage *msg)
+{
+    throw cRuntimeError("This module does not handle messages");
+}
+
+int64 Profiler::getWallClockTime()
+{
+#if defined(_WIN32) || !defined(CLOCK_MONOTONIC)
+    timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64)tv.tv_sec * 1000000000 + (int64)tv.tv_usec * 1000;
+#else
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+Profiler::Counters *Profiler::getCounters(cMessage *msg)
+{
+    int moduleId = msg->getArrivalModuleId();
+    if (moduleId < 0)
+        moduleId = 0;   // not expected; accounted to the record of id 0
+    if (moduleId >= (int)moduleRecords.size())
+        moduleRecords.resize(moduleId + 1, NULL);
+
+    ModuleRecord *record = moduleRecords[moduleId];
+    if (!record)
+    {
+        record = moduleRecords[moduleId] = new ModuleRecord();
+        cModule *module = simulation.getModule(moduleId);
+        record->fullPath = module ? module->getFullPath() : "(unknown)";
+        record->typeName = module ? module->getNedTypeName() : "(unknown)";
+    }
+    return &record->classCounters[msg->getClassName()];
+}
+
+void Profiler::eventStarting(cMessage *msg)
+{
+    int64 now = getWallClockTime();
+    long objectCount = cOwnedObject::getTotalObjectCount();
+    long messageCount = cMessage::getTotalMessageCount();
+
+    if (currentCounters)
+    {
+        currentCounters->numEvents++;
+        currentCounters->wallTime += now - lastTime;
+        currentCounters->numObjects += objectCount - lastObjectCount;
+        currentCounters->numMessages += messageCount - lastMessageCount;
+    }
+    currentCounters = msg ? getCounters(msg) : NULL;
+
+    // the bookkeeping above is not attributed to any event
+    lastTime = getWallClockTime();
+    lastObjectCount = objectCount;
+    lastMessageCount = messageCount;
+}
+
+void Profiler::finish()
+{
+    if (!scheduler)
+        return;
+
+    // close the last event, and stop profiling the finish() calls
+    eventStarting(NULL);
+    scheduler->setProfiler(NULL);
+    scheduler = NULL;
+
+    Counters total;
+    for (int i = 0; i < (int)moduleRecords.size(); i++)
+        if (moduleRecords[i])
+            for (ClassCounters::iterator it = moduleRecords[i]->classCounters.begin(); it != moduleRecords[i]->classCounters.end(); ++it)
+                total.add(it->second);
+
+    recordScalar("profiled events", total.numEvents);
+    recordScalar("profiled wall time", total.wallTime / 1e9);
+
+    if (!reportFile.empty())
+        writeReport(reportFile.c_str());
+    if (!flameGraphFile.empty())
+        writeFlameGraph(flameGraphFile.c_str());
+}
+
+bool Profiler::compareWallTime(NamedCounters::const_iterator a, NamedCounters::const_iterator b)
+{
+    return a->second.wallTime > b->second.wallTime;
+}
+
+void Profiler::writeRanking(FILE *f, const char *title, const NamedCounters& counters, const Counters& total)
+{
+    std::vector<NamedCounters::const_iterator> ranking;
+    for (NamedCounters::const_iterator it = counters.begin(); it != counters.end(); ++it)
+        ranking.push_back(it);
+    std::stable_sort(ranking.begin(), ranking.end(), compareWallTime);
+
+    fprintf(f, "\n%s\n\n", title);
+    fprintf(f, "%-60s %12s %12s %7s %10s %12s %12s\n", "name", "events", "time[s]", "time%", "ns/event", "objects", "messages");
+    for (int i = 0; i < (int)ranking.size() && (numTopEntries <= 0 || i < numTopEntries); i++)
+    {
+        const std::string& name = ranking[i]->first;
+        const Counters& c = ranking[i]->second;
+        fprintf(f, "%-60s %12.0f %12.6f %7.2f %10.0f %12.0f %12.0f\n",
+                name.c_str(), (double)c.numEvents, c.wallTime / 1e9,
+                total.wallTime > 0 ? 100.0 * c.wallTime / total.wallTime : 0.0,
+                c.numEvents > 0 ? (double)c.wallTime / c.numEvents : 0.0,
+                (double)c.numObjects, (double)c.numMessages);
+    }
+    if (numTopEntries > 0 && (int)ranking.size() > numTopEntries)
+        fprintf(f, "(%d more)\n", (int)ranking.size() - numTopEntries);
+}
+
+void Profiler::writeReport(const char *fileName)
+{
+    NamedCounters byType, byClass, byTypeAndClass, byModule;
+    Counters total;
+    for (int i = 0; i < (int)moduleRecords.size(); i++)
+    {
+        ModuleRecord *record = moduleRecords[i];
+        if (!record)
+            continue;
+        for (ClassCounters::iterator it = record->classCounters.begin(); it != record->classCounters.end(); ++it)
+        {
+            byType[record->typeName].add(it->second);
+            byClass[it->first].add(it->second);
+            byTypeAndClass[record->typeName + " / " + it->first].add(it->second);
+            byModule[record->fullPath].add(it->second);
+            total.add(it->second);
+        }
+    }
+
+    FILE *f = fopen(fileName, "w");
+    if (!f)
+        throw cRuntimeError("Cannot open profiler report file '%s' for writing", fileName);
+
+    fprintf(f, "Profile of %s, run %d\n", simulation.getSystemModule()->getFullName(), ev.getConfigEx()->getActiveRunNumber());
+    fprintf(f, "%.0f events, %.6f s wall time, %.0f ns/event, simulation time %s\n",
+            (double)total.numEvents, total.wallTime / 1e9,
+            total.numEvents > 0 ? (double)total.wallTime / total.numEvents : 0.0, SIMTIME_STR(simTime()));
+    fprintf(f, "The time of an event includes the simulation kernel and user interface work done for it.\n");
+
+    writeRanking(f, "Module types", byType, total);
+    writeRanking(f, "Message classes", byClass, total);
+    writeRanking(f, "Module types and message classes", byTypeAndClass, total);
+    writeRanking(f, "Modules", byModule, total);
+
+    fclose(f);
+}
+
+void Profiler::writeFlameGraph(const char *fileName)
+{
+    FILE *f = fopen(fileName, "w");
+    if (!f)
+        throw cRuntimeError("Cannot open profiler flame graph file '%s' for writing", fileName);
+
+    // "folded stacks" format: frames separated by semicolons, followed by the time in microseconds;
+    // the frames are the module path, the module type, and the message class
+    for (int i = 0; i < (int)moduleRecords.size(); i++)
+    {
+        ModuleRecord *record = moduleRecords[i];
+        if (!record)
+            continue;
+        std::string stack = record->fullPath;
+        std::replace(stack.begin(), stack.end(), '.', ';');
+        std::replace(stack.begin(), stack.end(), ' ', '_');
+        stack += " (" + record->typeName + ")";
+        for (ClassCounters::iterator it = record->classCounters.begin(); it != record->classCounters.end(); ++it)
+        {
+            int64 micros = it->second.wallTime / 1000;
+            if (micros > 0)
+                fprintf(f, "%s;%s %.0f\n", stack.c_str(), it->first, (double)micros);
+        }
+    }
+
+    fclose(f);
+}
@@ -0,0 +1,114 @@
+//
+// Copyright (C) 2013 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __INET_PROFILER_H
+#define __INET_PROFILER_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "INETDefs.h"
+
+class Profiler;
+
+/**
+ * Sequential scheduler that reports event boundaries to the Profiler
+ * module of the network. Enable it with
+ * <tt>scheduler-class = "ProfilingScheduler"</tt> in omnetpp.ini;
+ * without a Profiler module it behaves like cSequentialScheduler.
+ */
+class INET_API ProfilingScheduler : public cSequentialScheduler
+{
+  protected:
+    Profiler *profiler;
+
+  public:
+    ProfilingScheduler() : profiler(NULL) {}
+    virtual void setProfiler(Profiler *profiler) { this->profiler = profiler; }
+    virtual cMessage *getNextEvent();
+};
+
+/**
+ * Attributes the wall-clock time, the number of events and the number of
+ * object and message allocations of every event to the module that handles
+ * it and to the class of the message, and writes a ranked report and a
+ * flame graph input file at the end of the simulation. See the NED file for
+ * details.
+ */
+class INET_API Profiler : public cSimpleModule
+{
+  protected:
+    struct Counters
+    {
+        uint64 numEvents;
+        int64 wallTime;     // nanoseconds
+        int64 numObjects;   // cOwnedObjects created
+        int64 numMessages;  // cMessages created
+        Counters() : numEvents(0), wallTime(0), numObjects(0), numMessages(0) {}
+        void add(const Counters& other);
+    };
+
+    typedef std::map<const char *, Counters> ClassCounters;   // keyed by the class name pointer
+
+    struct ModuleRecord
+    {
+        std::string fullPath;
+        std::string typeName;
+        ClassCounters classCounters;
+    };
+
+    typedef std::map<std::string, Counters> NamedCounters;
+
+    // parameters
+    std::string reportFile;
+    std::string flameGraphFile;
+    int numTopEntries;
+
+    // state
+    ProfilingScheduler *scheduler;
+    std::vector<ModuleRecord *> moduleRecords;  // indexed by module id
+    Counters *currentCounters;                  // counters of the event being executed
+    int64 lastTime;
+    long lastObjectCount;
+    long lastMessageCount;
+
+  protected:
+    virtual void initialize();
+    virtual void handleMessage(cMessage *msg);
+    virtual void finish();
+
+    static int64 getWallClockTime();
+    static bool compareWallTime(NamedCounters::const_iterator a, NamedCounters::const_iterator b);
+    Counters *getCounters(cMessage *msg);
+    void writeRanking(FILE *f, const char *title, const NamedCounters& counters, const Counters& total);
+    void writeReport(const char *fileName);
+    void writeFlameGraph(const char *fileName);
+
+  public:
+    Profiler();
+    virtual ~Profiler();
+
+    /**
+     * Called by ProfilingScheduler before each event: closes the accounting
+     * of the previous event and starts the accounting of the given one
+     * (NULL at the end of the simulation).
+     */
+    virtual void eventStarting(cMessage *msg);
+};
+
+#endif
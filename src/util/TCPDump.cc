@@ -50,7 +50,14 @@ void TCPDump::initialize()
     tcpdump.setOutStream(ev.getOStream());
 
     if (*file)
+    {
+        pcapDump.setFileFormat(PcapDump::parseFileFormat(par("fileFormat")));
+        pcapDump.setLinkType(PcapDump::parseLinkType(par("linkType")));
+        pcapDump.setBufferSize(par("bufferSize").longValue());
+        pcapDump.setAsync(par("asyncWrite").boolValue());
+        pcapDump.setRotation(par("maxFileSize").longValue(), par("maxFileDuration").doubleValue());
         pcapDump.openPcap(file, snaplen);
+    }
 }
 
 void TCPDump::handleMessage(cMessage *msg)
@@ -18,6 +18,7 @@
 #include "ChannelControl.h"
 #include "FWMath.h"
 #include <cassert>
+#include <algorithm>
 
 #include "AirFrame_m.h"
 
@@ -64,6 +65,7 @@ void ChannelControl::initialize()
 
     numChannels = par("numChannels");
     transmissions.resize(numChannels);
+    transmissionExpiries.resize(numChannels);
 
     lastOngoingTransmissionsUpdate = 0;
 
@@ -124,6 +126,7 @@ ChannelControl::RadioRef ChannelControl::registerRadio(cModule *radio, cGate *ra
     re.radioInGate = radioInGate->getPathStartGate();
     re.isNeighborListValid = false;
     re.channel = 0;  // for now
+    re.channelNeighbors.resize(numChannels);
     re.isActive = true;
     radios.push_back(re);
     return &radios.back(); // last element
@@ -141,7 +144,8 @@ void ChannelControl::unregisterRadio(RadioRef r)
             for (RadioList::iterator i2 = radios.begin(); i2 != radios.end(); ++i2)
             {
                 RadioRef otherRadio = &*i2;
-                otherRadio->neighbors.erase(radioToRemove);
+                if (otherRadio->neighbors.erase(radioToRemove))
+                    removeChannelNeighbor(otherRadio, radioToRemove, radioToRemove->channel);
                 otherRadio->isNeighborListValid = false;
                 radioToRemove->isNeighborListValid = false;
             }
@@ -177,6 +181,26 @@ const ChannelControl::RadioRefVector& ChannelControl::getNeighbors(RadioRef h)
     return h->neighborList;
 }
 
+const ChannelControl::RadioRefVector& ChannelControl::getNeighbors(RadioRef h, int channel)
+{
+    return h->channelNeighbors[channel];
+}
+
+void ChannelControl::addChannelNeighbor(RadioRef h, RadioRef neighbor, int channel)
+{
+    RadioRefVector& partition = h->channelNeighbors[channel];
+    RadioRefVector::iterator it = std::lower_bound(partition.begin(), partition.end(), neighbor, RadioEntry::Compare());
+    partition.insert(it, neighbor);
+}
+
+void ChannelControl::removeChannelNeighbor(RadioRef h, RadioRef neighbor, int channel)
+{
+    RadioRefVector& partition = h->channelNeighbors[channel];
+    RadioRefVector::iterator it = std::lower_bound(partition.begin(), partition.end(), neighbor, RadioEntry::Compare());
+    if (it != partition.end() && *it == neighbor)
+        partition.erase(it);
+}
+
 void ChannelControl::updateConnections(RadioRef h)
 {
     Coord& hpos = h->pos;
@@ -197,6 +221,8 @@ void ChannelControl::updateConnections(RadioRef h)
             if (h->neighbors.insert(hi).second == true)
             {
                 hi->neighbors.insert(h);
+                addChannelNeighbor(h, hi, hi->channel);
+                addChannelNeighbor(hi, h, h->channel);
                 h->isNeighborListValid = hi->isNeighborListValid = false;
             }
         }
@@ -206,6 +232,8 @@ void ChannelControl::updateConnections(RadioRef h)
             if (h->neighbors.erase(hi))
             {
                 hi->neighbors.erase(h);
+                removeChannelNeighbor(h, hi, hi->channel);
+                removeChannelNeighbor(hi, h, h->channel);
                 h->isNeighborListValid = hi->isNeighborListValid = false;
             }
         }
@@ -230,6 +258,15 @@ void ChannelControl::setRadioChannel(RadioRef r, int channel)
     Enter_Method_Silent();
     checkChannel(channel);
 
+    if (r->channel == channel)
+        return;
+
+    // move the radio to the new channel's partition in its neighbors' caches
+    for (std::set<RadioRef,RadioEntry::Compare>::iterator it = r->neighbors.begin(); it != r->neighbors.end(); it++)
+    {
+        removeChannelNeighbor(*it, r, r->channel);
+        addChannelNeighbor(*it, r, channel);
+    }
     r->channel = channel;
 }
 
@@ -238,7 +275,7 @@ const ChannelControl::TransmissionList& ChannelControl::getOngoingTransmissions(
     Enter_Method_Silent();
 
     checkChannel(channel);
-    purgeOngoingTransmissions();
+    purgeOngoingTransmissions(channel);
     return transmissions[channel];
 }
 
@@ -265,25 +302,29 @@ void ChannelControl::addOngoingTransmission(RadioRef h, AirFrame *frame)
     // register ongoing transmission
     take(frame);
     frame->setTimestamp(); // store time of transmission start
-    transmissions[frame->getChannelNumber()].push_back(frame);
+    int channel = frame->getChannelNumber();
+    TransmissionList& tl = transmissions[channel];
+    tl.push_back(frame);
+    simtime_t expiry = frame->getTimestamp() + frame->getDuration() + TRANSMISSION_PURGE_INTERVAL;
+    transmissionExpiries[channel].insert(std::make_pair(expiry, --tl.end()));
 }
 
 void ChannelControl::purgeOngoingTransmissions()
 {
     for (int i = 0; i < numChannels; i++)
-    {
-        for (TransmissionList::iterator it = transmissions[i].begin(); it != transmissions[i].end();)
-        {
-            TransmissionList::iterator curr = it;
-            AirFrame *frame = *it;
-            it++;
+        purgeOngoingTransmissions(i);
+}
 
-            if (frame->getTimestamp() + frame->getDuration() + TRANSMISSION_PURGE_INTERVAL < simTime())
-            {
-                delete frame;
-                transmissions[i].erase(curr);
-            }
-        }
+void ChannelControl::purgeOngoingTransmissions(int channel)
+{
+    // transmissions are indexed by expiry time, so we only visit the expired ones
+    TransmissionExpiryIndex& expiries = transmissionExpiries[channel];
+    while (!expiries.empty() && expiries.begin()->first < simTime())
+    {
+        TransmissionList::iterator it = expiries.begin()->second;
+        delete *it;
+        transmissions[channel].erase(it);
+        expiries.erase(expiries.begin());
     }
 }
 
@@ -291,10 +332,12 @@ void ChannelControl::sendToChannel(RadioRef srcRadio, AirFrame *airFrame)
 {
     // NOTE: no Enter_Method()! We pretend this method is part of ChannelAccess
 
-    // loop through all radios in range
-    const RadioRefVector& neighbors = getNeighbors(srcRadio);
-    int n = neighbors.size();
+    // loop through all radios in range listening on the frame's channel;
+    // radios tuned to other channels are not even visited
     int channel = airFrame->getChannelNumber();
+    checkChannel(channel);
+    const RadioRefVector& neighbors = getNeighbors(srcRadio, channel);
+    int n = neighbors.size();
     for (int i=0; i<n; i++)
     {
         RadioRef r = neighbors[i];
@@ -303,16 +346,11 @@ void ChannelControl::sendToChannel(RadioRef srcRadio, AirFrame *airFrame)
             coreEV << "skipping disabled radio interface \n";
             continue;
         }
-        if (r->channel == channel)
-        {
-            coreEV << "sending message to radio listening on the same channel\n";
-            // account for propagation delay, based on distance in meters
-            // Over 300m, dt=1us=10 bit times @ 10Mbps
-            simtime_t delay = srcRadio->pos.distance(r->pos) / LIGHT_SPEED;
-            check_and_cast<cSimpleModule*>(srcRadio->radioModule)->sendDirect(airFrame->dup(), delay, airFrame->getDuration(), r->radioInGate);
-        }
-        else
-            coreEV << "skipping radio listening on a different channel\n";
+        coreEV << "sending message to radio listening on the same channel\n";
+        // account for propagation delay, based on distance in meters
+        // Over 300m, dt=1us=10 bit times @ 10Mbps
+        simtime_t delay = srcRadio->pos.distance(r->pos) / LIGHT_SPEED;
+        check_and_cast<cSimpleModule*>(srcRadio->radioModule)->sendDirect(airFrame->dup(), delay, airFrame->getDuration(), r->radioInGate);
     }
 
     // register transmission
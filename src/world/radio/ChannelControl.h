@@ -20,6 +20,7 @@
 #include <vector>
 #include <list>
 #include <set>
+#include <map>
 
 #include "INETDefs.h"
 #include "Coord.h"
@@ -53,6 +54,10 @@ struct IChannelControl::RadioEntry {
     std::set<RadioRef, Compare> neighbors; // cached neighbor list
     std::vector<RadioRef> neighborList;
     bool isNeighborListValid;
+    // neighbors partitioned by the channel they listen on (indexed by channel number),
+    // each partition sorted like the neighbors set; kept up to date eagerly, so that
+    // a channel switch only moves the radio from one partition to another
+    std::vector<std::vector<RadioRef> > channelNeighbors;
     bool isActive;
 };
 
@@ -77,6 +82,10 @@ class INET_API ChannelControl : public cSimpleModule, public IChannelControl
     typedef std::vector<TransmissionList> ChannelTransmissionLists;
     ChannelTransmissionLists transmissions; // indexed by channel number (size=numChannels)
 
+    /** ongoing transmissions of a channel ordered by the time they may be purged */
+    typedef std::multimap<simtime_t, TransmissionList::iterator> TransmissionExpiryIndex;
+    std::vector<TransmissionExpiryIndex> transmissionExpiries; // indexed by channel number (size=numChannels)
+
     /** used to clear the transmission list from time to time */
     simtime_t lastOngoingTransmissionsUpdate;
 
@@ -104,12 +113,22 @@ class INET_API ChannelControl : public cSimpleModule, public IChannelControl
     /** Throws away expired transmissions. */
     virtual void purgeOngoingTransmissions();
 
+    /** Throws away expired transmissions on the given channel. */
+    virtual void purgeOngoingTransmissions(int channel);
+
     /** Validate the channel identifier */
     virtual void checkChannel(int channel);
 
     /** Get the list of modules in range of the given host */
     virtual const RadioRefVector& getNeighbors(RadioRef h);
 
+    /** Get the list of modules in range of the given host that listen on the given channel */
+    virtual const RadioRefVector& getNeighbors(RadioRef h, int channel);
+
+    /** Inserts/removes a neighbor into/from the channel partition of the given host */
+    virtual void addChannelNeighbor(RadioRef h, RadioRef neighbor, int channel);
+    virtual void removeChannelNeighbor(RadioRef h, RadioRef neighbor, int channel);
+
     /** Notifies the channel control with an ongoing transmission */
     virtual void addOngoingTransmission(RadioRef h, AirFrame *frame);
 
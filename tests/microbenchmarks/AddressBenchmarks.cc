@@ -0,0 +1,225 @@
+//
+// Copyright (C) 2013 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <map>
+#include <vector>
+
+#include "MicroBenchmark.h"
+#include "IPv4Address.h"
+#include "IPv6Address.h"
+#include "MACAddress.h"
+#include "MACAddressHashTable.h"
+
+//
+// Comparison and lookup of the address classes. The addresses have no hash
+// functions of their own; they are looked up in std::maps (e.g. ARP cache,
+// routing cache), or in MACAddressHashTable for MAC addresses.
+//
+
+static const int NUM_ADDRESSES = 1024;  // power of two
+
+static uint32 randomInt()
+{
+    return ((uint32)intrand(0x10000) << 16) | (uint32)intrand(0x10000);
+}
+
+class IPv4AddressCompareBenchmark : public MicroBenchmark
+{
+  protected:
+    std::vector<IPv4Address> addresses;
+
+  public:
+    IPv4AddressCompareBenchmark() : MicroBenchmark("IPv4Address.compare") {}
+
+    virtual void setUp(cModule *context)
+    {
+        for (int i = 0; i < NUM_ADDRESSES; i++)
+            addresses.push_back(IPv4Address(randomInt()));
+    }
+
+    virtual void run(long numOperations)
+    {
+        long count = 0;
+        for (long i = 0; i < numOperations; i++)
+        {
+            const IPv4Address& a = addresses[i & (NUM_ADDRESSES - 1)];
+            const IPv4Address& b = addresses[(i * 7 + 1) & (NUM_ADDRESSES - 1)];
+            count += (a < b) + (a == b);
+        }
+        consume(count);
+    }
+
+    virtual void tearDown() { addresses.clear(); }
+};
+
+Define_MicroBenchmark(IPv4AddressCompareBenchmark);
+
+class IPv4AddressMapBenchmark : public MicroBenchmark
+{
+  protected:
+    std::vector<IPv4Address> addresses;
+    std::map<IPv4Address, int> map;
+
+  public:
+    IPv4AddressMapBenchmark() : MicroBenchmark("IPv4Address.mapFind") {}
+
+    virtual void setUp(cModule *context)
+    {
+        for (int i = 0; i < NUM_ADDRESSES; i++)
+        {
+            addresses.push_back(IPv4Address(randomInt()));
+            map[addresses.back()] = i;
+        }
+    }
+
+    virtual void run(long numOperations)
+    {
+        long count = 0;
+        for (long i = 0; i < numOperations; i++)
+            count += map.find(addresses[(i * 7) & (NUM_ADDRESSES - 1)])->second;
+        consume(count);
+    }
+
+    virtual void tearDown() { addresses.clear(); map.clear(); }
+};
+
+Define_MicroBenchmark(IPv4AddressMapBenchmark);
+
+class IPv6AddressCompareBenchmark : public MicroBenchmark
+{
+  protected:
+    std::vector<IPv6Address> addresses;
+
+  public:
+    IPv6AddressCompareBenchmark() : MicroBenchmark("IPv6Address.compare") {}
+
+    virtual void setUp(cModule *context)
+    {
+        // common prefix, as in a real network
+        for (int i = 0; i < NUM_ADDRESSES; i++)
+            addresses.push_back(IPv6Address(0x20010db8, 0, randomInt(), randomInt()));
+    }
+
+    virtual void run(long numOperations)
+    {
+        long count = 0;
+        for (long i = 0; i < numOperations; i++)
+        {
+            const IPv6Address& a = addresses[i & (NUM_ADDRESSES - 1)];
+            const IPv6Address& b = addresses[(i * 7 + 1) & (NUM_ADDRESSES - 1)];
+            count += (a < b) + (a == b);
+        }
+        consume(count);
+    }
+
+    virtual void tearDown() { addresses.clear(); }
+};
+
+Define_MicroBenchmark(IPv6AddressCompareBenchmark);
+
+class IPv6AddressMapBenchmark : public MicroBenchmark
+{
+  protected:
+    std::vector<IPv6Address> addresses;
+    std::map<IPv6Address, int> map;
+
+  public:
+    IPv6AddressMapBenchmark() : MicroBenchmark("IPv6Address.mapFind") {}
+
+    virtual void setUp(cModule *context)
+    {
+        for (int i = 0; i < NUM_ADDRESSES; i++)
+        {
+            addresses.push_back(IPv6Address(0x20010db8, 0, randomInt(), randomInt()));
+            map[addresses.back()] = i;
+        }
+    }
+
+    virtual void run(long numOperations)
+    {
+        long count = 0;
+        for (long i = 0; i < numOperations; i++)
+            count += map.find(addresses[(i * 7) & (NUM_ADDRESSES - 1)])->second;
+        consume(count);
+    }
+
+    virtual void tearDown() { addresses.clear(); map.clear(); }
+};
+
+Define_MicroBenchmark(IPv6AddressMapBenchmark);
+
+class MACAddressCompareBenchmark : public MicroBenchmark
+{
+  protected:
+    std::vector<MACAddress> addresses;
+
+  public:
+    MACAddressCompareBenchmark() : MicroBenchmark("MACAddress.compare") {}
+
+    virtual void setUp(cModule *context)
+    {
+        for (int i = 0; i < NUM_ADDRESSES; i++)
+            addresses.push_back(MACAddress(((uint64)randomInt() << 16) | intrand(0x10000)));
+    }
+
+    virtual void run(long numOperations)
+    {
+        long count = 0;
+        for (long i = 0; i < numOperations; i++)
+        {
+            const MACAddress& a = addresses[i & (NUM_ADDRESSES - 1)];
+            const MACAddress& b = addresses[(i * 7 + 1) & (NUM_ADDRESSES - 1)];
+            count += (a.compareTo(b) < 0) + (a == b);
+        }
+        consume(count);
+    }
+
+    virtual void tearDown() { addresses.clear(); }
+};
+
+Define_MicroBenchmark(MACAddressCompareBenchmark);
+
+class MACAddressHashTableBenchmark : public MicroBenchmark
+{
+  protected:
+    std::vector<MACAddress> addresses;
+    MACAddressHashTable<int> table;
+
+  public:
+    MACAddressHashTableBenchmark() : MicroBenchmark("MACAddressHashTable.find") {}
+
+    virtual void setUp(cModule *context)
+    {
+        for (int i = 0; i < NUM_ADDRESSES; i++)
+        {
+            addresses.push_back(MACAddress(((uint64)randomInt() << 16) | intrand(0x10000)));
+            table[addresses.back()] = i;
+        }
+    }
+
+    virtual void run(long numOperations)
+    {
+        long count = 0;
+        for (long i = 0; i < numOperations; i++)
+            count += *table.find(addresses[(i * 7) & (NUM_ADDRESSES - 1)]);
+        consume(count);
+    }
+
+    virtual void tearDown() { addresses.clear(); table.clear(); }
+};
+
+Define_MicroBenchmark(MACAddressHashTableBenchmark);
@@ -0,0 +1,229 @@
+//
+// Copyright (C) 2013 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+#ifdef _WIN32
+#include <sys/timeb.h>
+#else
+#include <sys/time.h>
+#endif
+
+#include "MicroBenchmark.h"
+#include "InterfaceEntry.h"
+#include "InterfaceTableAccess.h"
+#include "PatternMatcher.h"
+
+//
+// Allocation counting: the executable replaces the global operator new, so
+// allocations made by the INET library and by OMNeT++ are counted as well.
+//
+static long numAllocations = 0;
+static long numAllocatedBytes = 0;
+
+#if __cplusplus >= 201103L
+#define THROW_BAD_ALLOC
+#define THROW_NOTHING noexcept
+#else
+#define THROW_BAD_ALLOC throw (std::bad_alloc)
+#define THROW_NOTHING throw ()
+#endif
+
+void *operator new(size_t size) THROW_BAD_ALLOC
+{
+    numAllocations++;
+    numAllocatedBytes += size;
+    void *p = malloc(size ? size : 1);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void *operator new[](size_t size) THROW_BAD_ALLOC
+{
+    return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t&) THROW_NOTHING
+{
+    numAllocations++;
+    numAllocatedBytes += size;
+    return malloc(size ? size : 1);
+}
+
+void *operator new[](size_t size, const std::nothrow_t& nothrow) THROW_NOTHING
+{
+    return operator new(size, nothrow);
+}
+
+void operator delete(void *p) THROW_NOTHING
+{
+    free(p);
+}
+
+void operator delete[](void *p) THROW_NOTHING
+{
+    free(p);
+}
+
+void operator delete(void *p, const std::nothrow_t&) THROW_NOTHING
+{
+    free(p);
+}
+
+void operator delete[](void *p, const std::nothrow_t&) THROW_NOTHING
+{
+    free(p);
+}
+
+static double getWallClockTime()
+{
+#ifdef _WIN32
+    struct _timeb t;
+    _ftime(&t);
+    return t.time + t.millitm / 1e3;
+#else
+    struct timeval t;
+    gettimeofday(&t, NULL);
+    return t.tv_sec + t.tv_usec / 1e6;
+#endif
+}
+
+long MicroBenchmark::sink = 0;
+
+MicroBenchmark::MicroBenchmark(const char *name)
+{
+    this->name = name;
+    getBenchmarks().push_back(this);
+}
+
+std::vector<MicroBenchmark *>& MicroBenchmark::getBenchmarks()
+{
+    // function-local, so that it is constructed before the first registration
+    static std::vector<MicroBenchmark *> benchmarks;
+    return benchmarks;
+}
+
+Define_Module(MicroBenchmarkRunner);
+
+long MicroBenchmarkRunner::getNumAllocations()
+{
+    return numAllocations;
+}
+
+long MicroBenchmarkRunner::getNumAllocatedBytes()
+{
+    return numAllocatedBytes;
+}
+
+void MicroBenchmarkRunner::initialize(int stage)
+{
+    if (stage == 0)
+    {
+        minTime = par("minTime");
+        maxOperations = par("maxOperations");
+
+        // interfaces for the routing table; they must exist before the
+        // routing table configures the interfaces in stage 1
+        IInterfaceTable *ift = InterfaceTableAccess().get();
+        int numInterfaces = par("numInterfaces");
+        for (int i = 0; i < numInterfaces; i++)
+        {
+            InterfaceEntry *ie = new InterfaceEntry(this);
+            char name[16];
+            sprintf(name, "eth%d", i);
+            ie->setName(name);
+            ie->setMtu(1500);
+            ie->setBroadcast(true);
+            ift->addInterface(ie);
+        }
+    }
+    else if (stage == 3)
+    {
+        scheduleAt(simTime(), new cMessage("start"));
+    }
+}
+
+void MicroBenchmarkRunner::handleMessage(cMessage *msg)
+{
+    delete msg;
+
+    FILE *f = NULL;
+    const char *outputFile = par("outputFile");
+    if (*outputFile)
+    {
+        f = fopen(outputFile, "w");
+        if (!f)
+            throw cRuntimeError("Cannot open output file `%s'", outputFile);
+        fprintf(f, "name,operations,ns/op,allocs/op,bytes/op\n");
+    }
+
+    inet::PatternMatcher matcher(par("benchmarks").stringValue(), false, true, true);
+    // printed to stdout, because the runs are done in express mode
+    char header[200];
+    sprintf(header, "%-40s %13s %12s %12s %12s", "benchmark", "operations", "ns/op", "allocs/op", "bytes/op");
+    std::cout << "\n" << header << std::endl;
+    std::vector<MicroBenchmark *>& benchmarks = MicroBenchmark::getBenchmarks();
+    for (int i = 0; i < (int)benchmarks.size(); i++)
+        if (matcher.matches(benchmarks[i]->getName()))
+            runBenchmark(benchmarks[i], f);
+
+    if (f)
+        fclose(f);
+    endSimulation();
+}
+
+void MicroBenchmarkRunner::runBenchmark(MicroBenchmark *benchmark, FILE *f)
+{
+    benchmark->setUp(this);
+
+    // a warm-up run, then increase the number of operations until the
+    // measurement takes at least minTime
+    benchmark->run(1);
+    long numOperations = 1;
+    double time;
+    long allocations, bytes;
+    while (true)
+    {
+        long allocations0 = numAllocations, bytes0 = numAllocatedBytes;
+        double t0 = getWallClockTime();
+        benchmark->run(numOperations);
+        time = getWallClockTime() - t0;
+        allocations = numAllocations - allocations0;
+        bytes = numAllocatedBytes - bytes0;
+        if (time >= minTime || numOperations >= maxOperations)
+            break;
+        double factor = time > 0 ? 1.2 * minTime / time : 100;
+        numOperations = (long)(numOperations * std::min(100.0, std::max(2.0, factor)));
+        if (numOperations > maxOperations)
+            numOperations = maxOperations;
+    }
+
+    benchmark->tearDown();
+
+    double nsPerOp = time * 1e9 / numOperations;
+    double allocsPerOp = (double)allocations / numOperations;
+    double bytesPerOp = (double)bytes / numOperations;
+    char line[200];
+    sprintf(line, "%-40s %13ld %12.1f %12.2f %12.1f", benchmark->getName(), numOperations, nsPerOp, allocsPerOp, bytesPerOp);
+    std::cout << line << std::endl;
+    if (f)
+        fprintf(f, "%s,%ld,%.2f,%.3f,%.1f\n", benchmark->getName(), numOperations, nsPerOp, allocsPerOp, bytesPerOp);
+}
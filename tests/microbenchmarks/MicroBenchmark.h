@@ -0,0 +1,104 @@
+//
+// Copyright (C) 2013 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __INET_MICROBENCHMARK_H
+#define __INET_MICROBENCHMARK_H
+
+#include <vector>
+
+#include "INETDefs.h"
+
+/**
+ * Base class of the microbenchmarks. A benchmark builds its data structures
+ * in setUp(), and performs the measured operation numOperations times in
+ * run(); MicroBenchmarkRunner calls run() with increasing counts until it
+ * takes long enough to be measured, and reports the time and the number of
+ * heap allocations per operation.
+ *
+ * Benchmarks register themselves with the Define_MicroBenchmark() macro.
+ */
+class MicroBenchmark
+{
+  protected:
+    const char *name;
+    static long sink;
+
+  protected:
+    /**
+     * Used by run() to keep the compiler from optimizing away the computations.
+     */
+    static void consume(long value) { sink += value; }
+
+  public:
+    MicroBenchmark(const char *name);
+    virtual ~MicroBenchmark() {}
+
+    const char *getName() const { return name; }
+
+    /**
+     * Creates the data structures. The context module is the runner, which
+     * can be used to find modules (e.g. the routing table) in the network.
+     */
+    virtual void setUp(cModule *context) {}
+
+    /**
+     * Performs the measured operation numOperations times.
+     */
+    virtual void run(long numOperations) = 0;
+
+    /**
+     * Destroys the data structures.
+     */
+    virtual void tearDown() {}
+
+    /**
+     * Returns the registered benchmarks.
+     */
+    static std::vector<MicroBenchmark *>& getBenchmarks();
+};
+
+#define Define_MicroBenchmark(CLASSNAME) \
+    static CLASSNAME CLASSNAME##_instance;
+
+/**
+ * Runs the registered microbenchmarks; see the NED file for the parameters.
+ */
+class MicroBenchmarkRunner : public cSimpleModule
+{
+  protected:
+    double minTime;
+    long maxOperations;
+
+  protected:
+    virtual int numInitStages() const { return 4; }
+    virtual void initialize(int stage);
+    virtual void handleMessage(cMessage *msg);
+    virtual void runBenchmark(MicroBenchmark *benchmark, FILE *f);
+
+  public:
+    /**
+     * Returns the number of heap allocations (operator new calls) so far.
+     */
+    static long getNumAllocations();
+
+    /**
+     * Returns the number of bytes allocated on the heap so far.
+     */
+    static long getNumAllocatedBytes();
+};
+
+#endif
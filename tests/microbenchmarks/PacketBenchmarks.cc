@@ -0,0 +1,134 @@
+//
+// Copyright (C) 2013 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "MicroBenchmark.h"
+#include "IPv4Datagram.h"
+#include "IPv4FragBuf.h"
+#include "ReassemblyBuffer.h"
+#include "TCPIPchecksum.h"
+
+/**
+ * Reassembly of a datagram from 4 fragments arriving out of order.
+ */
+class ReassemblyBufferBenchmark : public MicroBenchmark
+{
+  public:
+    ReassemblyBufferBenchmark() : MicroBenchmark("ReassemblyBuffer.addFragment") {}
+
+    virtual void run(long numOperations)
+    {
+        long count = 0;
+        for (long i = 0; i < numOperations; i++)
+        {
+            ReassemblyBuffer buf;
+            buf.addFragment(2960, 4440, true);
+            buf.addFragment(0, 1480, false);
+            buf.addFragment(1480, 2960, false);
+            count += buf.addFragment(1480, 2960, false);   // duplicate
+        }
+        consume(count);
+    }
+};
+
+Define_MicroBenchmark(ReassemblyBufferBenchmark);
+
+/**
+ * IPv4FragBuf reassembly of datagrams of 3 fragments, while 64 other
+ * incomplete datagrams are waiting in the buffer. An operation includes
+ * creating the 3 fragments, so the allocations per operation contain them.
+ */
+class IPv4FragBufBenchmark : public MicroBenchmark
+{
+  protected:
+    IPv4FragBuf *fragbuf;
+    ushort id;
+
+  protected:
+    static IPv4Datagram *createFragment(ushort id, uint32 src, int offset, int bytes, bool isLast)
+    {
+        IPv4Datagram *fragment = new IPv4Datagram("fragment");
+        fragment->setIdentification(id);
+        fragment->setSrcAddress(IPv4Address(src));
+        fragment->setDestAddress(IPv4Address(0x0a000001));
+        fragment->setFragmentOffset(offset);
+        fragment->setMoreFragments(!isLast);
+        fragment->setHeaderLength(20);
+        fragment->setByteLength(20 + bytes);
+        return fragment;
+    }
+
+  public:
+    IPv4FragBufBenchmark() : MicroBenchmark("IPv4FragBuf.addFragment") { fragbuf = NULL; }
+
+    virtual void setUp(cModule *context)
+    {
+        fragbuf = new IPv4FragBuf();
+        fragbuf->init(NULL);
+        id = 0;
+        for (int i = 0; i < 64; i++)
+            delete fragbuf->addFragment(createFragment(i, 0x0a000100 + i, 0, 1480, false), 0);
+    }
+
+    virtual void run(long numOperations)
+    {
+        long count = 0;
+        for (long i = 0; i < numOperations; i++, id++)
+        {
+            fragbuf->addFragment(createFragment(id, 0x0a000002, 1480, 1480, false), 0);
+            fragbuf->addFragment(createFragment(id, 0x0a000002, 2960, 520, true), 0);
+            IPv4Datagram *datagram = fragbuf->addFragment(createFragment(id, 0x0a000002, 0, 1480, false), 0);
+            count += datagram->getByteLength();
+            delete datagram;
+        }
+        consume(count);
+    }
+
+    virtual void tearDown() { delete fragbuf; }
+};
+
+Define_MicroBenchmark(IPv4FragBufBenchmark);
+
+/**
+ * Internet checksum of a 1500 byte packet.
+ */
+class TCPIPchecksumBenchmark : public MicroBenchmark
+{
+  protected:
+    unsigned char data[1500];
+
+  public:
+    TCPIPchecksumBenchmark() : MicroBenchmark("TCPIPchecksum.1500B") {}
+
+    virtual void setUp(cModule *context)
+    {
+        for (int i = 0; i < (int)sizeof(data); i++)
+            data[i] = intrand(256);
+    }
+
+    virtual void run(long numOperations)
+    {
+        long count = 0;
+        for (long i = 0; i < numOperations; i++)
+        {
+            data[i % sizeof(data)]++;
+            count += TCPIPchecksum::checksum(data, sizeof(data));
+        }
+        consume(count);
+    }
+};
+
+Define_MicroBenchmark(TCPIPchecksumBenchmark);
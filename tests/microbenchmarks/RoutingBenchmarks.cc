@@ -0,0 +1,201 @@
+//
+// Copyright (C) 2013 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <vector>
+
+#include "MicroBenchmark.h"
+#include "ARP.h"
+#include "IInterfaceTable.h"
+#include "InterfaceTableAccess.h"
+#include "IPv4Route.h"
+#include "IRoutingTable.h"
+#include "RoutingTableAccess.h"
+
+static uint32 randomInt()
+{
+    return ((uint32)intrand(0x10000) << 16) | (uint32)intrand(0x10000);
+}
+
+/**
+ * RoutingTable::findBestMatchingRoute() with random prefixes. With cached=false
+ * the routing cache is invalidated before every batch of distinct destinations,
+ * so every lookup scans the route list.
+ */
+class RoutingTableBenchmark : public MicroBenchmark
+{
+  protected:
+    int numRoutes;
+    bool cached;
+    IRoutingTable *rt;
+    std::vector<IPv4Route *> routes;
+    std::vector<IPv4Address> destinations;
+    static const int NUM_DESTINATIONS = 1024;   // power of two
+
+  protected:
+    void invalidateCache()
+    {
+        // the routing table invalidates its cache on every change
+        IPv4Route *route = new IPv4Route();
+        route->setDestination(IPv4Address("240.0.0.0"));
+        route->setNetmask(IPv4Address("255.255.255.255"));
+        route->setInterface(routes[0]->getInterface());
+        rt->addRoute(route);
+        rt->deleteRoute(route);
+    }
+
+  public:
+    RoutingTableBenchmark(const char *name, int numRoutes, bool cached) : MicroBenchmark(name)
+    {
+        this->numRoutes = numRoutes;
+        this->cached = cached;
+        rt = NULL;
+    }
+
+    virtual void setUp(cModule *context)
+    {
+        rt = RoutingTableAccess().get(context);
+        IInterfaceTable *ift = InterfaceTableAccess().get(context);
+        for (int i = 0; i < numRoutes; i++)
+        {
+            int prefixLength = 8 + intrand(17);
+            IPv4Address netmask = IPv4Address::makeNetmask(prefixLength);
+            IPv4Route *route = new IPv4Route();
+            route->setDestination(IPv4Address(randomInt()).doAnd(netmask));
+            route->setNetmask(netmask);
+            route->setGateway(IPv4Address(randomInt()));
+            route->setInterface(ift->getInterface(intrand(ift->getNumInterfaces())));
+            rt->addRoute(route);
+            routes.push_back(route);
+        }
+        // destinations matching a route, with a few misses
+        for (int i = 0; i < NUM_DESTINATIONS; i++)
+        {
+            IPv4Route *route = routes[intrand(numRoutes)];
+            uint32 hostBits = randomInt() & ~route->getNetmask().getInt();
+            destinations.push_back(IPv4Address(i % 16 == 0 ? randomInt() : route->getDestination().getInt() | hostBits));
+        }
+    }
+
+    virtual void run(long numOperations)
+    {
+        long count = 0;
+        for (long i = 0; i < numOperations; i++)
+        {
+            if (!cached && (i & (NUM_DESTINATIONS - 1)) == 0)
+                invalidateCache();
+            count += rt->findBestMatchingRoute(destinations[i & (NUM_DESTINATIONS - 1)]) != NULL;
+        }
+        consume(count);
+    }
+
+    virtual void tearDown()
+    {
+        for (int i = 0; i < (int)routes.size(); i++)
+            rt->deleteRoute(routes[i]);
+        routes.clear();
+        destinations.clear();
+    }
+};
+
+static RoutingTableBenchmark routingTableCached100("RoutingTable.findBestMatchingRoute.cached.100", 100, true);
+static RoutingTableBenchmark routingTableUncached100("RoutingTable.findBestMatchingRoute.uncached.100", 100, false);
+static RoutingTableBenchmark routingTableUncached1000("RoutingTable.findBestMatchingRoute.uncached.1000", 1000, false);
+
+/**
+ * Lookups in the ARP cache (ARP::ARPCache) of a router with many neighbors.
+ */
+class ARPCacheFindBenchmark : public MicroBenchmark
+{
+  protected:
+    ARP::ARPCache arpCache;
+    std::vector<IPv4Address> addresses;
+    static const int NUM_ENTRIES = 256;     // power of two
+
+  public:
+    ARPCacheFindBenchmark() : MicroBenchmark("ARPCache.find") {}
+
+    virtual void setUp(cModule *context)
+    {
+        for (int i = 0; i < NUM_ENTRIES; i++)
+        {
+            IPv4Address addr(0x0a000000 | (uint32)intrand(0x1000000));
+            ARP::ARPCacheEntry *entry = new ARP::ARPCacheEntry();
+            entry->ie = NULL;
+            entry->pending = false;
+            entry->macAddress = MACAddress::generateAutoAddress();
+            entry->numRetries = 0;
+            entry->timer = NULL;
+            entry->myIter = arpCache.insert(arpCache.begin(), std::make_pair(addr, entry));
+            addresses.push_back(addr);
+        }
+    }
+
+    virtual void run(long numOperations)
+    {
+        long count = 0;
+        for (long i = 0; i < numOperations; i++)
+        {
+            ARP::ARPCache::iterator it = arpCache.find(addresses[(i * 7) & (NUM_ENTRIES - 1)]);
+            count += it != arpCache.end() && !it->second->pending;
+        }
+        consume(count);
+    }
+
+    virtual void tearDown()
+    {
+        for (ARP::ARPCache::iterator it = arpCache.begin(); it != arpCache.end(); ++it)
+            delete it->second;
+        arpCache.clear();
+        addresses.clear();
+    }
+};
+
+Define_MicroBenchmark(ARPCacheFindBenchmark);
+
+/**
+ * Adding and removing an ARP cache entry, as done on every resolution and timeout.
+ */
+class ARPCacheUpdateBenchmark : public MicroBenchmark
+{
+  protected:
+    ARP::ARPCache arpCache;
+
+  public:
+    ARPCacheUpdateBenchmark() : MicroBenchmark("ARPCache.insertErase") {}
+
+    virtual void setUp(cModule *context)
+    {
+        for (int i = 0; i < 256; i++)
+            arpCache[IPv4Address(0x0a000000 | (uint32)intrand(0x1000000))] = NULL;
+    }
+
+    virtual void run(long numOperations)
+    {
+        for (long i = 0; i < numOperations; i++)
+        {
+            ARP::ARPCacheEntry *entry = new ARP::ARPCacheEntry();
+            entry->myIter = arpCache.insert(std::make_pair(IPv4Address(0x0b000000 | (uint32)(i & 0xffffff)), entry)).first;
+            arpCache.erase(entry->myIter);
+            delete entry;
+        }
+        consume(arpCache.size());
+    }
+
+    virtual void tearDown() { arpCache.clear(); }
+};
+
+Define_MicroBenchmark(ARPCacheUpdateBenchmark);
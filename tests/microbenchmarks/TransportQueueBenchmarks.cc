@@ -0,0 +1,189 @@
+//
+// Copyright (C) 2013 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <vector>
+
+#include "MicroBenchmark.h"
+#include "SCTPAssociation.h"
+#include "SCTPQueue.h"
+#include "TCPSACKRexmitQueue.h"
+#include "TCPSegment.h"
+#include "TCPVirtualDataRcvQueue.h"
+
+static const uint32 MSS = 1460;
+
+/**
+ * Inserting segments into TCPVirtualDataRcvQueue and extracting the data, as
+ * the receiver does. With outOfOrder=true, every pair of segments arrives
+ * swapped, so every other segment has to be merged into an existing region.
+ * A single TCPSegment is reused, so only the queue operations are measured.
+ */
+class TCPVirtualDataRcvQueueBenchmark : public MicroBenchmark
+{
+  protected:
+    bool outOfOrder;
+    TCPVirtualDataRcvQueue *queue;
+    TCPSegment *segment;
+    uint32 seq;
+
+  public:
+    TCPVirtualDataRcvQueueBenchmark(const char *name, bool outOfOrder) : MicroBenchmark(name)
+    {
+        this->outOfOrder = outOfOrder;
+        queue = NULL;
+        segment = NULL;
+    }
+
+    virtual void setUp(cModule *context)
+    {
+        queue = new TCPVirtualDataRcvQueue();
+        seq = 1000;
+        queue->init(seq);
+        segment = new TCPSegment("segment");
+        segment->setPayloadLength(MSS);
+    }
+
+    virtual void run(long numOperations)
+    {
+        long count = 0;
+        for (long i = 0; i < numOperations; i++)
+        {
+            // segment i (swapped in pairs if out of order)
+            long k = outOfOrder ? (i ^ 1) : i;
+            segment->setSequenceNo(seq + k * MSS);
+            uint32 rcvNxt = queue->insertBytesFromSegment(segment);
+            // the application reads the data after every 4 segments
+            if ((i & 3) == 3)
+            {
+                cPacket *msg = queue->extractBytesUpTo(rcvNxt);
+                count += msg->getByteLength();
+                delete msg;
+            }
+        }
+        seq += numOperations * MSS;
+        if (outOfOrder && (numOperations & 1))
+        {
+            // the last segment overtook its pair: deliver the missing one
+            segment->setSequenceNo(seq - MSS);
+            queue->insertBytesFromSegment(segment);
+            seq += MSS;
+        }
+        // continue from an empty queue in the next run
+        delete queue->extractBytesUpTo(seq);
+        consume(count);
+    }
+
+    virtual void tearDown()
+    {
+        delete queue;
+        delete segment;
+    }
+};
+
+static TCPVirtualDataRcvQueueBenchmark tcpVirtualDataRcvQueueInOrder("TCPVirtualDataRcvQueue.inOrder", false);
+static TCPVirtualDataRcvQueueBenchmark tcpVirtualDataRcvQueueOutOfOrder("TCPVirtualDataRcvQueue.outOfOrder", true);
+
+/**
+ * Sender side TCPSACKRexmitQueue updates: every segment is enqueued when sent,
+ * SACKed later, and discarded when the cumulative ACK covers it. About 64
+ * segments are in flight.
+ */
+class TCPSACKRexmitQueueBenchmark : public MicroBenchmark
+{
+  protected:
+    TCPSACKRexmitQueue *queue;
+    uint32 seq;
+    static const int WINDOW = 64;
+
+  public:
+    TCPSACKRexmitQueueBenchmark() : MicroBenchmark("TCPSACKRexmitQueue.update") { queue = NULL; }
+
+    virtual void setUp(cModule *context)
+    {
+        queue = new TCPSACKRexmitQueue();
+        seq = 1000;
+        queue->init(seq);
+        for (int i = 0; i < WINDOW; i++, seq += MSS)
+            queue->enqueueSentData(seq, seq + MSS);
+    }
+
+    virtual void run(long numOperations)
+    {
+        for (long i = 0; i < numOperations; i++, seq += MSS)
+        {
+            queue->enqueueSentData(seq, seq + MSS);
+            // SACK a segment in the middle of the window, then ACK the oldest one
+            queue->setSackedBit(seq - (WINDOW / 2) * MSS, seq - (WINDOW / 2 - 1) * MSS);
+            queue->discardUpTo(seq - (WINDOW - 1) * MSS);
+        }
+        consume(queue->getQueueLength());
+    }
+
+    virtual void tearDown() { delete queue; }
+};
+
+Define_MicroBenchmark(TCPSACKRexmitQueueBenchmark);
+
+/**
+ * SCTPQueue insertions and extractions by TSN, with 64 chunks in the queue.
+ */
+class SCTPQueueBenchmark : public MicroBenchmark
+{
+  protected:
+    SCTPQueue *queue;
+    std::vector<SCTPDataVariables *> chunks;
+    uint32 tsn;
+    static const int NUM_CHUNKS = 64;   // power of two
+
+  public:
+    SCTPQueueBenchmark() : MicroBenchmark("SCTPQueue.insertExtract") { queue = NULL; }
+
+    virtual void setUp(cModule *context)
+    {
+        queue = new SCTPQueue();
+        tsn = 1;
+        for (int i = 0; i < NUM_CHUNKS; i++, tsn++)
+        {
+            chunks.push_back(new SCTPDataVariables());
+            chunks.back()->tsn = tsn;
+            queue->checkAndInsertChunk(tsn, chunks.back());
+        }
+    }
+
+    virtual void run(long numOperations)
+    {
+        long count = 0;
+        for (long i = 0; i < numOperations; i++, tsn++)
+        {
+            // the oldest chunk leaves the queue, and is reused for the new TSN
+            SCTPDataVariables *chunk = queue->getAndExtractChunk(tsn - NUM_CHUNKS);
+            chunk->tsn = tsn;
+            count += queue->checkAndInsertChunk(tsn, chunk);
+        }
+        consume(count);
+    }
+
+    virtual void tearDown()
+    {
+        delete queue;
+        for (int i = 0; i < (int)chunks.size(); i++)
+            delete chunks[i];
+        chunks.clear();
+    }
+};
+
+Define_MicroBenchmark(SCTPQueueBenchmark);